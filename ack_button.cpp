@@ -0,0 +1,216 @@
+//*************************************************************************************
+/** \file ack_button.cpp
+ *    This file contains the driver for the acknowledge button or footswitch. See
+ *    \c ack_button.h for what the presses mean.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, debounced acknowledge button on INT7
+ *    \li 10-18-26 a single press isn't answered while a second press is held down
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include <avr/io.h>
+#include <avr/interrupt.h>                  // Header for AVR interrupt programming
+
+#include "FreeRTOS.h"                       // Header for the FreeRTOS RTOS
+#include "task.h"                           // Header for FreeRTOS task functions
+#include "ack_button.h"
+
+
+/// The queue into which answers are put
+static frt_queue<messages_from_ui>* p_answers;
+
+/// True while the button is down, once bouncing has settled
+static volatile bool pressed;
+
+/// The time of the last edge which wasn't bounce, in RTOS ticks
+static volatile portTickType last_edge;
+
+/// The time at which the button was last pressed, in RTOS ticks
+static volatile portTickType press_time;
+
+/// True when a press has been released and might yet turn out to be a double press
+static volatile bool click_pending;
+
+/// True when the button has been held long enough that the press has been answered
+static volatile bool long_sent;
+
+/// The number of presses of any kind
+static volatile uint16_t presses;
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function checks whether the button is being held down.
+ *  @return True if the pin has been pulled low by the button
+ */
+
+static inline bool pin_pressed (void)
+{
+	return ((PINE & (1 << PE7)) == 0);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function sends an answer to the mastermind task. It must only be
+ *  called in interrupt context. If the queue is full, the answer is thrown away.
+ *  @param answer The answer
+ */
+
+static inline void send (messages_from_ui answer)
+{
+	p_answers->ISR_put (answer);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function acts on the button being pressed or let go.
+ *  \details A press only notes the time. When the button is let go, a long press has
+ *  already been answered; a second short press makes a double press; and a first
+ *  short press waits to see if a second one follows. It must only be called in
+ *  interrupt context.
+ *  @param now_pressed True if the button is now down, false if it's up
+ *  @param now The time, in RTOS ticks
+ */
+
+static void new_level (bool now_pressed, portTickType now)
+{
+	if (now_pressed == pressed)
+	{
+		return;
+	}
+	pressed = now_pressed;
+	last_edge = now;
+
+	if (pressed)
+	{
+		press_time = now;
+		long_sent = false;
+		presses++;
+	}
+	else if (long_sent)
+	{
+		click_pending = false;
+	}
+	else if (click_pending)
+	{
+		click_pending = false;
+		send (SKIP);
+	}
+	else
+	{
+		click_pending = true;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This constructor sets up the acknowledge button.
+ *  \details PE7 is made an input with its pull-up on, and its external interrupt is
+ *  set to run on both edges. If the button is already down, as when something is
+ *  resting on the footswitch, it isn't taken to be a press until it's let go.
+ *  @param p_queue The queue into which answers are put for the mastermind task
+ */
+
+ack_button::ack_button (frt_queue<messages_from_ui>* p_queue)
+{
+	p_answers = p_queue;
+	click_pending = false;
+	long_sent = true;
+	presses = 0;
+	last_edge = 0;
+
+	DDRE &= ~(1 << PE7);                    // PE7 is an input
+	PORTE |= (1 << PE7);                    // with its pull-up on
+	pressed = pin_pressed ();
+
+	EICRB = (EICRB & ~((1 << ISC70) | (1 << ISC71))) | (1 << ISC70);  // Any edge
+	EIMSK |= (1 << INT7);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method gets the number of times the button has been pressed.
+ *  @return The number of presses of any kind since the program started
+ */
+
+uint16_t ack_button::get_presses (void)
+{
+	uint16_t count;
+
+	portENTER_CRITICAL ();
+	count = presses;
+	portEXIT_CRITICAL ();
+
+	return (count);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function finishes off presses; it's run at every RTOS tick.
+ *  \details If the pin has settled at a level the interrupt didn't act on because it
+ *  came too soon after the last edge, it's acted on here. A press held long enough is
+ *  answered without waiting for it to be let go, and a single press is answered once
+ *  the button has been up too long for a second. While a second press is held, the
+ *  first waits for it, as the pair can only be a double press or a long press. It 
+ *  must only be called in interrupt context.
+ */
+
+void ack_button_tick (void)
+{
+	if (p_answers == NULL)
+	{
+		return;
+	}
+
+	portTickType now = xTaskGetTickCountFromISR ();
+	if (now - last_edge < configMS_TO_TICKS (ACK_BUTTON_DEBOUNCE_MS))
+	{
+		return;
+	}
+
+	new_level (pin_pressed (), now);
+
+	if (pressed && !long_sent
+		&& now - press_time >= configMS_TO_TICKS (ACK_BUTTON_LONG_MS))
+	{
+		long_sent = true;
+		send (REMEASURE);
+	}
+	else if (!pressed && click_pending
+			 && now - last_edge >= configMS_TO_TICKS (ACK_BUTTON_DOUBLE_MS))
+	{
+		click_pending = false;
+		send (DID_THAT);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \cond NOT_ENABLED ISR for external interrupt 7, run on both edges of PE7. An edge
+ *  too soon after the last one is bounce and is ignored.
+ */
+
+ISR (INT7_vect)
+{
+	portTickType now = xTaskGetTickCountFromISR ();
+
+	if (now - last_edge >= configMS_TO_TICKS (ACK_BUTTON_DEBOUNCE_MS))
+	{
+		new_level (pin_pressed (), now);
+	}
+}
+
+/** \endcond end of undocumented code */
@@ -0,0 +1,80 @@
+//*************************************************************************************
+/** \file ack_button.h
+ *    This file contains a driver for a push button or footswitch with which the
+ *    mechanic answers the prompt to turn a spoke, so that they needn't reach for the
+ *    keyboard after every turn. The button connects PE7 to ground; the AVR's pull-up
+ *    holds the pin high while it isn't pressed.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, debounced acknowledge button on INT7
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+// This define prevents this .h file from being included multiple times in a .cpp file
+#ifndef _ACK_BUTTON_H_
+#define _ACK_BUTTON_H_
+
+#include <stdlib.h>
+#include "FreeRTOS.h"                       // Header for the FreeRTOS RTOS
+#include "frt_queue.h"                      // Header of wrapper for FreeRTOS queues
+#include "shares.h"                         // Global ('extern') queue declarations
+
+
+/// Edges closer together than this many milliseconds are taken to be contact bounce
+#define ACK_BUTTON_DEBOUNCE_MS	20
+
+/// A second press begun within this many milliseconds of letting go of the first is a
+/// double press
+#define ACK_BUTTON_DOUBLE_MS	400
+
+/// A press held down for this many milliseconds is a long press
+#define ACK_BUTTON_LONG_MS		1000
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This class reads the acknowledge button and sends what the mechanic meant
+ *  straight to the mastermind task.
+ *  \details The external interrupt on PE7 is run on both edges. An edge sooner than
+ *  \c ACK_BUTTON_DEBOUNCE_MS after the last one is ignored as bounce, and the RTOS tick
+ *  hook, \c ack_button_tick(), picks up whatever level the pin settles at, so a press
+ *  is never lost to bouncing. Presses mean:
+ *  \li A single press: \c DID_THAT, sent once \c ACK_BUTTON_DOUBLE_MS have gone by
+ *      with no second press
+ *  \li A double press: \c SKIP
+ *  \li A long press: \c REMEASURE, sent as soon as the button has been held down for
+ *      \c ACK_BUTTON_LONG_MS. If it's the second press of a double press, the pair is
+ *      a long press only, never a single press as well
+ *
+ *  Answers go into the same queue as the user interface's, so to the mastermind task
+ *  a press is just the same as typing the command. As the interrupt can't know
+ *  whether a prompt is waiting, the mastermind task throws away answers which come
+ *  in before it asks for one.
+ */
+
+class ack_button
+{
+	public:
+		// The constructor sets up PE7 and its interrupt
+		ack_button (frt_queue<messages_from_ui>* p_queue);
+
+		// Get the number of presses there have been of any kind
+		uint16_t get_presses (void);
+};
+
+// Finish off presses and notice settled levels; called at each RTOS tick
+void ack_button_tick (void);
+
+#endif // _ACK_BUTTON_H_
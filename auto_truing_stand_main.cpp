@@ -9,6 +9,15 @@
  *  Revisions:
  *    \li 02-11-13 HL, TJ, & SG creates a task_spoke_count to verify spoke counter works
  * 	  \li 02-15-13 HL, TJ, & SG implemented truing stand tasks and queues
+ *    \li 10-18-26 added the stack and heap profiling task
+ *    \li 10-18-26 all tasks, drivers, queues and task stacks statically allocated
+ *    \li 10-18-26 added the sensor event capture task
+ *    \li 10-18-26 all printing goes through the print queue to the console task
+ *    \li 10-18-26 print queue shortened to fit an 8 bit FreeRTOS queue length
+ *    \li 10-18-26 messages to the user interface carry their numbers in a ui_queue
+ *    \li 10-18-26 added the acknowledge button and the RTOS tick hook which times it
+ *    \li 10-18-26 the RAM check says what it can't see; the Makefile checks the rest
+ *    \li 10-18-26 added a compile-time check that the kernel's objects fit its heap
  *
  *  License:
 *    This file is copyright 2013 by Hamilton Little, Trevor Jones and Sean Green 
@@ -51,35 +60,151 @@
 #include "task_pos_controller.h"
 #include "task_user_interface.h"
 #include "pos_controller.h"	
+#include "task_diagnostics.h"
+#include "task_event_log.h"
+#include "task_console.h"
+#include "ack_button.h"
 
 
 
 // Declare the queues which are used by tasks to communicate with each other here. 
 // Each queue must also be declared 'extern' in a header file which will be read 
-// by every task that needs to use that queue. The format for all queues except 
-// the serial text printing queue is 'frt_queue<type> name (size)', where 'type' 
-// is the type of data in the queue and 'size' is the number of items (not neces-
-// sarily bytes) which the queue can hold
+// by every task that needs to use that queue. The queue objects themselves are
+// static objects in main(); these pointers are set to point to them there
 
 /** This is a print queue, descended from \c emstream so that things can be printed 
  *  into the queue using the "<<" operator and they'll come out the other end as a 
- *  stream of characters. It's used by tasks that send things to the user interface 
- *  task to be printed. 
+ *  stream of characters. Every task prints into it, and the console task alone sends
+ *  what comes out to the serial port. 
  */
 frt_text_queue* print_ser_queue;
 
 /** This is the queue used to send information to the user interface task, so it knows
 	what to tell the user or prompt them for at the appropriate time. */
-frt_queue<ui_messages> *to_ui;
+ui_queue *to_ui;
 
 /** This is the queue used by the user interface to let another task know what the user
 	has entered after being prompted for something. */
 frt_queue<messages_from_ui> *from_ui;
 
+
+// These are the sizes, in bytes, of the statically allocated task stacks. The stack
+// profiling task (build with -DSTACK_PROFILE) prints recommended values for them
+#define STACK_SPOKE_COUNT		400         ///< Stack size for the spoke counter task
+#define STACK_POS_CONTROLLER	400         ///< Stack size for the position controller
+#define STACK_MASTERMIND		400         ///< Stack size for the mastermind task
+#define STACK_USER_INTERFACE	200         ///< Stack size for the user interface task
+#define STACK_CONSOLE			200         ///< Stack size for the console writer task
+#ifdef STACK_PROFILE
+	#define STACK_DIAGNOSTICS	260         ///< Stack size for the profiling task
+#else
+	#define STACK_DIAGNOSTICS	0
+#endif
+#ifdef EVENT_CAPTURE
+	#define STACK_EVENT_LOG		200         ///< Stack size for the capture log task
+#else
+	#define STACK_EVENT_LOG		0
+#endif
+
+/// This is the total number of bytes used by all the static task stacks
+#define STATIC_STACK_BYTES		(STACK_SPOKE_COUNT + STACK_POS_CONTROLLER \
+								 + STACK_MASTERMIND + STACK_USER_INTERFACE \
+								 + STACK_CONSOLE + STACK_DIAGNOSTICS \
+								 + STACK_EVENT_LOG)
+
+/** This is a rough allowance of RAM for everything besides the task stacks and the
+ *  RTOS heap: the main stack, which interrupts also use until the scheduler starts, 
+ *  and the statically allocated objects and other global variables. The check below
+ *  can't see how big those really are; the Makefile checks what the linker placed.
+ */
+#define RAM_RESERVE_BYTES		1024
+
+/** This is the number of characters the print queue holds. It must take the longest
+ *  burst any task prints at once, such as a telemetry record or a capture log line,
+ *  plus whatever the other tasks print while the console task is sending it. The
+ *  queue's high water mark, printed by the profiling task, shows how much is used. 
+ *  FreeRTOS keeps a queue's length in an \c unsigned \c portBASE_TYPE, which is 8
+ *  bits on the AVR, so it can't be more than 255. 
+ */
+#define PRINT_QUEUE_SIZE		250
+
+/** This is the number of messages the queue to the user interface holds. Progress
+ *  updates are merged so that only one is ever waiting, so it needn't be long. 
+ */
+#define UI_QUEUE_SIZE			8
+
+/// This is the number of answers the queue from the user interface holds
+#define FROM_UI_QUEUE_SIZE		20
+
+/** This is the number of tasks the RTOS runs, counting its own idle task, and so the
+ *  number of task control blocks it takes from its heap. 
+ */
+#define RTOS_TASK_COUNT			(6 + (STACK_DIAGNOSTICS != 0) \
+								 + (STACK_EVENT_LOG != 0))
+
+/** This typedef is an early, compile-time check that the task stacks and RTOS heap 
+ *  leave the allowance above in SRAM. If they don't, the array size is negative and 
+ *  the compiler stops with an error pointing here; shrink some stacks or the heap 
+ *  (\c configTOTAL_HEAP_SIZE in \c FreeRTOSConfig.h) until it compiles. Passing it
+ *  doesn't prove that everything fits, as the static objects aren't counted; after 
+ *  linking, the Makefile checks that the RAM above \c __heap_start, which is all 
+ *  that's left for the main stack, is at least \c MAIN_STACK_BYTES.
+ */
+typedef char static_ram_fits_check[(STATIC_STACK_BYTES + configTOTAL_HEAP_SIZE 
+	+ RAM_RESERVE_BYTES <= (RAMEND + 1 - RAMSTART)) ? 1 : -1];
+
+/** This gives the size of a block taken from the RTOS heap, which \c pvPortMalloc()
+ *  rounds up to the port's alignment. 
+ */
+#define HEAP_BLOCK(bytes)		(((bytes) + portBYTE_ALIGNMENT_MASK) \
+								 & ~(size_t)portBYTE_ALIGNMENT_MASK)
+
+/** This is the size of a task control block in \c tasks.c: two pointers, two list 
+ *  items, the priority and base priority (used by mutexes), and the task's name.
+ */
+#define HEAP_TCB_BYTES			HEAP_BLOCK (2 * sizeof (void*) \
+								 + 2 * sizeof (xListItem) \
+								 + 2 * sizeof (unsigned portBASE_TYPE) \
+								 + configMAX_TASK_NAME_LEN)
+
+/** This is what a queue takes from the heap: its header in \c queue.c, with four 
+ *  pointers, two lists of waiting tasks and five counters, then its storage, which
+ *  has one byte more than its items need.
+ *  @param length The number of items the queue holds
+ *  @param item The size of each item in bytes
+ */
+#define HEAP_QUEUE_BYTES(length, item) \
+								(HEAP_BLOCK (4 * sizeof (void*) + 2 * sizeof (xList) \
+								 + 5 * sizeof (portBASE_TYPE)) \
+								 + HEAP_BLOCK ((length) * (item) + 1))
+
+/// This is everything the kernel takes from its heap as the program starts
+#define HEAP_BYTES_NEEDED		(RTOS_TASK_COUNT * HEAP_TCB_BYTES \
+								 + HEAP_BLOCK (configMINIMAL_STACK_SIZE \
+											   * sizeof (portSTACK_TYPE)) \
+								 + HEAP_QUEUE_BYTES (PRINT_QUEUE_SIZE, sizeof (char)) \
+								 + HEAP_QUEUE_BYTES (UI_QUEUE_SIZE, \
+													 sizeof (ui_message)) \
+								 + HEAP_QUEUE_BYTES (FROM_UI_QUEUE_SIZE, \
+													 sizeof (messages_from_ui)))
+
+/** This typedef checks that the task control blocks, the idle task's stack and the
+ *  queues fit in the RTOS heap, which heap_1 never fills to its last byte. A heap
+ *  which is too small would make a task or queue quietly fail to be created at 
+ *  startup; instead the array size goes negative and the compiler stops here. Raise \c configTOTAL_HEAP_SIZE or shorten a
+ *  queue. A task or queue added to \c main() must be added to the sums above.
+ */
+typedef char static_heap_fits_check[(HEAP_BYTES_NEEDED < configTOTAL_HEAP_SIZE) 
+	? 1 : -1];
+
+
 //=====================================================================================
 /** \brief Starts the RTOS and sets up the tasks and queues used.
  * 		After all these have been set up, it calls the task scheduler to start running
  * 		the tasks, so the mechanic can fix their wheel!
+ * 		Everything is made as a static object rather than with \c new, so its place in
+ * 		memory is fixed when the program is linked. The objects are declared inside
+ * 		this function so that they're constructed after the watchdog is turned off.
  *  @return This is a real-time microcontroller program which doesn't return. Ever.
  */
 
@@ -94,24 +219,87 @@ int main (void)
 	// mation, or to allow user interaction, or for whatever use is appropriate.  The
 	// serial port will be used by the user interface task after setup is complete and
 	// the task scheduler has been started by the function vTaskStartScheduler()
-	rs232* ser_port = new rs232 (9600, 1);
-	*ser_port << clrscr << PMS ("ME405 Auto Truing Stand Starting") << endl;
+	static rs232 ser_port (9600, 1);
+	ser_port << clrscr << PMS ("ME405 Auto Truing Stand Starting") << endl;
 
-	// Create the queues and other shared data items here
-	print_ser_queue = new frt_text_queue (32, ser_port, 10);
-	to_ui = new frt_queue<ui_messages> (20);
-	from_ui = new frt_queue<messages_from_ui> (20);
+	// Create the queues and other shared data items here. The queue objects are 
+	// static, but FreeRTOS still takes their storage from its (startup only) heap.
+	// The print queue never waits; what doesn't fit is counted and thrown away so
+	// that no task is ever held up by the serial port
+	static frt_text_queue print_queue (PRINT_QUEUE_SIZE, &ser_port, 0);
+	static ui_queue to_ui_queue (UI_QUEUE_SIZE);
+	static frt_queue<messages_from_ui> from_ui_queue (FROM_UI_QUEUE_SIZE);
+	print_ser_queue = &print_queue;
+	to_ui = &to_ui_queue;
+	from_ui = &from_ui_queue;
+
+	// The acknowledge button answers prompts by putting answers straight into the
+	// queue from the user interface, just as if they had been typed
+	static ack_button button (from_ui);
 	
+	// These are the stacks for the tasks below, allocated here rather than from the
+	// RTOS heap so that the memory they use is known when the program is linked
+	static portSTACK_TYPE spoke_count_stack[STACK_SPOKE_COUNT];
+	static portSTACK_TYPE pos_controller_stack[STACK_POS_CONTROLLER];
+	static portSTACK_TYPE mastermind_stack[STACK_MASTERMIND];
+	static portSTACK_TYPE user_interface_stack[STACK_USER_INTERFACE];
+	static portSTACK_TYPE console_stack[STACK_CONSOLE];
+
 	// These are the tasks we designed to count the spokes as they go by, control the 
 	// wheel position, implement the truing algorithm we developed, and interface with
-	// the user, respectively.
- 	new task_spoke_count("Spokes On", task_priority(1), 400, ser_port);
- 	new task_pos_controller("Motor On", task_priority(1), 400, ser_port);
-	new task_mastermind("Logic On", task_priority (1), 400, ser_port);
-	new task_user_interface("UI on", task_priority(1), 200, ser_port);
+	// the user, respectively. They all print into the print queue, and the user
+	// interface reads keypresses straight from the serial port.
+ 	static task_spoke_count spoke_task ("Spokes On", task_priority(1), 
+										STACK_SPOKE_COUNT, print_ser_queue, 
+										spoke_count_stack);
+ 	static task_pos_controller motor_task ("Motor On", task_priority(1), 
+										   STACK_POS_CONTROLLER, print_ser_queue, 
+										   pos_controller_stack);
+	static task_mastermind logic_task ("Logic On", task_priority (1), 
+									   STACK_MASTERMIND, print_ser_queue, 
+									   mastermind_stack);
+	static task_user_interface ui_task ("UI on", task_priority(1), 
+										STACK_USER_INTERFACE, print_ser_queue, 
+										&ser_port, user_interface_stack);
+
+	// This task is the only one which writes to the serial port; it sends whatever
+	// the others have put in the print queue. Some of the tasks above poll without
+	// ever blocking, so a task below them would never get to run; this one is put
+	// above them instead, which costs them little as it sleeps whenever the queue is
+	// empty or the serial port's buffer is full
+	static task_console console_task ("Console", task_priority(2), STACK_CONSOLE, 
+									  &ser_port, print_ser_queue, console_stack);
+
+	// When profiling, this task watches how much stack the tasks above really use so
+	// that the sizes given to them here can be trimmed to fit
+	#ifdef STACK_PROFILE
+		static portSTACK_TYPE diagnostics_stack[STACK_DIAGNOSTICS];
+		static task_diagnostics diag_task ("Diagnose", task_priority(1), 
+										   STACK_DIAGNOSTICS, print_ser_queue, 
+										   diagnostics_stack);
+	#endif
+
+	// When capturing, this task streams every sensor edge and pot reading out of the
+	// serial port so that the session can be played back on a PC afterwards
+	#ifdef EVENT_CAPTURE
+		static portSTACK_TYPE event_log_stack[STACK_EVENT_LOG];
+		static task_event_log event_task ("Capture", task_priority(1), 
+										  STACK_EVENT_LOG, print_ser_queue, 
+										  event_log_stack);
+	#endif
 	
 	// Here's where the RTOS scheduler is started up. It should never exit as long as
 	// power is on and the microcontroller isn't rebooted.
 	vTaskStartScheduler ();
 }
 
+
+//-------------------------------------------------------------------------------------
+/** \brief This function is run by the RTOS at every tick, in interrupt context.
+ *  \details It times presses of the acknowledge button, so it must be quick.
+ */
+
+extern "C" void vApplicationTickHook (void)
+{
+	ack_button_tick ();
+}
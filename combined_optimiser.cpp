@@ -0,0 +1,188 @@
+//*************************************************************************************
+/** \file combined_optimiser.cpp
+ *    This file contains an optimiser which trues the rim sideways and radially at
+ *    once. See \c combined_optimiser.h for the sums it does.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, lateral and radial truing together
+ *    \li 10-18-26 Offsets and errors are in micrometres
+ *    \li 10-18-26 The gain model's units, not counts, in the comments
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include "combined_optimiser.h"
+
+
+/// One in the fixed point format of the gains
+#define COMBINED_ONE		(1 << GAIN_FRAC_BITS)
+
+/// This macro finds the size of a number
+#define COMBINED_SIZE(x) ((x) < 0 ? (-(x)) : (x))
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function finds the square root of a number, rounded down.
+ *  \details It works out one bit of the root at a time, from the top, which takes
+ *  16 rounds of shifts and subtractions and no multiplying.
+ *  @param number The number
+ *  @return Its square root
+ */
+
+static uint16_t combined_sqrt (uint32_t number)
+{
+	uint32_t root = 0;
+	uint32_t bit = (uint32_t)1 << 30;
+
+	while (bit > number)
+	{
+		bit >>= 2;
+	}
+	while (bit != 0)
+	{
+		if (number >= root + bit)
+		{
+			number -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else
+		{
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return ((uint16_t)root);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This constructor saves the gain models the optimiser works from.
+ *  @param a_lateral The model of how far a quarter turn moves the rim sideways
+ *  @param a_radial The model of how far a quarter turn moves the rim radially
+ */
+
+combined_optimiser::combined_optimiser (gain_model* a_lateral, gain_model* a_radial)
+{
+	p_lateral = a_lateral;
+	p_radial = a_radial;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method works out the top and bottom of the fraction which gives the
+ *  best turns for a spoke.
+ *  \details The top is gL L + w gR R, with \c GAIN_FRAC_BITS fraction bits, and the
+ *  bottom gL^2 + w gR^2, with the same; so the turns are minus the one over the
+ *  other. The offsets are taken in the gain model's units of \c GAIN_UNIT_MICRONS,
+ *  so with the gains held to \c GAIN_MAX both fit in 32 bits. The bottom is never
+ *  less than that of a gain of a quarter unit per quarter turn.
+ *  @param spoke The spoke
+ *  @param lateral Its sideways offset, in micrometres
+ *  @param radial Its radial offset, in micrometres
+ *  @param p_top Where to put the top
+ *  @param p_bottom Where to put the bottom
+ */
+
+void combined_optimiser::terms (uint8_t spoke, int16_t lateral, int16_t radial,
+								int32_t* p_top, int32_t* p_bottom)
+{
+	int32_t lateral_gain = p_lateral->get_gain (spoke);
+	int32_t radial_gain = p_radial->get_gain (spoke);
+
+	lateral /= GAIN_UNIT_MICRONS;
+	radial /= GAIN_UNIT_MICRONS;
+
+	*p_top = lateral_gain * lateral
+			 + ((radial_gain * radial * COMBINED_RADIAL_WEIGHT) >> 2);
+	*p_bottom = ((lateral_gain * lateral_gain) >> GAIN_FRAC_BITS)
+				+ ((((radial_gain * radial_gain) >> GAIN_FRAC_BITS)
+					* COMBINED_RADIAL_WEIGHT) >> 2);
+	if (*p_bottom < COMBINED_ONE / 16)
+	{
+		*p_bottom = COMBINED_ONE / 16;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method works out each spoke's combined error, which is how much of its
+ *  error the best turns for it would take away.
+ *  @param lateral Each spoke's sideways offset from the average
+ *  @param radial Each spoke's radial offset from the average
+ *  @param combined Where to put each spoke's combined error, in micrometres
+ *  @param spokes How many spokes the wheel has
+ *  @param tolerance An offset less than this, on either axis, is good enough
+ */
+
+void combined_optimiser::errors (const int16_t lateral[], const int16_t radial[],
+								 int16_t combined[], uint8_t spokes, uint16_t tolerance)
+{
+	int32_t top, bottom;
+
+	for (uint8_t spoke = 0; spoke < spokes; spoke++)
+	{
+		terms (spoke, lateral[spoke], radial[spoke], &top, &bottom);
+
+		// The bottom has GAIN_FRAC_BITS fraction bits, so its root has half as many
+		int32_t error = COMBINED_SIZE (top) * GAIN_UNIT_MICRONS
+						/ ((int32_t)combined_sqrt (bottom) << (GAIN_FRAC_BITS / 2));
+		if (COMBINED_SIZE (lateral[spoke]) < (int32_t)tolerance
+			&& COMBINED_SIZE (radial[spoke]) < (int32_t)tolerance)
+		{
+			error = 0;
+		}
+		else if (error < (int32_t)tolerance)
+		{
+			error = tolerance;
+		}
+		combined[spoke] = (error > 0x7FFF) ? 0x7FFF : (int16_t)error;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method works out how many quarter turns to tighten a spoke by to make
+ *  the weighted sum of its squared offsets as small as it can be.
+ *  \details At least one quarter turn and no more than \c GAIN_MAX_TURNS are asked
+ *  for. If the two offsets cancel out exactly, the sideways one is trued.
+ *  @param spoke The spoke to be adjusted
+ *  @param lateral Its sideways offset, in micrometres
+ *  @param radial Its radial offset, in micrometres
+ *  @return How many quarter turns to tighten it by; negative to loosen it
+ */
+
+int8_t combined_optimiser::prescribe (uint8_t spoke, int16_t lateral, int16_t radial)
+{
+	int32_t top, bottom;
+
+	terms (spoke, lateral, radial, &top, &bottom);
+	if (top == 0)
+	{
+		return (p_lateral->prescribe (spoke, lateral));
+	}
+
+	int32_t turns = (COMBINED_SIZE (top) + bottom / 2) / bottom;
+	if (turns < 1)
+	{
+		turns = 1;
+	}
+	else if (turns > GAIN_MAX_TURNS)
+	{
+		turns = GAIN_MAX_TURNS;
+	}
+
+	return ((top > 0) ? -(int8_t)turns : (int8_t)turns);
+}
@@ -0,0 +1,90 @@
+//*************************************************************************************
+/** \file combined_optimiser.h
+ *    This file contains an optimiser which trues the rim sideways and radially at
+ *    once. From the offsets measured on both axes and the gains learned for each, it
+ *    works out how much each spoke could improve the wheel and how far to turn it.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, lateral and radial truing together
+ *    \li 10-18-26 Offsets and errors are in micrometres
+ *    \li 10-18-26 The gain model's units, not counts, in the comments
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+
+// This define prevents this .h file from being included multiple times in a .cpp file
+#ifndef _COMBINED_OPTIMISER_H_
+#define _COMBINED_OPTIMISER_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "gain_model.h"                     // How far a quarter turn moves the rim
+
+
+/** How much the radial error counts for against the sideways error, in quarters; 4
+ *  makes a micrometre of radial offset as bad as a micrometre of sideways offset.
+ */
+#define COMBINED_RADIAL_WEIGHT	4
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This class chooses spokes and turns which improve the rim's sideways and
+ *  radial errors together.
+ *  \details Turning a spoke by u quarter turns changes its sideways offset L by
+ *  gL u and its radial offset R by gR u, where gL and gR are the gains learned for
+ *  it. The turns which leave the least weighted sum of squares,
+ *  (L + gL u)^2 + w (R + gR u)^2, are
+ *
+ *      u = -(gL L + w gR R) / (gL^2 + w gR^2)
+ *
+ *  and the error which those turns take away is (gL L + w gR R) / sqrt (gL^2 +
+ *  w gR^2). That's the spoke's combined error, which the route planner ranks spokes
+ *  by in place of their sideways offsets. A spoke whose sideways offset is what's
+ *  needed to hold its radial offset, or the other way round, has a small combined
+ *  error, so it's left alone; its neighbour on the other flange is better placed to
+ *  fix both.
+ *
+ *  A spoke out of tolerance on either axis is given at least the tolerance as its
+ *  combined error, so the planner doesn't stop while any spoke is still out, and one
+ *  within tolerance on both is given none.
+ */
+
+class combined_optimiser
+{
+	protected:
+		/// The gains from turns to sideways offset
+		gain_model* p_lateral;
+
+		/// The gains from turns to radial offset
+		gain_model* p_radial;
+
+		// Work out the top and bottom of the best turns for a spoke
+		void terms (uint8_t spoke, int16_t lateral, int16_t radial,
+					int32_t* p_top, int32_t* p_bottom);
+
+	public:
+		// The constructor saves the two gain models
+		combined_optimiser (gain_model* a_lateral, gain_model* a_radial);
+
+		// Work out each spoke's combined error, for the route planner
+		void errors (const int16_t lateral[], const int16_t radial[],
+					 int16_t combined[], uint8_t spokes, uint16_t tolerance);
+
+		// Work out how many quarter turns to tighten a spoke by
+		int8_t prescribe (uint8_t spoke, int16_t lateral, int16_t radial);
+};
+
+#endif // _COMBINED_OPTIMISER_H_
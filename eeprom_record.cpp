@@ -0,0 +1,48 @@
+//*************************************************************************************
+/** \file eeprom_record.cpp
+ *    This file contains the check value of records kept in EEPROM. See
+ *    \c eeprom_record.h for which CRC it is.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, one check value for the pot tables and wheel records
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include <util/crc16.h>                     // For the CRC-CCITT
+#include "eeprom_record.h"                  // Header for this file
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function works out the check value of a record kept in EEPROM.
+ *  \details A record keeps its check value after everything else in it, so the
+ *  length given is usually \c offsetof() the check value.
+ *  @param p_record A pointer to the record
+ *  @param length How many bytes of the record the check value covers
+ *  @return The CRC-CCITT of those bytes
+ */
+
+uint16_t eeprom_record_crc (const void* p_record, size_t length)
+{
+	const uint8_t* p_byte = (const uint8_t*)p_record;
+	uint16_t crc = 0xFFFF;
+
+	while (length--)
+	{
+		crc = _crc_ccitt_update (crc, *p_byte++);
+	}
+
+	return (crc);
+}
@@ -0,0 +1,37 @@
+//*************************************************************************************
+/** \file eeprom_record.h
+ *    This file contains the check value which every record kept in EEPROM ends with,
+ *    so that a record saved from an erased or half written EEPROM isn't used. It's the
+ *    CRC-CCITT of avr-libc's \c _crc_ccitt_update(), which isn't the one telemetry
+ *    records are framed with, so tables already saved still check.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, one check value for the pot tables and wheel records
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+// This define prevents this .h file from being included multiple times in a .cpp file
+#ifndef _EEPROM_RECORD_H_
+#define _EEPROM_RECORD_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+// Work out the check value of the bytes of a record before its check value
+uint16_t eeprom_record_crc (const void* p_record, size_t length);
+
+#endif // _EEPROM_RECORD_H_
@@ -0,0 +1,169 @@
+//*************************************************************************************
+/** \file event_log.cpp
+ *    This file contains the capture log's ring buffer and the functions which put
+ *    sensor events into it. See \c event_log.h for the record format.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, capture of sensor events for replay
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include "FreeRTOS.h"                       // Primary header for FreeRTOS
+#include "task.h"                           // For the RTOS tick count
+
+#include "event_log.h"                      // Header for this file
+
+
+// The ring buffer takes up RAM, so nothing here is built unless it's wanted
+#ifdef EVENT_CAPTURE
+
+/// The ring buffer of records waiting to be sent out
+static uint16_t event_buffer[EVENT_LOG_SIZE];
+
+/// Where the next record will be put into the ring buffer
+static uint8_t event_write_index = 0;
+
+/// Where the next record will be taken out of the ring buffer
+static uint8_t event_read_index = 0;
+
+/// The RTOS tick at which the last record was logged; all times are relative to it
+static portTickType event_last_tick = 0;
+
+/// How many records have been thrown away since the last one which fitted
+static uint16_t event_lost_count = 0;
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function puts a record into the ring buffer.
+ *  \details If the ring is full, the record is counted as lost instead. The next time
+ *  there's room for two records, an \c EVENT_LOST record goes in ahead of the new
+ *  one so that whoever plays the log back knows there's a gap. It must be called with
+ *  interrupts disabled.
+ *  @param record The record to be logged
+ */
+
+static void event_log_put (uint16_t record)
+{
+	uint8_t used = (event_write_index - event_read_index) & (EVENT_LOG_SIZE - 1);
+
+	if (event_lost_count != 0)
+	{
+		if (used >= EVENT_LOG_SIZE - 2)
+		{
+			if (event_lost_count < EVENT_COUNT_MAX)
+			{
+				event_lost_count++;
+			}
+			return;
+		}
+		event_buffer[event_write_index] = ((uint16_t)EVENT_LOST << EVENT_TYPE_SHIFT)
+										  | event_lost_count;
+		event_write_index = (event_write_index + 1) & (EVENT_LOG_SIZE - 1);
+		event_lost_count = 0;
+	}
+	else if (used >= EVENT_LOG_SIZE - 1)
+	{
+		event_lost_count = 1;
+		return;
+	}
+
+	event_buffer[event_write_index] = record;
+	event_write_index = (event_write_index + 1) & (EVENT_LOG_SIZE - 1);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function finds how many milliseconds have gone by since the last record
+ *  and moves the log's clock on to now.
+ *  \details If more time has gone by than the next record can carry, \c EVENT_TIME
+ *  records are logged to make up the difference. It must be called with interrupts
+ *  disabled.
+ *  @param max_dt The most milliseconds the next record can carry
+ *  @return The milliseconds which the next record should carry
+ */
+
+static uint16_t event_log_time (uint16_t max_dt)
+{
+	portTickType now = xTaskGetTickCountFromISR ();
+	portTickType dt = now - event_last_tick;
+
+	event_last_tick = now;
+	while (dt > max_dt)
+	{
+		uint16_t step = (dt > EVENT_COUNT_MAX) ? EVENT_COUNT_MAX : (uint16_t)dt;
+		event_log_put (((uint16_t)EVENT_TIME << EVENT_TYPE_SHIFT) | step);
+		dt -= step;
+	}
+
+	return ((uint16_t)dt);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function logs an edge on one of the external interrupt pins.
+ *  \details It's called from the pin's ISR, so interrupts are already disabled.
+ *  @param type Which pin it was: \c EVENT_INT4, \c EVENT_INT5 or \c EVENT_INT6
+ *  @param level The pin's level after the edge
+ */
+
+void event_log_edge (uint8_t type, bool level)
+{
+	uint16_t dt = event_log_time (EVENT_EDGE_MAX_DT);
+
+	event_log_put (((uint16_t)type << EVENT_TYPE_SHIFT)
+				   | (level ? (1 << EVENT_LEVEL_BIT) : 0) | dt);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function logs a reading from the A/D converter.
+ *  \details An A/D record doesn't carry a time of its own, so any time which has gone
+ *  by since the last record is logged first.
+ *  @param channel The A/D channel which was read, from 0 to 7
+ *  @param value The 10-bit reading
+ */
+
+void event_log_adc (uint8_t channel, uint16_t value)
+{
+	portENTER_CRITICAL ();
+	event_log_time (0);
+	event_log_put (((uint16_t)EVENT_ADC << EVENT_TYPE_SHIFT)
+				   | ((uint16_t)(channel & 0x07) << 10) | (value & 0x03FF));
+	portEXIT_CRITICAL ();
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function takes the oldest record out of the ring buffer.
+ *  \details It must be called with interrupts disabled, as the ISR's write to the
+ *  ring buffer.
+ *  @param p_record A pointer to where the record is to be put
+ *  @return True if there was a record, false if the ring buffer was empty
+ */
+
+bool event_log_get (uint16_t* p_record)
+{
+	if (event_read_index == event_write_index)
+	{
+		return (false);
+	}
+
+	*p_record = event_buffer[event_read_index];
+	event_read_index = (event_read_index + 1) & (EVENT_LOG_SIZE - 1);
+	return (true);
+}
+
+#endif // EVENT_CAPTURE
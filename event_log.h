@@ -0,0 +1,117 @@
+//*************************************************************************************
+/** \file event_log.h
+ *    This file contains the interface to the capture log, which records every edge
+ *    on the spoke sensor and encoder pins and every potentiometer reading in a ring
+ *    buffer in RAM, so that a session which went badly can be played back later on a
+ *    PC (see \c host/sim/sim_replay.cpp). The log is only built when the program is
+ *    compiled with \c -DEVENT_CAPTURE; otherwise the logging macros are empty.
+ *
+ *    Each event is one 16-bit record. The top three bits give its type:
+ *    \li \c EVENT_TIME  The clock moves on by the number of milliseconds in bits 12-0
+ *    \li \c EVENT_INT4, \c EVENT_INT5, \c EVENT_INT6  An edge on PE4, PE5 or PE6.
+ *        Bit 12 is the pin's new level and bits 11-0 are the milliseconds since the
+ *        previous record
+ *    \li \c EVENT_ADC   An A/D reading, taken at the time of the previous record.
+ *        Bits 12-10 are the channel and bits 9-0 are the reading
+ *    \li \c EVENT_LOST  Bits 12-0 records were thrown away because the ring was full
+ *
+ *    The \c task_event_log task streams the records out of the serial port as lines
+ *    of text, each of which is "@E", a line number, up to \c EVENT_LOG_LINE_WORDS
+ *    records and a checksum, all in hexadecimal, so they can be picked out of a
+ *    terminal log which also has the user interface's output in it.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, capture of sensor events for replay
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+// This define prevents this .h file from being included multiple times in a .cpp file
+#ifndef _EVENT_LOG_H_
+#define _EVENT_LOG_H_
+
+#include <stdint.h>
+
+
+/// The number of records the ring buffer holds; it must be a power of two
+#define EVENT_LOG_SIZE			128
+
+/// The most records sent out on one line of text
+#define EVENT_LOG_LINE_WORDS	8
+
+/// How often, in milliseconds, the streaming task empties the ring buffer
+#define EVENT_LOG_PERIOD_MS		50
+
+/// How many bits to the left a record's type is shifted
+#define EVENT_TYPE_SHIFT		13
+
+/// Record type: the clock moves on
+#define EVENT_TIME				0
+
+/// Record type: an edge on the spoke sensor pin, PE4
+#define EVENT_INT4				1
+
+/// Record type: an edge on encoder channel A, PE5
+#define EVENT_INT5				2
+
+/// Record type: an edge on encoder channel B, PE6
+#define EVENT_INT6				3
+
+/// Record type: a reading from the A/D converter
+#define EVENT_ADC				4
+
+/// Record type: some records were lost because the ring buffer was full
+#define EVENT_LOST				7
+
+/// The bit in an edge record which holds the pin's new level
+#define EVENT_LEVEL_BIT			12
+
+/// The largest time difference an edge record can carry, in milliseconds
+#define EVENT_EDGE_MAX_DT		0x0FFF
+
+/// The largest number a time or lost record can carry
+#define EVENT_COUNT_MAX			0x1FFF
+
+
+/** \brief This macro logs an edge on an external interrupt pin. It must only be used
+ *  in an interrupt service routine.
+ *  \details If EVENT_CAPTURE hasn't been defined, it's replaced with nothing.
+ */
+#ifdef EVENT_CAPTURE
+	#define EVENT_LOG_EDGE(type,level) event_log_edge ((type), (level))
+#else
+	#define EVENT_LOG_EDGE(type,level)
+#endif
+
+/** \brief This macro logs an A/D reading. It must only be used in a task.
+ *  \details If EVENT_CAPTURE hasn't been defined, it's replaced with nothing.
+ */
+#ifdef EVENT_CAPTURE
+	#define EVENT_LOG_ADC(channel,value) event_log_adc ((channel), (value))
+#else
+	#define EVENT_LOG_ADC(channel,value)
+#endif
+
+
+// Log an edge on an external interrupt pin, from within an ISR
+void event_log_edge (uint8_t type, bool level);
+
+// Log an A/D reading, from within a task
+void event_log_adc (uint8_t channel, uint16_t value);
+
+// Take the oldest record out of the ring buffer, from within a critical section
+bool event_log_get (uint16_t* p_record);
+
+#endif // _EVENT_LOG_H_
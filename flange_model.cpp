@@ -0,0 +1,116 @@
+//*************************************************************************************
+/** \file flange_model.cpp
+ *    This file contains a record of which flange of the hub each spoke goes to. See
+ *    \c flange_model.h for how it's set up and corrected.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, flanges set up by the user and corrected from
+ *        adjustments which went the wrong way
+ *    \li 10-18-26 What's been found out can be saved and given back for a wheel seen
+ *        before
+ *    \li 10-18-26 A bit for each of up to MAX_SPOKES spokes
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include "flange_model.h"
+
+
+/// Every even-numbered spoke of a wheel of up to 64 spokes
+#define FLANGE_EVEN_SPOKES		((spoke_set)0x5555555555555555ULL)
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This constructor sets up a wheel whose first spoke is on the left flange.
+ */
+
+flange_model::flange_model (void)
+{
+	set_first (true);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method sets up spokes laced to the two flanges in turn.
+ *  \details Whatever was found out about the spokes of the last wheel is forgotten.
+ *  @param first_left True if spoke 0 goes to the left flange, false for the right
+ */
+
+void flange_model::set_first (bool first_left)
+{
+	left = first_left ? FLANGE_EVEN_SPOKES : ~FLANGE_EVEN_SPOKES;
+	known = 0;
+	confirmed = 0;
+	corrected = 0;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method notes that an adjustment showed a spoke is on the flange the
+ *  model says it's on.
+ *  @param spoke The spoke which was adjusted
+ */
+
+void flange_model::confirm (uint8_t spoke)
+{
+	spoke_set bit = SPOKE_BIT (spoke);
+
+	if (!(known & bit))
+	{
+		known |= bit;
+		confirmed++;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method moves a spoke to the other flange, as an adjustment showed it's
+ *  on that one.
+ *  \details If this makes \c FLANGE_SWAP_VOTES spokes found on the other flange and
+ *  none found where the model said, the spokes nobody has found out about yet are
+ *  all swapped over too.
+ *  @param spoke The spoke which was adjusted
+ */
+
+void flange_model::correct (uint8_t spoke)
+{
+	spoke_set bit = SPOKE_BIT (spoke);
+
+	left ^= bit;
+	known |= bit;
+	corrected++;
+
+	if (corrected == FLANGE_SWAP_VOTES && confirmed == 0)
+	{
+		left ^= ~known;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method starts from the flanges found when the wheel was last on the
+ *  stand, in place of the ones the user said.
+ *  \details Spokes found out then are taken as found out now, so they're never
+ *  swapped over with the rest. Nothing has been confirmed or corrected this session.
+ *  @param p_record The spokes' flanges and which were known, as saved
+ */
+
+void flange_model::load (const flange_record* p_record)
+{
+	left = p_record->left;
+	known = p_record->known;
+	confirmed = 0;
+	corrected = 0;
+}
@@ -0,0 +1,136 @@
+//*************************************************************************************
+/** \file flange_model.h
+ *    This file contains a record of which flange of the hub each spoke goes to. A
+ *    spoke pulls the rim toward its own flange when it's tightened, so the flange,
+ *    together with which way the rim is off, says whether to tighten or loosen it.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, flanges set up by the user and corrected from
+ *        adjustments which went the wrong way
+ *    \li 10-18-26 What's been found out can be saved and given back for a wheel seen
+ *        before
+ *    \li 10-18-26 A bit for each of up to MAX_SPOKES spokes
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+// This define prevents this .h file from being included multiple times in a .cpp file
+#ifndef _FLANGE_MODEL_H_
+#define _FLANGE_MODEL_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "wheel_limits.h"                   // The most spokes a wheel can have
+
+
+/** This is true if the pot's reading goes up as the rim moves toward the left flange,
+ *  and false if it goes down. It depends on which way round the pot is mounted.
+ */
+#define FLANGE_LEFT_READS_HIGHER	true
+
+/** Once this many spokes have been found to be on the other flange from the one the
+ *  user said, and none on the one said, the user is taken to have got the first spoke
+ *  the wrong way round, and every spoke not yet found out is swapped over.
+ */
+#define FLANGE_SWAP_VOTES			2
+
+
+/** This structure holds which flange each spoke of a wheel goes to, so that it can be
+ *  kept and given back when the wheel comes back to the stand.
+ */
+struct flange_record
+{
+	spoke_set left;                         ///< A bit for each spoke on the left flange
+	spoke_set known;                        ///< A bit for each spoke found out
+};
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This class records which flange each spoke goes to.
+ *  \details At the start of a session, the spokes are taken to go to the two flanges
+ *  in turn, starting with the flange the user said the first spoke is on. That's how
+ *  nearly every wheel is laced. As spokes are adjusted, the ones which turn out to
+ *  go to the other flange are corrected one by one, and if the first few all do,
+ *  the whole pattern is swapped over, since the user most likely answered the
+ *  left or right question the wrong way round. Spokes which have been adjusted and
+ *  found to be where the model said are confirmed and never swapped.
+ *
+ *  Each spoke takes one bit, so a wheel of up to \c MAX_SPOKES spokes fits in a
+ *  \c spoke_set for the flanges and another for what's known.
+ */
+
+class flange_model
+{
+	protected:
+		/// A bit for each spoke, set if it goes to the left flange
+		spoke_set left;
+
+		/// A bit for each spoke, set once an adjustment has shown which flange it's on
+		spoke_set known;
+
+		/// How many spokes have been found on the flange the model said
+		uint8_t confirmed;
+
+		/// How many spokes have been found on the other flange from the model's
+		uint8_t corrected;
+
+	public:
+		// The constructor sets up a wheel whose first spoke is on the left
+		flange_model (void);
+
+		// Set up spokes laced to the two flanges in turn, forgetting what was found
+		void set_first (bool first_left);
+
+		/** This method says which flange a spoke goes to.
+		 *  @param spoke The spoke
+		 *  @return True if it goes to the left flange, false for the right
+		 */
+		bool is_left (uint8_t spoke)
+		{
+			return ((left & SPOKE_BIT (spoke)) != 0);
+		}
+
+		/** This method says which way a spoke's offset goes when it's tightened.
+		 *  @param spoke The spoke
+		 *  @return +1 if tightening makes the pot read higher, -1 if lower
+		 */
+		int8_t sign (uint8_t spoke)
+		{
+			return ((is_left (spoke) == FLANGE_LEFT_READS_HIGHER) ? 1 : -1);
+		}
+
+		// Note that an adjustment showed the spoke is where the model says
+		void confirm (uint8_t spoke);
+
+		// Move a spoke to the other flange, as an adjustment showed it's there
+		void correct (uint8_t spoke);
+
+		/** This method copies out which flange each spoke goes to.
+		 *  @param p_record Where to put the spokes' flanges and which are known
+		 */
+		void save (flange_record* p_record)
+		{
+			p_record->left = left;
+			p_record->known = known;
+		}
+
+		// Start from the flanges found when the wheel was last on the stand
+		void load (const flange_record* p_record);
+
+		/// Get how many spokes have been moved to the other flange this session
+		uint8_t get_corrected (void) { return (corrected); }
+};
+
+#endif // _FLANGE_MODEL_H_
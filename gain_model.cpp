@@ -0,0 +1,304 @@
+//*************************************************************************************
+/** \file gain_model.cpp
+ *    This file contains a model of how much the rim moves when a spoke is turned. See
+ *    \c gain_model.h for how the gains are learned.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, wheel and spoke gains learned as the user works
+ *    \li 10-18-26 The flange model says which way an unlearned spoke's gain goes
+ *    \li 10-18-26 A model without a flange model, for the rim's radial position
+ *    \li 10-18-26 Offsets are given in micrometres
+ *    \li 10-18-26 What's been learned can be saved and given back for a wheel seen
+ *        before
+ *    \li 10-18-26 Room for a gain for each of MAX_SPOKES spokes
+ *    \li 10-18-26 Units of GAIN_UNIT_MICRONS, not A/D counts, in the comments
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include "gain_model.h"
+
+
+/// One in the fixed point format of the gains and their variances
+#define GAIN_ONE			(1 << GAIN_FRAC_BITS)
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This constructor sets up a model which knows only the guessed gain.
+ *  @param a_flanges The model of which flange each spoke goes to, or NULL if every
+ *                   spoke moves the offset the same way
+ *  @param a_sign Which way tightening a spoke moves the offset if there's no flange
+ *                model: +1 if the reading goes up, -1 if it goes down (default: +1)
+ */
+
+gain_model::gain_model (flange_model* a_flanges, int8_t a_sign)
+{
+	p_flanges = a_flanges;
+	prior_sign = (a_sign < 0) ? -1 : 1;
+	wheel_gain = GAIN_PRIOR * GAIN_ONE;
+	reset ();
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method forgets the spokes' gains, ready for a new wheel.
+ *  \details The wheel's gain is kept, as the next wheel is likely to be much like
+ *  the last, but it's made as unsure as the first guess so the new wheel soon
+ *  replaces it.
+ */
+
+void gain_model::reset (void)
+{
+	for (uint8_t spoke = 0; spoke < MAX_SPOKES; spoke++)
+	{
+		gain[spoke] = 0;
+		variance[spoke] = 0;
+	}
+	wheel_variance = GAIN_PRIOR_VAR * GAIN_ONE;
+	updates = 0;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method updates one gain and its variance from one adjustment.
+ *  \details This is the recursive least squares update for a single gain, with the
+ *  quarter turns as the input and the change in offset as the output:
+ *  \li The weight given to the new adjustment is k = P u / (R + u^2 P), where P is
+ *      the gain's variance, u the turns and R the noise variance
+ *  \li The gain moves by k times the difference between the change measured and
+ *      the change it predicted, u times the gain
+ *  \li The variance shrinks to (1 - k u) P, then is grown a little so it never
+ *      stops learning
+ *
+ *  Gains and variances have \c GAIN_FRAC_BITS fraction bits; with the limits on
+ *  them, every product fits in 32 bits.
+ *  @param p_gain The gain to be updated
+ *  @param p_variance Its variance
+ *  @param turns How many quarter turns the spoke was tightened by; negative if it
+ *               was loosened
+ *  @param change How much the offset changed, in units of \c GAIN_UNIT_MICRONS
+ */
+
+void gain_model::update (int16_t* p_gain, uint16_t* p_variance, int8_t turns,
+						 int16_t change)
+{
+	int32_t p_u = (int32_t)*p_variance * turns;
+	int32_t denominator = (int32_t)GAIN_NOISE_VAR * GAIN_ONE + p_u * turns;
+	int32_t weight = (p_u * GAIN_ONE) / denominator;
+	int32_t error = (int32_t)change * GAIN_ONE - (int32_t)*p_gain * turns;
+
+	int32_t new_gain = *p_gain + (weight * error) / GAIN_ONE;
+	if (new_gain > GAIN_MAX * GAIN_ONE)
+	{
+		new_gain = GAIN_MAX * GAIN_ONE;
+	}
+	else if (new_gain < -GAIN_MAX * GAIN_ONE)
+	{
+		new_gain = -GAIN_MAX * GAIN_ONE;
+	}
+	*p_gain = (int16_t)new_gain;
+
+	uint32_t new_variance = *p_variance
+							- (uint32_t)((weight * turns * *p_variance) / GAIN_ONE);
+	new_variance += new_variance >> GAIN_FORGET_SHIFT;
+	if (new_variance > GAIN_MAX_VAR * GAIN_ONE)
+	{
+		new_variance = GAIN_MAX_VAR * GAIN_ONE;
+	}
+	else if (new_variance == 0)
+	{
+		new_variance = 1;
+	}
+	*p_variance = (uint16_t)new_variance;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method gets a spoke's gain.
+ *  \details A spoke which hasn't been adjusted yet is guessed to have the wheel's
+ *  gain, going whichever way the flange model says tightening it moves its offset, or
+ *  the way the model was made with if it has none.
+ *  @param spoke The spoke
+ *  @return The gain, units of offset per quarter turn times 2^GAIN_FRAC_BITS
+ */
+
+int16_t gain_model::get_gain (uint8_t spoke)
+{
+	if (spoke >= MAX_SPOKES)
+	{
+		return (wheel_gain);
+	}
+	if (variance[spoke] == 0)
+	{
+		if (p_flanges == NULL)
+		{
+			return (prior_sign * wheel_gain);
+		}
+		return (p_flanges->sign (spoke) * wheel_gain);
+	}
+	return (gain[spoke]);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method works out how many quarter turns to tighten a spoke by.
+ *  \details The turns are the offset over the spoke's gain, rounded to the nearest
+ *  quarter turn, in whichever direction takes the offset toward zero. At least one
+ *  quarter turn and no more than \c GAIN_MAX_TURNS are asked for.
+ *  @param spoke The spoke to be adjusted
+ *  @param offset Its offset, in micrometres
+ *  @return How many quarter turns to tighten it by; negative to loosen it
+ */
+
+int8_t gain_model::prescribe (uint8_t spoke, int16_t offset)
+{
+	int16_t spoke_gain = get_gain (spoke);
+	uint16_t size = (spoke_gain < 0) ? -spoke_gain : spoke_gain;
+	uint32_t turns;
+
+	if (size < GAIN_ONE / 4)
+	{
+		size = GAIN_ONE / 4;
+	}
+	uint16_t distance = (offset < 0) ? -offset : offset;
+	uint32_t per_turn = (uint32_t)size * GAIN_UNIT_MICRONS;
+	turns = ((uint32_t)distance * GAIN_ONE + per_turn / 2) / per_turn;
+	if (turns < 1)
+	{
+		turns = 1;
+	}
+	else if (turns > GAIN_MAX_TURNS)
+	{
+		turns = GAIN_MAX_TURNS;
+	}
+
+	// Tightening moves the offset the way the gain's sign says, so if that's the way
+	// it's off already, the spoke needs loosening
+	if ((offset > 0) == (spoke_gain > 0))
+	{
+		return (-(int8_t)turns);
+	}
+	return ((int8_t)turns);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method learns from how much a spoke's offset changed when it was
+ *  turned by the amount asked for.
+ *  \details The spoke's own gain is updated, starting from the wheel's if it hadn't
+ *  been learned yet. Then the wheel's gain is updated from the same adjustment, with
+ *  the change turned the way the spoke's gain now says, so that spokes on both
+ *  flanges count toward the size of the wheel's gain.
+ *  @param spoke The spoke which was turned
+ *  @param turns How many quarter turns it was tightened by; negative if loosened
+ *  @param change How much its offset changed, in micrometres
+ */
+
+void gain_model::learn (uint8_t spoke, int8_t turns, int16_t change)
+{
+	if (spoke >= MAX_SPOKES || turns == 0)
+	{
+		return;
+	}
+	change = (change + ((change < 0) ? -GAIN_UNIT_MICRONS : GAIN_UNIT_MICRONS) / 2)
+			 / GAIN_UNIT_MICRONS;
+	if (change > GAIN_MAX_CHANGE)
+	{
+		change = GAIN_MAX_CHANGE;
+	}
+	else if (change < -GAIN_MAX_CHANGE)
+	{
+		change = -GAIN_MAX_CHANGE;
+	}
+
+	if (variance[spoke] == 0)
+	{
+		gain[spoke] = get_gain (spoke);
+		variance[spoke] = GAIN_PRIOR_VAR * GAIN_ONE;
+	}
+	update (&gain[spoke], &variance[spoke], turns, change);
+
+	update (&wheel_gain, &wheel_variance, turns,
+			(gain[spoke] < 0) ? -change : change);
+	if (wheel_gain < GAIN_ONE / 4)
+	{
+		wheel_gain = GAIN_ONE / 4;
+	}
+
+	updates++;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method forgets what was learned about a spoke.
+ *  \details It's used when the flange model has been corrected, so the spoke starts
+ *  again from the wheel's gain, turned the way its flange now says.
+ *  @param spoke The spoke
+ */
+
+void gain_model::forget (uint8_t spoke)
+{
+	if (spoke < MAX_SPOKES)
+	{
+		variance[spoke] = 0;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method copies out what's been learned about the wheel.
+ *  @param p_record Where to put the spokes' and the wheel's gains and variances
+ */
+
+void gain_model::save (gain_record* p_record)
+{
+	for (uint8_t spoke = 0; spoke < MAX_SPOKES; spoke++)
+	{
+		p_record->gain[spoke] = gain[spoke];
+		p_record->variance[spoke] = variance[spoke];
+	}
+	p_record->wheel_gain = wheel_gain;
+	p_record->wheel_variance = wheel_variance;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method starts the model off from what was learned about the wheel
+ *  when it was last on the stand.
+ *  \details The wheel has been ridden since, so its spokes' tensions, and with them
+ *  their gains, may have changed a little. Each learned variance is doubled, up to
+ *  \c GAIN_MAX_VAR, so the first adjustments of this session count for more than
+ *  the old ones. Spokes which were never learned stay unlearned.
+ *  @param p_record The spokes' and the wheel's gains and variances, as saved
+ */
+
+void gain_model::load (const gain_record* p_record)
+{
+	for (uint8_t spoke = 0; spoke < MAX_SPOKES; spoke++)
+	{
+		uint32_t grown = (uint32_t)p_record->variance[spoke] * 2;
+
+		gain[spoke] = p_record->gain[spoke];
+		variance[spoke] = (grown > GAIN_MAX_VAR * GAIN_ONE) ? GAIN_MAX_VAR * GAIN_ONE
+															: (uint16_t)grown;
+	}
+	wheel_gain = p_record->wheel_gain;
+	if (wheel_gain < GAIN_ONE / 4)
+	{
+		wheel_gain = GAIN_ONE / 4;
+	}
+	wheel_variance = p_record->wheel_variance;
+	updates = 0;
+}
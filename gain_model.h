@@ -0,0 +1,183 @@
+//*************************************************************************************
+/** \file gain_model.h
+ *    This file contains a model of how much the rim moves when a spoke is turned. It
+ *    learns, from the offsets measured before and after each adjustment, how far a
+ *    quarter turn of each spoke moves the rim at the sensor, and from that works out
+ *    how many quarter turns to ask for to bring a spoke back to the middle.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, wheel and spoke gains learned as the user works
+ *    \li 10-18-26 The flange model says which way an unlearned spoke's gain goes
+ *    \li 10-18-26 A model without a flange model, for the rim's radial position
+ *    \li 10-18-26 Offsets are given in micrometres
+ *    \li 10-18-26 What's been learned can be saved and given back for a wheel seen
+ *        before
+ *    \li 10-18-26 Room for a gain for each of MAX_SPOKES spokes
+ *    \li 10-18-26 Units of GAIN_UNIT_MICRONS, not A/D counts, in the comments
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+// This define prevents this .h file from being included multiple times in a .cpp file
+#ifndef _GAIN_MODEL_H_
+#define _GAIN_MODEL_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "flange_model.h"                   // Which flange each spoke goes to
+
+
+/** Gains are kept in fixed point, as units of offset (see \c GAIN_UNIT_MICRONS) per
+ *  quarter turn times 2^GAIN_FRAC_BITS. Their variances have the same number of
+ *  fraction bits.
+ */
+#define GAIN_FRAC_BITS		8
+
+/** Offsets are given to the model in micrometres, but it keeps its gains, and the
+ *  constants below, in units of this many micrometres, so the gains fit in 16 bits.
+ *  It's the size of one A/D count of an uncalibrated pot, so the constants are the
+ *  same numbers they were when offsets were in counts.
+ */
+#define GAIN_UNIT_MICRONS	50
+
+/// How many units of offset a quarter turn is guessed to make before anything's known
+#define GAIN_PRIOR			4
+
+/// How unsure that guess is, as a variance in (units per quarter turn) squared
+#define GAIN_PRIOR_VAR		16
+
+/** How much a measured change in offset is expected to be off by, as a variance in
+ *  units squared. It covers the pot's noise in two measurements and the small
+ *  amount the other spokes' offsets shift against the average.
+ */
+#define GAIN_NOISE_VAR		16
+
+/** After each update a gain's variance is grown by 1 / 2^GAIN_FORGET_SHIFT, so that
+ *  old adjustments count for less than new ones as the spokes' tensions change.
+ */
+#define GAIN_FORGET_SHIFT	4
+
+/// The largest variance a gain is let grow to, in (units per quarter turn) squared
+#define GAIN_MAX_VAR		64
+
+/// The largest gain believed, in units per quarter turn
+#define GAIN_MAX			64
+
+/// The most quarter turns asked for at once, so a bad guess can't do much harm
+#define GAIN_MAX_TURNS		8
+
+/// The biggest change in offset which is learned from, in units; a bigger one is held
+/// down to this, as it's more likely a bad measurement than a real one
+#define GAIN_MAX_CHANGE		400
+
+
+/** This structure holds what a model has learned about one wheel, so that it can be
+ *  kept, by spoke numbers counted from the index mark, and given back to the model
+ *  when the wheel comes back to the stand.
+ */
+struct gain_record
+{
+	int16_t gain[MAX_SPOKES];               ///< Each spoke's gain
+	uint16_t variance[MAX_SPOKES];          ///< Each spoke's variance; 0 if unlearned
+	int16_t wheel_gain;                     ///< The size of the wheel's gain
+	uint16_t wheel_variance;                ///< The variance of the wheel's gain
+};
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This class learns how much the rim moves when a spoke is turned and works
+ *  out how much to turn a spoke by.
+ *  \details Each spoke's gain, the change in its offset made by a quarter turn of
+ *  tightening, is estimated by recursive least squares. After the user turns a spoke
+ *  by the amount asked for, the change in its offset updates the gain in proportion
+ *  to how unsure the gain was, and the gain's variance shrinks accordingly. Spokes on
+ *  one flange pull the rim one way and those on the other pull it the other, so a
+ *  spoke's gain can be negative.
+ *
+ *  A spoke which hasn't been adjusted yet starts from the wheel's gain, which is
+ *  learned the same way from every adjustment, using the size of the change, turned
+ *  the way the flange model says the spoke pulls. So the first adjustment of each
+ *  spoke is already about the right size for the wheel, and the right way if the
+ *  flange model has the spoke right.
+ *
+ *  A model made without a flange model, such as the one for the rim's radial
+ *  position, which every spoke moves the same way, turns every unlearned spoke's gain
+ *  the way it's told to when it's made.
+ *
+ *  All the arithmetic is in 16- and 32-bit integers. The few divisions are done once
+ *  per adjustment, so their cost on the AVR doesn't matter.
+ */
+
+class gain_model
+{
+	protected:
+		/// Each spoke's gain, units per quarter turn times 2^GAIN_FRAC_BITS
+		int16_t gain[MAX_SPOKES];
+
+		/// The variance of each spoke's gain, or zero if it hasn't been learned yet
+		uint16_t variance[MAX_SPOKES];
+
+		/// The size of the wheel's gain, the same units as the spokes' gains
+		int16_t wheel_gain;
+
+		/// The variance of the wheel's gain
+		uint16_t wheel_variance;
+
+		/// How many adjustments have been learned from since the last reset
+		uint16_t updates;
+
+		/// Which flange each spoke goes to, for the gains of unlearned spokes, or NULL
+		flange_model* p_flanges;
+
+		/// Which way every unlearned spoke's gain goes if there's no flange model
+		int8_t prior_sign;
+
+		// Update one gain and its variance from one adjustment
+		static void update (int16_t* p_gain, uint16_t* p_variance, int8_t turns,
+							int16_t change);
+
+	public:
+		// The constructor starts off knowing only the guessed gain
+		gain_model (flange_model* a_flanges, int8_t a_sign = 1);
+
+		// Forget the spokes' gains for a new wheel, keeping the wheel's as a guess
+		void reset (void);
+
+		// Work out how many quarter turns to tighten a spoke by to true it
+		int8_t prescribe (uint8_t spoke, int16_t offset);
+
+		// Learn from how much a spoke's offset changed when it was turned
+		void learn (uint8_t spoke, int8_t turns, int16_t change);
+
+		// Forget what was learned about a spoke, as it was learned the wrong way
+		void forget (uint8_t spoke);
+
+		// Copy out what's been learned about the wheel
+		void save (gain_record* p_record);
+
+		// Start from what was learned about the wheel when it was last on the stand
+		void load (const gain_record* p_record);
+
+		// Get a spoke's gain, whether learned or guessed from the wheel's
+		int16_t get_gain (uint8_t spoke);
+
+		/// Get the size of the wheel's gain, times 2^GAIN_FRAC_BITS
+		int16_t get_wheel_gain (void) { return (wheel_gain); }
+
+		/// Get how many adjustments have been learned from since the last reset
+		uint16_t get_updates (void) { return (updates); }
+};
+
+#endif // _GAIN_MODEL_H_
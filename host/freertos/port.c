@@ -0,0 +1,456 @@
+/*
+    FreeRTOS V7.1.1 port for running the truing stand firmware as a Linux process.
+
+    Each FreeRTOS task is given a POSIX thread, but the threads take turns: every
+    thread other than the one belonging to pxCurrentTCB is asleep on its own
+    condition variable. A context switch wakes the thread of the task being
+    switched in and puts the thread of the task being switched out to sleep.
+
+    The RTOS tick is taken by the idle task, from its hook, once every other task
+    is waiting for something. So however fast or busy the PC is, each tick comes
+    at the same point in what the tasks are doing, and a simulated session goes
+    the same way every time. The idle task waits for the tick's time on the wall
+    clock first, unless the speedup is 0, in which case ticks come as fast as the
+    tasks can get through them.
+
+    A task which never waits would stop the clock, so SIGVTALRM from an interval
+    timer on the process's CPU time acts as a watchdog: if a whole period of CPU
+    time goes by without a tick, it takes one, just as the AVR's timer interrupt
+    would. From then on the run can't be repeated exactly, so a warning is given.
+    Only the running thread ever has the signal unblocked, so the handler always
+    runs "on" the current task. Blocking the signal stands in for clearing the
+    AVR's global interrupt flag.
+
+    FreeRTOS is distributed under the modified GPL described in the AVR port's
+    files; this file is released under the same terms.
+*/
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include <errno.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*-----------------------------------------------------------
+ * Implementation of functions defined in portable.h for the host port.
+ *----------------------------------------------------------*/
+
+/* This is the signal of the watchdog which takes a tick if a task never waits;
+it's blocked wherever the AVR would have interrupts off. */
+#define portTICK_SIGNAL							SIGVTALRM
+
+/* The watchdog takes a tick if this many microseconds of CPU time go by without
+one. Tasks normally get through a tick in a few microseconds. */
+#define portWATCHDOG_MICROSECONDS				100000L
+
+/* Everything the port needs to know about the thread running one task. */
+typedef struct HOST_THREAD
+{
+	pthread_t xThread;
+	pdTASK_CODE pxCode;
+	void *pvParameters;
+	pthread_mutex_t xMutex;
+	pthread_cond_t xCondition;
+	volatile int xMayRun;
+} xHostThread;
+
+/* We require the address of the pxCurrentTCB variable, but don't want to know
+any details of its type. */
+typedef void tskTCB;
+extern volatile tskTCB * volatile pxCurrentTCB;
+
+/* The critical nesting count and the interrupt flag belong to whichever task is
+running; they're saved and restored around every context switch. */
+static volatile unsigned portBASE_TYPE uxCriticalNesting = 0;
+static volatile int xInInterrupt = 0;
+
+/* How many times faster than real time the tick runs, or 0 for as fast as the
+tasks can go. */
+static uint32_t ulTickSpeedup = 1;
+
+/* When the scheduler started, on the monotonic clock, for pacing the ticks. */
+static struct timespec xStartTime;
+
+/* How many ticks have been taken, and how many had been at the last watchdog
+check; both are only touched with the tick signal blocked. */
+static volatile unsigned long ulTicksTaken = 0;
+static volatile unsigned long ulTicksAtWatchdog = 0;
+
+/* Used by the main thread to wait in xPortStartScheduler() until the scheduler
+is ended. */
+static pthread_mutex_t xEndMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t xEndCondition = PTHREAD_COND_INITIALIZER;
+static volatile int xSchedulerEnded = 0;
+
+/* The hook called at each tick by the hardware stand-ins. */
+void ( *vPortHostTickHook )( void ) = NULL;
+
+/* If stack tracing is active, declare a variable which will be used by the task
+ * wrapper class to get the address of the top of the stack just after a task has
+ * been created. */
+#if (INCLUDE_uxTaskGetStackHighWaterMark == 1)
+	size_t portStackTopForTask;
+#endif
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The thread record of a task is kept in a small block of ordinary memory, and a
+ * pointer to it is put at the top of the task's FreeRTOS stack. Since this port
+ * never moves pxTopOfStack after the task has been created, the first member of
+ * the TCB always points at that pointer.
+ */
+static xHostThread *prvThreadOf( volatile tskTCB *pxTCB )
+{
+	return *( xHostThread ** )( *( portSTACK_TYPE ** ) pxTCB );
+}
+/*-----------------------------------------------------------*/
+
+static void prvBlockTick( void )
+{
+sigset_t xSignals;
+
+	sigemptyset( &xSignals );
+	sigaddset( &xSignals, portTICK_SIGNAL );
+	pthread_sigmask( SIG_BLOCK, &xSignals, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvUnblockTick( void )
+{
+sigset_t xSignals;
+
+	sigemptyset( &xSignals );
+	sigaddset( &xSignals, portTICK_SIGNAL );
+	pthread_sigmask( SIG_UNBLOCK, &xSignals, NULL );
+}
+/*-----------------------------------------------------------*/
+
+/* Let the given thread run. */
+static void prvResumeThread( xHostThread *pxThread )
+{
+	pthread_mutex_lock( &pxThread->xMutex );
+	pxThread->xMayRun = 1;
+	pthread_cond_signal( &pxThread->xCondition );
+	pthread_mutex_unlock( &pxThread->xMutex );
+}
+/*-----------------------------------------------------------*/
+
+/* Put the calling thread, whose record is given, to sleep until it's resumed. */
+static void prvSuspendThread( xHostThread *pxThread )
+{
+	pthread_mutex_lock( &pxThread->xMutex );
+	while( !pxThread->xMayRun )
+	{
+		pthread_cond_wait( &pxThread->xCondition, &pxThread->xMutex );
+	}
+	pxThread->xMayRun = 0;
+	pthread_mutex_unlock( &pxThread->xMutex );
+}
+/*-----------------------------------------------------------*/
+
+/* Switch from one task's thread to another's; returns when the calling thread
+is switched back in. */
+static void prvSwitchThread( xHostThread *pxToResume, xHostThread *pxToSuspend )
+{
+unsigned portBASE_TYPE uxSavedNesting;
+int xSavedInInterrupt;
+
+	if( pxToResume != pxToSuspend )
+	{
+		uxSavedNesting = uxCriticalNesting;
+		xSavedInInterrupt = xInInterrupt;
+
+		prvResumeThread( pxToResume );
+		prvSuspendThread( pxToSuspend );
+
+		uxCriticalNesting = uxSavedNesting;
+		xInInterrupt = xSavedInInterrupt;
+	}
+}
+/*-----------------------------------------------------------*/
+
+/* This is where every task's thread begins. It waits until the scheduler first
+switches to its task, then runs the task function with interrupts enabled. */
+static void *prvThreadStart( void *pvParameters )
+{
+xHostThread *pxThread = ( xHostThread * ) pvParameters;
+
+	prvSuspendThread( pxThread );
+
+	uxCriticalNesting = 0;
+	xInInterrupt = 0;
+	prvUnblockTick();
+
+	pxThread->pxCode( pxThread->pvParameters );
+
+	/* Task functions must never return; the AVR port would crash here. */
+	fprintf( stderr, "A task function returned; stopping\n" );
+	exit( EXIT_FAILURE );
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Set up a task's thread. The thread is created right away but waits until the
+ * scheduler switches to its task for the first time.
+ */
+portSTACK_TYPE *pxPortInitialiseStack( portSTACK_TYPE *pxTopOfStack, pdTASK_CODE pxCode, void *pvParameters )
+{
+xHostThread *pxThread;
+xHostThread **ppxRecord;
+sigset_t xAllSignals, xOldSignals;
+pthread_attr_t xAttributes;
+
+	pxThread = ( xHostThread * ) malloc( sizeof( xHostThread ) );
+	if( pxThread == NULL )
+	{
+		fprintf( stderr, "Out of memory creating a task thread\n" );
+		exit( EXIT_FAILURE );
+	}
+	pxThread->pxCode = pxCode;
+	pxThread->pvParameters = pvParameters;
+	pxThread->xMayRun = 0;
+	pthread_mutex_init( &pxThread->xMutex, NULL );
+	pthread_cond_init( &pxThread->xCondition, NULL );
+
+	/* Put the pointer to the record at the (aligned) top of the stack. */
+	ppxRecord = ( xHostThread ** ) ( ( ( uintptr_t ) pxTopOfStack + 1 - sizeof( xHostThread * ) ) & ~( uintptr_t ) ( sizeof( xHostThread * ) - 1 ) );
+	*ppxRecord = pxThread;
+
+	#if (INCLUDE_uxTaskGetStackHighWaterMark == 1)
+		portStackTopForTask = ( size_t ) ( ( uintptr_t ) ppxRecord - 1 );
+	#endif
+
+	/* The new thread must start with every signal blocked so that it can't take
+	a tick before it has been switched in. It inherits the creator's mask. */
+	sigfillset( &xAllSignals );
+	pthread_sigmask( SIG_SETMASK, &xAllSignals, &xOldSignals );
+
+	pthread_attr_init( &xAttributes );
+	pthread_attr_setdetachstate( &xAttributes, PTHREAD_CREATE_DETACHED );
+	if( pthread_create( &pxThread->xThread, &xAttributes, prvThreadStart, pxThread ) != 0 )
+	{
+		fprintf( stderr, "Unable to create a task thread\n" );
+		exit( EXIT_FAILURE );
+	}
+	pthread_attr_destroy( &xAttributes );
+
+	pthread_sigmask( SIG_SETMASK, &xOldSignals, NULL );
+
+	return ( portSTACK_TYPE * ) ppxRecord;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * The tick interrupt. It runs in the thread of whichever task was running, lets
+ * the hardware stand-ins do their work, increments the tick count and, because
+ * the scheduler is preemptive, switches context if a task should now run. The
+ * tick signal must be blocked.
+ */
+static void prvTakeTick( void )
+{
+xHostThread *pxSuspend;
+
+	xInInterrupt = 1;
+	uxCriticalNesting++;
+	ulTicksTaken++;
+
+	if( vPortHostTickHook != NULL )
+	{
+		vPortHostTickHook();
+	}
+
+	pxSuspend = prvThreadOf( pxCurrentTCB );
+	vTaskIncrementTick();
+	#if configUSE_PREEMPTION == 1
+		vTaskSwitchContext();
+	#endif
+	prvSwitchThread( prvThreadOf( pxCurrentTCB ), pxSuspend );
+
+	uxCriticalNesting--;
+	xInInterrupt = 0;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * The watchdog's handler takes a tick if none has been taken since it last ran,
+ * as some task must be running without ever waiting.
+ */
+static void prvWatchdogHandler( int iSignal )
+{
+static int xWarned = 0;
+
+	( void ) iSignal;
+
+	if( ulTicksTaken != ulTicksAtWatchdog )
+	{
+		ulTicksAtWatchdog = ulTicksTaken;
+		return;
+	}
+
+	if( !xWarned )
+	{
+		xWarned = 1;
+		fprintf( stderr, "WARNING: task %s never waits; ticks are now timed by the "
+				 "CPU clock, so this run can't be repeated exactly\n",
+				 ( const char * ) pcTaskGetTaskName( NULL ) );
+	}
+	prvTakeTick();
+	ulTicksAtWatchdog = ulTicksTaken;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * The idle task runs only when every other task is waiting, which is when the
+ * next tick is taken. Unless ticks are to come as fast as they can, it first
+ * sleeps until the tick is due on the wall clock.
+ */
+void vApplicationIdleHook( void )
+{
+struct timespec xDue;
+unsigned long long ullNanoseconds;
+
+	if( ulTickSpeedup != 0 )
+	{
+		ullNanoseconds = ( unsigned long long ) ( ulTicksTaken + 1 )
+						 * ( 1000000000ULL / configTICK_RATE_HZ ) / ulTickSpeedup;
+		xDue.tv_sec = xStartTime.tv_sec + ( time_t ) ( ullNanoseconds / 1000000000ULL );
+		xDue.tv_nsec = xStartTime.tv_nsec + ( long ) ( ullNanoseconds % 1000000000ULL );
+		if( xDue.tv_nsec >= 1000000000L )
+		{
+			xDue.tv_sec++;
+			xDue.tv_nsec -= 1000000000L;
+		}
+		while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &xDue, NULL ) == EINTR )
+		{
+		}
+	}
+
+	prvBlockTick();
+	prvTakeTick();
+	prvUnblockTick();
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xPortStartScheduler( void )
+{
+struct sigaction xAction;
+struct itimerval xTimer;
+
+	/* The main thread must never take a tick itself. */
+	prvBlockTick();
+
+	memset( &xAction, 0, sizeof( xAction ) );
+	xAction.sa_handler = prvWatchdogHandler;
+	xAction.sa_flags = SA_RESTART;
+	sigfillset( &xAction.sa_mask );
+	sigaction( portTICK_SIGNAL, &xAction, NULL );
+
+	xTimer.it_interval.tv_sec = portWATCHDOG_MICROSECONDS / 1000000L;
+	xTimer.it_interval.tv_usec = portWATCHDOG_MICROSECONDS % 1000000L;
+	xTimer.it_value = xTimer.it_interval;
+	setitimer( ITIMER_VIRTUAL, &xTimer, NULL );
+
+	clock_gettime( CLOCK_MONOTONIC, &xStartTime );
+
+	/* Start the first task. */
+	prvResumeThread( prvThreadOf( pxCurrentTCB ) );
+
+	/* Wait here until a task ends the scheduler. */
+	pthread_mutex_lock( &xEndMutex );
+	while( !xSchedulerEnded )
+	{
+		pthread_cond_wait( &xEndCondition, &xEndMutex );
+	}
+	pthread_mutex_unlock( &xEndMutex );
+
+	/* Should only get here if vTaskEndScheduler() was called. */
+	return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler( void )
+{
+struct itimerval xTimer;
+
+	memset( &xTimer, 0, sizeof( xTimer ) );
+	setitimer( ITIMER_VIRTUAL, &xTimer, NULL );
+
+	pthread_mutex_lock( &xEndMutex );
+	xSchedulerEnded = 1;
+	pthread_cond_signal( &xEndCondition );
+	pthread_mutex_unlock( &xEndMutex );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Manual context switch, called by a task which is giving up the processor.
+ */
+void vPortYield( void )
+{
+xHostThread *pxSuspend;
+
+	vPortEnterCritical();
+
+	pxSuspend = prvThreadOf( pxCurrentTCB );
+	vTaskSwitchContext();
+	prvSwitchThread( prvThreadOf( pxCurrentTCB ), pxSuspend );
+
+	vPortExitCritical();
+}
+/*-----------------------------------------------------------*/
+
+void vPortDisableInterrupts( void )
+{
+	prvBlockTick();
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnableInterrupts( void )
+{
+	/* Interrupts stay off until the end of an interrupt handler, just as they
+	would on the AVR unless the handler did something unwise. */
+	if( !xInInterrupt )
+	{
+		prvUnblockTick();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical( void )
+{
+	prvBlockTick();
+	uxCriticalNesting++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical( void )
+{
+	if( uxCriticalNesting > 0 )
+	{
+		uxCriticalNesting--;
+		if( uxCriticalNesting == 0 )
+		{
+			vPortEnableInterrupts();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+int xPortInInterrupt( void )
+{
+	return xInInterrupt;
+}
+/*-----------------------------------------------------------*/
+
+void vPortSetTickSpeedup( uint32_t ulSpeedup )
+{
+	ulTickSpeedup = ulSpeedup;
+}
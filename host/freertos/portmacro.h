@@ -0,0 +1,124 @@
+/*
+    FreeRTOS V7.1.1 port for running the truing stand firmware as a Linux process.
+
+    This port is used only by the host simulation build in the host/ directory. It
+    is selected by defining GCC_POSIX_HOST, which makes portable.h include this
+    file instead of the AVR portmacro.h. Each task runs in its own POSIX thread,
+    but only one thread is ever allowed to run at a time, so the kernel sees the
+    same single-CPU world that it sees on the AVR. The RTOS tick comes from an
+    interval timer signal, and "disabling interrupts" means blocking that signal.
+
+    FreeRTOS is distributed under the modified GPL described in the AVR port's
+    files; this file is released under the same terms.
+*/
+
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*-----------------------------------------------------------
+ * Port specific definitions.
+ *
+ * The sizes of the stack and tick types match the AVR port so that the stack
+ * sizes given to tasks, and arithmetic done on tick counts, mean the same thing
+ * in both builds. The base type is widened to suit a 64-bit processor.
+ *-----------------------------------------------------------
+ */
+
+/* Type definitions. */
+#define portCHAR		char
+#define portFLOAT		float
+#define portDOUBLE		double
+#define portLONG		int
+#define portSHORT		short
+#define portSTACK_TYPE	unsigned char
+#define portBASE_TYPE	long
+
+/* This is the prescaler the AVR uses for the tick timer; the time stamp code uses
+it to work out how fast the hardware counter runs. */
+#define portCLOCK_PRESCALER	8
+
+#if( configUSE_16_BIT_TICKS == 1 )
+	typedef uint16_t portTickType;
+	#define portMAX_DELAY ( portTickType ) 0xffff
+#else
+	typedef uint32_t portTickType;
+	#define portMAX_DELAY ( portTickType ) 0xffffffff
+#endif
+
+/* Pointers may be 64 bits wide on the host. */
+#define portPOINTER_SIZE_TYPE	uintptr_t
+
+/*-----------------------------------------------------------*/
+
+/* Critical section management. */
+void vPortEnterCritical( void );
+void vPortExitCritical( void );
+void vPortDisableInterrupts( void );
+void vPortEnableInterrupts( void );
+
+#define portENTER_CRITICAL()		vPortEnterCritical()
+#define portEXIT_CRITICAL()			vPortExitCritical()
+#define portDISABLE_INTERRUPTS()	vPortDisableInterrupts()
+#define portENABLE_INTERRUPTS()		vPortEnableInterrupts()
+/*-----------------------------------------------------------*/
+
+/* Architecture specifics. */
+#define portSTACK_GROWTH			( -1 )
+#define portTICK_RATE_MS			( ( portTickType ) 1000 / configTICK_RATE_HZ )
+#define portBYTE_ALIGNMENT			8
+#define portNOP()
+/*-----------------------------------------------------------*/
+
+/* Kernel utilities. */
+void vPortYield( void );
+#define portYIELD()					vPortYield()
+/*-----------------------------------------------------------*/
+
+/* Task function macros as described on the FreeRTOS.org WEB site. */
+#define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) void vFunction( void *pvParameters )
+#define portTASK_FUNCTION( vFunction, pvParameters ) void vFunction( void *pvParameters )
+
+/* Run time statistics use the same counter function as the AVR build. */
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()  func_get_run_time_counter ()
+uint32_t func_get_run_time_counter (void);
+
+/*-----------------------------------------------------------
+ * Things the host hardware stand-ins need from the port.
+ *-----------------------------------------------------------
+ */
+
+/* This returns nonzero while code is running in (simulated) interrupt context,
+that is inside the tick handler or anything it calls. */
+int xPortInInterrupt( void );
+
+/* This function, if set, is called from interrupt context at every RTOS tick, just
+before the kernel's tick processing. The hardware stand-ins use it to deliver
+received characters and simulated pin changes. */
+extern void ( *vPortHostTickHook )( void );
+
+/* This sets how many times faster than real time the RTOS tick runs, or with 0,
+that ticks come as fast as the tasks can get through them. It only sets the pace;
+each tick comes when every task is waiting, so what happens doesn't depend on it.
+It must be called before the scheduler is started; the default is 1 (real time). */
+void vPortSetTickSpeedup( uint32_t ulSpeedup );
+
+#ifdef __cplusplus
+}
+#endif
+
+/*-----------------------------------------------------------*/
+
+/* The task wrapper class reads this to find the top of a new task's stack. It's
+as wide as a pointer, as the AVR port's is, so a stack can be dumped on the host. */
+#if (INCLUDE_uxTaskGetStackHighWaterMark == 1)
+	extern size_t portStackTopForTask;
+#endif
+
+#endif /* PORTMACRO_H */
@@ -0,0 +1,630 @@
+//*************************************************************************************
+/** \file host_hardware.cpp
+ *    This file contains the pretend ATmega1281 peripherals of the host build: storage
+ *    for the registers declared in the stand-in <avr/io.h>, the external interrupt
+ *    and A/D converter logic which the truing stand's drivers rely upon, the serial
+ *    port's connection to the terminal.
+ *
+ *    The serial port is connected to standard input and output unless the environment
+ *    variable \c HOST_SERIAL is set to \c pty, in which case a pseudo-terminal is made
+ *    and its name printed so that a terminal program can be connected to it. The RTOS
+ *    tick runs \c HOST_SPEEDUP times faster than real time if that variable is set,
+ *    or as fast as it can if it's 0; see \c host/freertos/port.c for why that doesn't
+ *    change what happens.
+ *    The EEPROM is kept in the file named by \c HOST_EEPROM, if that's set.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, host build of the truing stand
+ *    \li 10-18-26 Pretend EEPROM, kept in a file between runs
+ *    \li 10-18-26 HOST_SPEEDUP=0 runs the tick as fast as it can
+ *    \li 10-18-26 A microsecond clock from the PC, for timing code with
+ *    \li 10-18-26 Integer conversions moved to host_stdlib.cpp for the format check
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include <stdlib.h>                         // Standard stuff such as exit() and getenv()
+#include <stdio.h>                          // For messages to stderr
+#include <math.h>                           // For checking float classifications
+#include <string.h>                         // Functions for C string handling
+#include <fcntl.h>                          // For opening the pseudo-terminal
+#include <poll.h>                           // For checking for typed characters
+#include <unistd.h>                         // For read()
+#include <time.h>                           // For clock_gettime()
+
+#include "FreeRTOS.h"                       // Primary header for FreeRTOS
+#include "task.h"                           // Header for FreeRTOS task functions
+
+#include "emstream.h"                       // For the float conversion flags
+#include <avr/eeprom.h>                     // The pretend EEPROM's functions
+#include "host_hardware.h"                  // Header for this file
+
+
+// The registers; on the AVR these all start out as zero after a reset, except that
+// the USART data register empty flags are set
+volatile uint8_t PORTB, DDRB, PINB;
+volatile uint8_t PORTC, DDRC, PINC;
+volatile uint8_t PORTD, DDRD, PIND;
+volatile uint8_t PORTE, DDRE, PINE;
+volatile uint8_t EICRA, EICRB, EIMSK, EIFR;
+volatile uint8_t TCCR1A, TCCR1B, TCCR1C;
+volatile uint16_t TCNT1, TCNT3, TCNT5;
+volatile uint16_t OCR1A, OCR1B, OCR1C, ICR1;
+volatile uint8_t ADMUX, ADCSRB;
+volatile uint16_t ADC;
+volatile uint8_t MCUSR;
+volatile uint8_t UCSR0A = (1 << UDRE0), UCSR0B, UCSR0C, UBRR0H, UBRR0L, UDR0;
+volatile uint8_t UCSR1A = (1 << UDRE1), UCSR1B, UCSR1C, UBRR1H, UBRR1L, UDR1;
+
+host_adcsra_register ADCSRA;
+
+
+// Default (empty) ISR's for the vectors the host hardware can trigger, so that the
+// program links whether or not it has an ISR for each one. The application's own
+// ISR's replace these
+extern "C"
+{
+	void host_vector_INT4 (void) __attribute__ ((weak));
+	void host_vector_INT5 (void) __attribute__ ((weak));
+	void host_vector_INT6 (void) __attribute__ ((weak));
+	void host_vector_INT7 (void) __attribute__ ((weak));
+	void host_vector_USART0_RX (void) __attribute__ ((weak));
+	void host_vector_USART1_RX (void) __attribute__ ((weak));
+
+	void host_vector_INT4 (void) { }
+	void host_vector_INT5 (void) { }
+	void host_vector_INT6 (void) { }
+	void host_vector_INT7 (void) { }
+	void host_vector_USART0_RX (void) { }
+	void host_vector_USART1_RX (void) { }
+}
+
+/// The ISR's for external interrupts 4 through 7, which are on pins PE4 through PE7
+static void (* const int_vectors[4]) (void) =
+{
+	host_vector_INT4, host_vector_INT5, host_vector_INT6, host_vector_INT7
+};
+
+/// The functions run at every RTOS tick
+static host_tick_hook_t tick_hooks[HOST_MAX_TICK_HOOKS];
+
+/// How many functions have been hooked onto the RTOS tick
+static uint8_t num_tick_hooks = 0;
+
+/// The function which supplies A/D readings, or NULL to read mid-scale
+static host_adc_source_t adc_source = NULL;
+
+/// The file from which typed characters are read, or -1 at end of file
+static int serial_in_fd = STDIN_FILENO;
+
+/// The file to which serial output is written
+static int serial_out_fd = STDOUT_FILENO;
+
+/// The function which is shown serial output, or NULL if nobody's watching
+static host_serial_monitor_t serial_monitor = NULL;
+
+/// Characters waiting to be delivered as if they had been typed
+static char inject_buffer[HOST_INJECT_BUF_SIZE];
+
+/// Where the next injected character will be put into the buffer
+static volatile uint8_t inject_write_index = 0;
+
+/// Where the next injected character will be taken from the buffer
+static volatile uint8_t inject_read_index = 0;
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function checks for a character arriving at the serial port.
+ *  \details One character at most is taken per tick, which is about the rate at
+ *  which characters arrive at 9600 baud. If the USART's receive interrupt is enabled,
+ *  the character is put in the data register and the ISR is run, just as the USART
+ *  does. Serial port 1 is the one the truing stand uses, so it gets first pick.
+ */
+
+static void poll_serial_input (void)
+{
+	struct pollfd poller;
+	char ch;
+
+	// Injected characters come first, so a simulated person isn't held up by a real one
+	if (inject_read_index != inject_write_index)
+	{
+		ch = inject_buffer[inject_read_index];
+		inject_read_index = (inject_read_index + 1) % HOST_INJECT_BUF_SIZE;
+	}
+	else
+	{
+		if (serial_in_fd < 0)
+		{
+			return;
+		}
+
+		poller.fd = serial_in_fd;
+		poller.events = POLLIN;
+		if (poll (&poller, 1, 0) <= 0 || !(poller.revents & (POLLIN | POLLHUP)))
+		{
+			return;
+		}
+
+		if (read (serial_in_fd, &ch, 1) != 1)
+		{
+			serial_in_fd = -1;              // End of input; stop looking
+			return;
+		}
+	}
+
+	if (UCSR1B & (1 << RXCIE1))
+	{
+		UDR1 = ch;
+		host_vector_USART1_RX ();
+	}
+	else if (UCSR0B & (1 << RXCIE0))
+	{
+		UDR0 = ch;
+		host_vector_USART0_RX ();
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function is hooked onto the host port's RTOS tick.
+ *  \details It runs in interrupt context, so the ISR's it calls and the functions in
+ *  \c tick_hooks[] see the same world as ISR's on the AVR do.
+ */
+
+static void host_tick (void)
+{
+	poll_serial_input ();
+
+	for (uint8_t index = 0; index < num_tick_hooks; index++)
+	{
+		tick_hooks[index] ();
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function gets the pretend hardware ready before \c main() runs.
+ *  \details It reads the \c HOST_SERIAL and \c HOST_SPEEDUP environment variables,
+ *  sets up the serial port accordingly and hooks the hardware onto the RTOS tick.
+ *  It's run by the constructor of a static object, so there's nothing to call.
+ */
+
+static void host_hardware_setup (void)
+{
+	const char* serial_mode = getenv ("HOST_SERIAL");
+	const char* speedup = getenv ("HOST_SPEEDUP");
+
+	if (serial_mode != NULL && strcmp (serial_mode, "pty") == 0)
+	{
+		int pty_fd = posix_openpt (O_RDWR | O_NOCTTY);
+		if (pty_fd < 0 || grantpt (pty_fd) != 0 || unlockpt (pty_fd) != 0)
+		{
+			fprintf (stderr, "ERROR: Can't make a pseudo-terminal for the serial port\n");
+			exit (EXIT_FAILURE);
+		}
+		fprintf (stderr, "Serial port is on %s\n", ptsname (pty_fd));
+		serial_in_fd = pty_fd;
+		serial_out_fd = pty_fd;
+	}
+
+	if (speedup != NULL)
+	{
+		vPortSetTickSpeedup ((uint32_t)strtoul (speedup, NULL, 10));
+	}
+
+	// The AVR says why it was reset; here it's always a power-on reset
+	MCUSR = (1 << PORF);
+
+	vPortHostTickHook = host_tick;
+}
+
+
+/// This object's only job is to run host_hardware_setup() before main()
+static struct host_hardware_starter
+{
+	host_hardware_starter (void) { host_hardware_setup (); }
+} starter;
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function adds a function to the list of those run at every RTOS tick.
+ *  \details The functions are run in interrupt context, in the order in which they
+ *  were added, after any typed character has been delivered. They should be added
+ *  before the scheduler is started.
+ *  @param hook The function to be run at each tick
+ *  @return True if the function was added, false if the list was already full
+ */
+
+bool host_add_tick_hook (host_tick_hook_t hook)
+{
+	if (num_tick_hooks >= HOST_MAX_TICK_HOOKS)
+	{
+		return (false);
+	}
+	tick_hooks[num_tick_hooks++] = hook;
+	return (true);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function sets the function which supplies A/D converter readings.
+ *  @param source The function, or NULL to have every channel read mid-scale
+ */
+
+void host_set_adc_source (host_adc_source_t source)
+{
+	adc_source = source;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function does an A/D conversion.
+ *  @param channel The channel to be converted, from the MUX bits of ADMUX
+ *  @return A 10-bit reading, right justified
+ */
+
+uint16_t host_adc_convert (uint8_t channel)
+{
+	if (adc_source == NULL)
+	{
+		return (512);
+	}
+	return (adc_source (channel) & 0x03FF);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method does a conversion if one has just been started.
+ *  \details The conversion takes no time at all, so when this method returns the
+ *  result is in ADC, ADSC is clear and the interrupt flag ADIF is set.
+ */
+
+void host_adcsra_register::check_start (void)
+{
+	if ((bits & (1 << ADSC)) && (bits & (1 << ADEN)))
+	{
+		ADC = host_adc_convert (ADMUX & ((1 << MUX4) | (1 << MUX3) | (1 << MUX2)
+									   | (1 << MUX1) | (1 << MUX0)));
+		bits = (bits & ~(1 << ADSC)) | (1 << ADIF);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function sets the level of an input pin.
+ *  \details If the pin is one of PE4 through PE7 and its external interrupt is
+ *  enabled in EIMSK, the sense control bits in EICRB are checked to see whether this
+ *  change should trigger the interrupt, and if so the ISR is run. ISR's must only be
+ *  run in interrupt context, so this function should be called from a tick hook.
+ *  @param p_pin_reg A pointer to the port's input register, such as \c &PINE
+ *  @param bit The number of the pin within the port, 0 to 7
+ *  @param level True for a high level on the pin and false for a low one
+ */
+
+void host_set_input (volatile uint8_t* p_pin_reg, uint8_t bit, bool level)
+{
+	bool was_high = (*p_pin_reg & (1 << bit)) != 0;
+
+	if (level)
+	{
+		*p_pin_reg |= (1 << bit);
+	}
+	else
+	{
+		*p_pin_reg &= ~(1 << bit);
+	}
+
+	if (p_pin_reg != &PINE || bit < 4 || level == was_high || !(EIMSK & (1 << bit)))
+	{
+		return;
+	}
+
+	// The sense control bits: 00 low level, 01 any change, 10 falling, 11 rising. A
+	// low level interrupt is treated as a falling edge, as it can't be held asserted
+	uint8_t sense = (EICRB >> (2 * (bit - 4))) & 0x03;
+	if (sense == 0x01 || (sense == 0x03 && level) || (sense <= 0x02 && !level))
+	{
+		int_vectors[bit - 4] ();
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function gets the file descriptor to which serial output is written.
+ *  @return The file descriptor for standard output or the pseudo-terminal
+ */
+
+int host_serial_output (void)
+{
+	return (serial_out_fd);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function sets a function to be shown everything sent to the terminal.
+ *  \details A simulated operator uses this to read the prompts the user interface
+ *  prints. The monitor is called by the task which is printing, so it must be quick.
+ *  @param monitor The function to be called with each character, or NULL for none
+ */
+
+void host_set_serial_monitor (host_serial_monitor_t monitor)
+{
+	serial_monitor = monitor;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function passes a character sent out through the serial port to the
+ *  monitor function, if one has been set.
+ *  @param ch The character which was sent
+ */
+
+void host_serial_sent (char ch)
+{
+	if (serial_monitor != NULL)
+	{
+		serial_monitor (ch);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function queues characters to arrive at the serial port as if typed.
+ *  \details The characters are delivered one per tick, ahead of anything typed at
+ *  the terminal. This may be called from a task or from interrupt context.
+ *  @param p_text The characters to be delivered, as a C string
+ *  @return True if they all fit in the buffer, false if some had to be dropped
+ */
+
+bool host_serial_inject (const char* p_text)
+{
+	for (; *p_text; p_text++)
+	{
+		uint8_t next = (inject_write_index + 1) % HOST_INJECT_BUF_SIZE;
+		if (next == inject_read_index)
+		{
+			return (false);
+		}
+		inject_buffer[inject_write_index] = *p_text;
+		inject_write_index = next;
+	}
+	return (true);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function works out what a motor driver chip is being told to do.
+ *  \details Channel 1's VNH3SP30 has its INA, INB and EN lines on PC0 through PC2 and
+ *  its PWM on OC1B; channel 2's are on PD5 through PD7 and OC1A. Timer 1 counts up to
+ *  ICR1, so the duty cycle is the compare register over ICR1. The sign follows INA
+ *  and INB; with both high or both low the motor is braked, and with EN low it coasts.
+ *  @param channel The motor driver channel, 1 or 2
+ *  @return The duty cycle from -1.0 (full reverse) to 1.0 (full forward)
+ */
+
+float host_motor_output (uint8_t channel)
+{
+	uint8_t lines = (channel == 1) ? (PORTC & 0x07) : ((PORTD >> 5) & 0x07);
+	uint16_t compare = (channel == 1) ? OCR1B : OCR1A;
+	float duty;
+
+	if (!(lines & 0x04) || ICR1 == 0)
+	{
+		return (0.0);
+	}
+
+	duty = (compare >= ICR1) ? 1.0 : (float)compare / (float)ICR1;
+	switch (lines & 0x03)
+	{
+		case 0x01:
+			return (duty);
+		case 0x02:
+			return (-duty);
+		default:
+			return (0.0);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function gets the number of RTOS ticks since the scheduler started.
+ *  \details It can be called from tasks or from interrupt context.
+ *  @return The RTOS tick count
+ */
+
+uint32_t host_ticks (void)
+{
+	return (xTaskGetTickCountFromISR ());
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function gets the time from the PC's clock, in microseconds.
+ *  \details Code which is being timed doesn't wait, so the host build's RTOS ticks,
+ *  which are only taken once every task waits, can't time it; this clock can. It
+ *  wraps round every 71 minutes, so only differences between readings mean anything.
+ *  @return The time on a clock which doesn't jump, in microseconds
+ */
+
+uint32_t host_microseconds (void)
+{
+	struct timespec now;
+
+	clock_gettime (CLOCK_MONOTONIC, &now);
+	return ((uint32_t)now.tv_sec * 1000000UL + (uint32_t)(now.tv_nsec / 1000));
+}
+
+
+//-------------------------------------------------------------------------------------
+/** The linker marks the start and end of the section in which the \c EEMEM variables
+ *  are put together, which stands for the EEPROM.
+ */
+extern uint8_t __start_host_eeprom[];
+extern uint8_t __stop_host_eeprom[];        ///< \see __start_host_eeprom
+
+/// Set once the pretend EEPROM has been erased and loaded from its file
+static bool eeprom_loaded = false;
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function gets the pretend EEPROM ready the first time it's used.
+ *  \details It's erased to all 0xFF, as a new chip's is, then filled from the file
+ *  named by \c HOST_EEPROM if there's one to read.
+ */
+
+static void eeprom_load (void)
+{
+	const char* name = getenv ("HOST_EEPROM");
+
+	eeprom_loaded = true;
+	memset (__start_host_eeprom, 0xFF, __stop_host_eeprom - __start_host_eeprom);
+	if (name == NULL)
+	{
+		return;
+	}
+
+	FILE* p_file = fopen (name, "rb");
+	if (p_file != NULL)
+	{
+		if (fread (__start_host_eeprom, 1, __stop_host_eeprom - __start_host_eeprom,
+				   p_file) == 0)
+		{
+			memset (__start_host_eeprom, 0xFF,
+					__stop_host_eeprom - __start_host_eeprom);
+		}
+		fclose (p_file);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function reads a block from the pretend EEPROM.
+ *  @param p_dst Where to put what's read
+ *  @param p_src The address of the \c EEMEM variable to read
+ *  @param size How many bytes to read
+ */
+
+void host_eeprom_read (void* p_dst, const void* p_src, size_t size)
+{
+	if (!eeprom_loaded)
+	{
+		eeprom_load ();
+	}
+	memcpy (p_dst, p_src, size);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function writes a block to the pretend EEPROM.
+ *  \details The whole EEPROM is written to its file afterward, if it has one, so a
+ *  program stopped at any time keeps what it has stored.
+ *  @param p_src What's to be written
+ *  @param p_dst The address of the \c EEMEM variable to write
+ *  @param size How many bytes to write
+ */
+
+void host_eeprom_write (const void* p_src, void* p_dst, size_t size)
+{
+	const char* name = getenv ("HOST_EEPROM");
+
+	if (!eeprom_loaded)
+	{
+		eeprom_load ();
+	}
+	memcpy (p_dst, p_src, size);
+	if (name == NULL)
+	{
+		return;
+	}
+
+	FILE* p_file = fopen (name, "wb");
+	if (p_file == NULL)
+	{
+		perror (name);
+		return;
+	}
+	if (fwrite (__start_host_eeprom, 1, __stop_host_eeprom - __start_host_eeprom,
+				p_file) != (size_t)(__stop_host_eeprom - __start_host_eeprom))
+	{
+		perror (name);
+	}
+	fclose (p_file);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function stands in for avr-libc's float to text conversion engine.
+ *  \details The first byte put in the buffer holds the \c FTOA_ flags; it's followed
+ *  by the rounded digits of the mantissa, with no decimal point, and a '\\0'.
+ *  @param val The number to be converted
+ *  @param buf The buffer into which the flags and digits are written
+ *  @param prec The number of digits wanted after the first one
+ *  @param maxdgs The most digits to be written in all
+ *  @return The decimal exponent of the first digit
+ */
+
+extern "C" int __ftoa_engine (double val, char* buf, uint8_t prec, uint8_t maxdgs)
+{
+	char text[40];
+	char* p_text = text;
+	char* p_buf = buf + 1;
+	uint8_t num_digits = prec + 1;
+
+	*buf = 0;
+	if (isnan (val))
+	{
+		*buf = FTOA_NAN;
+		*p_buf = '\0';
+		return (0);
+	}
+	if (signbit (val))
+	{
+		*buf |= FTOA_MINUS;
+		val = -val;
+	}
+	if (isinf (val))
+	{
+		*buf |= FTOA_INF;
+		*p_buf = '\0';
+		return (0);
+	}
+	if (val == 0.0)
+	{
+		*buf |= FTOA_ZERO;
+	}
+
+	if (num_digits > maxdgs)
+	{
+		num_digits = maxdgs;
+	}
+	if (num_digits < 1)
+	{
+		num_digits = 1;
+	}
+
+	snprintf (text, sizeof (text), "%.*e", num_digits - 1, val);
+	while (*p_text && *p_text != 'e')
+	{
+		if (*p_text != '.')
+		{
+			*p_buf++ = *p_text;
+		}
+		p_text++;
+	}
+	*p_buf = '\0';
+
+	return ((*p_text == 'e') ? atoi (p_text + 1) : 0);
+}
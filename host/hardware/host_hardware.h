@@ -0,0 +1,93 @@
+//*************************************************************************************
+/** \file host_hardware.h
+ *    This file contains the interface to the pretend ATmega1281 peripherals of the
+ *    host build. The drivers in the truing stand software talk to the registers
+ *    declared in the stand-in <avr/io.h> exactly as they do on the real chip; the
+ *    functions here let a simulation (or a person at a terminal) play the part of the
+ *    outside world by changing input pins, supplying A/D readings and typing into the
+ *    serial port, and let it run code at every RTOS tick.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, host build of the truing stand
+ *    \li 10-18-26 A microsecond clock from the PC, for timing code with
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+// This define prevents this .h file from being included multiple times in a .cpp file
+#ifndef _HOST_HARDWARE_H_
+#define _HOST_HARDWARE_H_
+
+#include <stdint.h>
+#include <avr/io.h>
+
+
+/// This is the most functions which can be hooked onto the RTOS tick
+#define HOST_MAX_TICK_HOOKS		4
+
+/// This is the most characters which can be waiting to be "typed" into the serial port
+#define HOST_INJECT_BUF_SIZE	64
+
+
+/** This is the type of a function which supplies A/D converter readings. It's given
+ *  the channel number (the MUX bits of ADMUX) and returns a 10-bit reading.
+ */
+typedef uint16_t (*host_adc_source_t) (uint8_t channel);
+
+/** This is the type of a function which is called at every RTOS tick, in interrupt
+ *  context, before the kernel's own tick processing.
+ */
+typedef void (*host_tick_hook_t) (void);
+
+/** This is the type of a function which is shown every character sent out through
+ *  the serial port, in the context of the task which sent it.
+ */
+typedef void (*host_serial_monitor_t) (char);
+
+
+// Add a function to the list of those run at every RTOS tick
+bool host_add_tick_hook (host_tick_hook_t);
+
+// Set the function which supplies A/D converter readings
+void host_set_adc_source (host_adc_source_t);
+
+// Do an A/D conversion on the given channel; called by the ADCSRA stand-in
+uint16_t host_adc_convert (uint8_t);
+
+// Set the level of an input pin, running an external interrupt's ISR if appropriate
+void host_set_input (volatile uint8_t*, uint8_t, bool);
+
+// Get the file descriptor to which serial port output is written
+int host_serial_output (void);
+
+// Set a function to be shown every character sent out through the serial port
+void host_set_serial_monitor (host_serial_monitor_t);
+
+// Pass a character sent out through the serial port to the monitor, if there is one
+void host_serial_sent (char);
+
+// Queue characters to arrive at the serial port as if they had been typed
+bool host_serial_inject (const char*);
+
+// Get the PWM duty cycle of a motor channel as a signed fraction of full power
+float host_motor_output (uint8_t);
+
+// Get the number of RTOS ticks since the scheduler started, from anywhere
+uint32_t host_ticks (void);
+
+// Get the time in microseconds from the PC's clock, for timing code
+uint32_t host_microseconds (void);
+
+#endif // _HOST_HARDWARE_H_
@@ -0,0 +1,106 @@
+//*************************************************************************************
+/** \file host_stdlib.cpp
+ *    This file contains avr-libc's nonstandard integer to string conversions, which
+ *    the host's C library doesn't have. They're kept apart from the pretend hardware
+ *    so that the number format check (see \c tools/format_check.cpp) can use them
+ *    without the RTOS.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, moved out of host_hardware.cpp
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include <stdint.h>                         // For uint8_t
+#include <stdlib.h>                         // The stand-in, declaring these functions
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function converts an unsigned number to text in the given base.
+ *  \details It does the work for avr-libc's conversion functions, which the host's
+ *  C library doesn't have.
+ *  @param value The number to be converted
+ *  @param str The buffer into which the text is written
+ *  @param radix The number base, from 2 to 36
+ *  @param negative True if a minus sign should be put in front of the number
+ *  @return A pointer to the buffer
+ */
+
+static char* unsigned_to_text (unsigned long value, char* str, int radix, bool negative)
+{
+	char digits[sizeof (unsigned long) * 8 + 1];
+	uint8_t count = 0;
+	char* p_out = str;
+
+	if (radix < 2 || radix > 36)
+	{
+		*str = '\0';
+		return (str);
+	}
+
+	do
+	{
+		uint8_t digit = value % radix;
+		digits[count++] = (digit < 10) ? ('0' + digit) : ('a' + digit - 10);
+		value /= radix;
+	}
+	while (value);
+
+	if (negative)
+	{
+		*p_out++ = '-';
+	}
+	while (count)
+	{
+		*p_out++ = digits[--count];
+	}
+	*p_out = '\0';
+
+	return (str);
+}
+
+
+// avr-libc only puts a minus sign on negative numbers in base 10; in other bases a
+// negative number's bits are shown as they are
+extern "C"
+{
+	char* itoa (int value, char* str, int radix)
+	{
+		if (radix == 10 && value < 0)
+		{
+			return (unsigned_to_text (-(unsigned long)(long)value, str, radix, true));
+		}
+		return (unsigned_to_text ((unsigned int)value, str, radix, false));
+	}
+
+	char* utoa (unsigned int value, char* str, int radix)
+	{
+		return (unsigned_to_text (value, str, radix, false));
+	}
+
+	char* ltoa (long value, char* str, int radix)
+	{
+		if (radix == 10 && value < 0)
+		{
+			return (unsigned_to_text (-(unsigned long)value, str, radix, true));
+		}
+		return (unsigned_to_text ((unsigned long)value, str, radix, false));
+	}
+
+	char* ultoa (unsigned long value, char* str, int radix)
+	{
+		return (unsigned_to_text (value, str, radix, false));
+	}
+}
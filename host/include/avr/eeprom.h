@@ -0,0 +1,37 @@
+//*************************************************************************************
+/** \file host/include/avr/eeprom.h
+ *    This file stands in for avr-libc's <avr/eeprom.h> in the host build. Variables
+ *    marked \c EEMEM are put together in a section of their own, which plays the part
+ *    of the EEPROM; it starts out erased, all 0xFF, unless the environment variable
+ *    \c HOST_EEPROM names a file to load it from. Writes go to that file too, so what
+ *    the stand stores is kept from one run to the next.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, EEPROM for the pot calibration
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+//*************************************************************************************
+
+#ifndef _HOST_AVR_EEPROM_H_
+#define _HOST_AVR_EEPROM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define EEMEM						__attribute__ ((section ("host_eeprom"), used))
+
+// Read a block from the pretend EEPROM
+void host_eeprom_read (void* p_dst, const void* p_src, size_t size);
+
+// Write a block to the pretend EEPROM, and to its file if it has one
+void host_eeprom_write (const void* p_src, void* p_dst, size_t size);
+
+#define eeprom_read_block(dst, src, n)		host_eeprom_read ((dst), (src), (n))
+#define eeprom_update_block(src, dst, n)	host_eeprom_write ((src), (dst), (n))
+#define eeprom_write_block(src, dst, n)		host_eeprom_write ((src), (dst), (n))
+#define eeprom_is_ready()					(1)
+#define eeprom_busy_wait()
+
+#endif // _HOST_AVR_EEPROM_H_
@@ -0,0 +1,49 @@
+//*************************************************************************************
+/** \file host/include/avr/interrupt.h
+ *    This file stands in for avr-libc's <avr/interrupt.h> in the host build. An ISR
+ *    becomes an ordinary C function which the hardware stand-ins call from inside the
+ *    RTOS tick handler, which is the host port's interrupt context. The global
+ *    interrupt enable is the host port's tick signal mask.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, host build of the truing stand
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+//*************************************************************************************
+
+#ifndef _HOST_AVR_INTERRUPT_H_
+#define _HOST_AVR_INTERRUPT_H_
+
+#include <avr/io.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void vPortDisableInterrupts (void);
+void vPortEnableInterrupts (void);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+/// Disabling interrupts blocks the host port's tick signal
+#define cli()				vPortDisableInterrupts ()
+
+/// Enabling interrupts unblocks the tick signal, except within an interrupt
+#define sei()				vPortEnableInterrupts ()
+
+/// An interrupt service routine is a plain function with C linkage
+#ifdef __cplusplus
+	#define ISR(vector)		extern "C" void vector (void); \
+							extern "C" void vector (void)
+#else
+	#define ISR(vector)		void vector (void); \
+							void vector (void)
+#endif
+
+#endif // _HOST_AVR_INTERRUPT_H_
@@ -0,0 +1,233 @@
+//*************************************************************************************
+/** \file host/include/avr/io.h
+ *    This file stands in for avr-libc's <avr/io.h> in the host build. It declares the
+ *    ATmega1281 registers which the truing stand software and the ME405 library use
+ *    as ordinary variables, defined in \c host_hardware.cpp, so that the drivers
+ *    compile unchanged. Writing a register has no effect other than storing the
+ *    value, except where noted; the simulation reads what the drivers wrote (motor
+ *    direction bits, PWM duty cycle) and writes what they read (pin levels, the ADC).
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, host build of the truing stand
+ *    \li 10-18-26 Data register empty interrupt vectors
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+//*************************************************************************************
+
+#ifndef _HOST_AVR_IO_H_
+#define _HOST_AVR_IO_H_
+
+#include <stdint.h>
+
+
+/// The ATmega1281's SRAM runs from RAMSTART to RAMEND; the memory checks use these
+#define RAMSTART			0x200
+#define RAMEND				0x21FF
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Registers for the general purpose I/O ports
+extern volatile uint8_t PORTB, DDRB, PINB;
+extern volatile uint8_t PORTC, DDRC, PINC;
+extern volatile uint8_t PORTD, DDRD, PIND;
+extern volatile uint8_t PORTE, DDRE, PINE;
+
+// External interrupt control registers
+extern volatile uint8_t EICRA, EICRB, EIMSK, EIFR;
+
+// Timer/counter registers; timer 1 makes the motor PWM
+extern volatile uint8_t TCCR1A, TCCR1B, TCCR1C;
+extern volatile uint16_t TCNT1, TCNT3, TCNT5;
+extern volatile uint16_t OCR1A, OCR1B, OCR1C, ICR1;
+
+// A/D converter registers, except for ADCSRA which is special (see below)
+extern volatile uint8_t ADMUX, ADCSRB;
+extern volatile uint16_t ADC;
+
+// The MCU status register, which holds the cause of the last reset
+extern volatile uint8_t MCUSR;
+
+// USART registers
+extern volatile uint8_t UCSR0A, UCSR0B, UCSR0C, UBRR0H, UBRR0L, UDR0;
+extern volatile uint8_t UCSR1A, UCSR1B, UCSR1C, UBRR1H, UBRR1L, UDR1;
+
+#ifdef __cplusplus
+}
+#endif
+
+// The serial port code checks which USART's a chip has with "#if defined UCSRnA"
+#define UCSR0A				UCSR0A
+#define UCSR1A				UCSR1A
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This class stands in for the A/D converter's control and status register.
+ *  \details On the AVR, setting ADSC starts a conversion and the hardware clears ADSC
+ *  when the result is ready in ADC. Here a conversion is done the moment ADSC is set
+ *  (as long as ADEN is set too) by asking \c host_adc_convert() for the reading on
+ *  the channel selected in ADMUX, so code that waits for ADSC to clear doesn't wait.
+ *  Only C++ code uses the A/D converter, so C files just don't see this register.
+ */
+
+#ifdef __cplusplus
+class host_adcsra_register
+{
+	protected:
+		/// The bits of the register as last written, less ADSC once a conversion ends
+		volatile uint8_t bits;
+
+		// Do a conversion if one has just been started
+		void check_start (void);
+
+	public:
+		/// The register starts out as zero, as on the AVR after a reset
+		host_adcsra_register (void) : bits (0) { }
+
+		/// Reading the register just gives its bits
+		operator uint8_t (void) const { return (bits); }
+
+		/// Writing the register stores the bits and starts a conversion if ADSC is set
+		host_adcsra_register& operator = (uint8_t value)
+		{
+			bits = value;
+			check_start ();
+			return (*this);
+		}
+
+		/// Setting bits may start a conversion
+		host_adcsra_register& operator |= (uint8_t value)
+		{
+			bits |= value;
+			check_start ();
+			return (*this);
+		}
+
+		/// Clearing bits never starts anything
+		host_adcsra_register& operator &= (uint8_t value)
+		{
+			bits &= value;
+			return (*this);
+		}
+};
+
+extern host_adcsra_register ADCSRA;
+#endif // __cplusplus
+
+
+// Bits in the external interrupt registers
+#define ISC40				0
+#define ISC41				1
+#define ISC50				2
+#define ISC51				3
+#define ISC60				4
+#define ISC61				5
+#define ISC70				6
+#define ISC71				7
+#define INT4				4
+#define INT5				5
+#define INT6				6
+#define INT7				7
+
+// Port pin bits
+#define PB5					5
+#define PB6					6
+#define PE4					4
+#define PE5					5
+#define PE6					6
+#define PE7					7
+#define PORTC0				0
+#define PORTC1				1
+#define PORTC2				2
+#define PORTD5				5
+#define PORTD6				6
+#define PORTD7				7
+#define DDB5				5
+#define DDB6				6
+#define DDC0				0
+#define DDC1				1
+#define DDC2				2
+#define DDD5				5
+#define DDD6				6
+#define DDD7				7
+
+// Timer 1 control bits
+#define WGM10				0
+#define WGM11				1
+#define COM1C0				2
+#define COM1C1				3
+#define COM1B0				4
+#define COM1B1				5
+#define COM1A0				6
+#define COM1A1				7
+#define CS10				0
+#define CS11				1
+#define CS12				2
+#define WGM12				3
+#define WGM13				4
+
+// A/D converter bits
+#define MUX0				0
+#define MUX1				1
+#define MUX2				2
+#define MUX3				3
+#define MUX4				4
+#define ADLAR				5
+#define REFS0				6
+#define REFS1				7
+#define ADPS0				0
+#define ADPS1				1
+#define ADPS2				2
+#define ADIE				3
+#define ADIF				4
+#define ADATE				5
+#define ADSC				6
+#define ADEN				7
+
+// USART bits; both ports use the same bit positions
+#define RXC0				7
+#define TXC0				6
+#define UDRE0				5
+#define U2X0				1
+#define RXCIE0				7
+#define TXCIE0				6
+#define UDRIE0				5
+#define RXEN0				4
+#define TXEN0				3
+#define UCSZ01				2
+#define UCSZ00				1
+#define RXC1				7
+#define TXC1				6
+#define UDRE1				5
+#define U2X1				1
+#define RXCIE1				7
+#define TXCIE1				6
+#define UDRIE1				5
+#define RXEN1				4
+#define TXEN1				3
+#define UCSZ11				2
+#define UCSZ10				1
+
+// Reset cause bits
+#define PORF				0
+#define EXTRF				1
+#define BORF				2
+#define WDRF				3
+
+
+// Interrupt vectors are ordinary functions in the host build, named so that they
+// can't collide with anything else. The ones the software uses are listed here
+#define INT4_vect			host_vector_INT4
+#define INT5_vect			host_vector_INT5
+#define INT6_vect			host_vector_INT6
+#define INT7_vect			host_vector_INT7
+#define USART0_RX_vect		host_vector_USART0_RX
+#define USART1_RX_vect		host_vector_USART1_RX
+#define USART0_UDRE_vect	host_vector_USART0_UDRE
+#define USART1_UDRE_vect	host_vector_USART1_UDRE
+
+#endif // _HOST_AVR_IO_H_
@@ -0,0 +1,39 @@
+//*************************************************************************************
+/** \file host/include/avr/pgmspace.h
+ *    This file stands in for avr-libc's <avr/pgmspace.h> in the host build. The host
+ *    has one address space, so program memory strings are ordinary strings and the
+ *    \c _P functions are the ordinary ones.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, host build of the truing stand
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+//*************************************************************************************
+
+#ifndef _HOST_AVR_PGMSPACE_H_
+#define _HOST_AVR_PGMSPACE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s)						(s)
+#define PGM_P						const char*
+
+#define pgm_read_byte(addr)			(*(const uint8_t*)(addr))
+#define pgm_read_byte_near(addr)	(*(const uint8_t*)(addr))
+#define pgm_read_word(addr)			(*(const uint16_t*)(addr))
+#define pgm_read_word_near(addr)	(*(const uint16_t*)(addr))
+#define pgm_read_dword(addr)		(*(const uint32_t*)(addr))
+#define pgm_read_ptr(addr)			(*(void* const*)(addr))
+
+#define strlen_P					strlen
+#define strcpy_P					strcpy
+#define strncpy_P					strncpy
+#define strcmp_P					strcmp
+#define strncmp_P					strncmp
+#define memcpy_P					memcpy
+
+#endif // _HOST_AVR_PGMSPACE_H_
@@ -0,0 +1,30 @@
+//*************************************************************************************
+/** \file host/include/avr/wdt.h
+ *    This file stands in for avr-libc's <avr/wdt.h> in the host build. There's no
+ *    watchdog on the host; a hung task just shows up as a hung simulation.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, host build of the truing stand
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+//*************************************************************************************
+
+#ifndef _HOST_AVR_WDT_H_
+#define _HOST_AVR_WDT_H_
+
+#define WDTO_15MS			0
+#define WDTO_30MS			1
+#define WDTO_60MS			2
+#define WDTO_120MS			3
+#define WDTO_250MS			4
+#define WDTO_500MS			5
+#define WDTO_1S				6
+#define WDTO_2S				7
+
+#define wdt_enable(timeout)	((void)(timeout))
+#define wdt_disable()
+#define wdt_reset()
+
+#endif // _HOST_AVR_WDT_H_
@@ -0,0 +1,34 @@
+//*************************************************************************************
+/** \file host/include/stdlib.h
+ *    This file adds avr-libc's nonstandard integer to string conversions to the host
+ *    C library's <stdlib.h>, which doesn't have them. They're implemented in
+ *    \c host_stdlib.cpp.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, host build of the truing stand
+ *    \li 10-18-26 The conversions live in host_stdlib.cpp
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+//*************************************************************************************
+
+#include_next <stdlib.h>
+
+#ifndef _HOST_STDLIB_H_
+#define _HOST_STDLIB_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+char* itoa (int value, char* str, int radix);
+char* utoa (unsigned int value, char* str, int radix);
+char* ltoa (long value, char* str, int radix);
+char* ultoa (unsigned long value, char* str, int radix);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _HOST_STDLIB_H_
@@ -0,0 +1,43 @@
+//*************************************************************************************
+/** \file host/include/util/crc16.h
+ *    This file stands in for avr-libc's <util/crc16.h> in the host build. The CRC
+ *    functions are written out in C from the descriptions in the avr-libc manual, so
+ *    they give exactly the same results as the AVR's assembly versions.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, host build of the truing stand
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+//*************************************************************************************
+
+#ifndef _HOST_UTIL_CRC16_H_
+#define _HOST_UTIL_CRC16_H_
+
+#include <stdint.h>
+
+/// The CRC-16 with polynomial 0xA001 (reflected 0x8005), as used by Modbus
+static inline uint16_t _crc16_update (uint16_t crc, uint8_t a)
+{
+	crc ^= a;
+	for (uint8_t i = 0; i < 8; ++i)
+	{
+		if (crc & 1)
+			crc = (crc >> 1) ^ 0xA001;
+		else
+			crc = (crc >> 1);
+	}
+	return (crc);
+}
+
+/// The CRC-CCITT with polynomial 0x8408 (reflected 0x1021), as used by XMODEM-1K
+static inline uint16_t _crc_ccitt_update (uint16_t crc, uint8_t data)
+{
+	data ^= (uint8_t)(crc & 0xFF);
+	data ^= (uint8_t)(data << 4);
+	return ((((uint16_t)data << 8) | (crc >> 8)) ^ (uint8_t)(data >> 4)
+			^ ((uint16_t)data << 3));
+}
+
+#endif // _HOST_UTIL_CRC16_H_
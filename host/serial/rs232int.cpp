@@ -0,0 +1,230 @@
+//*************************************************************************************
+/** \file host/serial/rs232int.cpp
+ *    This file contains the host build's version of the interrupt driven serial port
+ *    class in \c lib/serial/rs232int.cpp. Characters typed at the terminal (or into the
+ *    pseudo-terminal) are delivered by the pretend USART's receive interrupt into the
+ *    same ring buffers the AVR version uses, so \c check_for_char() and \c getchar()
+ *    behave the same way. Characters sent are written straight to the terminal, so
+ *    the transmitter buffer is never full and never needs flushing.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, host build of the truing stand
+ *    \li 10-18-26 Transmitter buffer methods to match the AVR version
+ *    \li 10-18-26 Call the POSIX write() by its full name, as emstream has one too
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>                         // For write()
+#include <avr/io.h>
+#include "rs232int.h"
+#include "host_hardware.h"                  // Pretend hardware for the host build
+
+
+/// This buffer holds characters received through serial port 0 by the ISR.
+uint8_t rcv0_buffer[RSINT_BUF_SIZE];
+
+/// This index is used to write into serial character receiver buffer 0.
+volatile uint16_t rcv0_read_index;
+
+/// This index is used to read from serial character receiver buffer 0.
+volatile uint16_t rcv0_write_index;
+
+/// This buffer holds characters received through serial port 1 by the ISR.
+uint8_t rcv1_buffer[RSINT_BUF_SIZE];
+
+/// This index is used to write into serial character receiver buffer 1.
+volatile uint16_t rcv1_read_index;
+
+/// This index is used to read from serial character receiver buffer 1.
+volatile uint16_t rcv1_write_index;
+
+
+//-------------------------------------------------------------------------------------
+/** This constructor sets up a serial port. The baud rate doesn't matter on the host;
+ *  both ports write to the terminal, and characters typed at the terminal go to
+ *  whichever port has its receive interrupt enabled (port 1 if both do).
+ *  @param baud_rate The desired baud rate for serial communications, ignored here
+ *  @param port_number The number of the serial port, 0 or 1
+ */
+
+rs232::rs232 (uint16_t baud_rate, uint8_t port_number)
+	: emstream (), base232 (host_serial_output ())
+{
+	(void)baud_rate;
+
+	port_num = port_number;
+
+	if (port_number == 0)
+	{
+		UCSR0B |= (1 << RXEN0) | (1 << TXEN0) | (1 << RXCIE0);
+		rcv0_read_index = 0;
+		rcv0_write_index = 0;
+	}
+	else
+	{
+		UCSR1B |= (1 << RXEN1) | (1 << TXEN1) | (1 << RXCIE1);
+		rcv1_read_index = 0;
+		rcv1_write_index = 0;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method sends one character to the terminal, letting the serial monitor (if
+ *  there is one) see it first.
+ *  @param chout The character to be sent out
+ *  @return True if the character was written and false if it couldn't be
+ */
+
+bool rs232::putchar (char chout)
+{
+	host_serial_sent (chout);
+	return (::write (serial_file, &chout, 1) == 1);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method sends one character without waiting, which on the host is the same as
+ *  sending it with \c putchar().
+ *  @param chout The character to be sent out
+ *  @return True if the character was written and false if it couldn't be
+ */
+
+bool rs232::try_putchar (char chout)
+{
+	return (putchar (chout));
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method finds how many more characters will fit in the transmitter buffer,
+ *  which on the host is always all of it.
+ *  @return The number of characters which can be sent without waiting
+ */
+
+uint16_t rs232::tx_space (void)
+{
+	return (RSINT_TX_BUF_SIZE - 1);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method checks if a character can be sent without waiting; on the host it can.
+ *  @return True, always
+ */
+
+bool rs232::ready_to_send (void)
+{
+	return (true);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method would wait until everything in the transmitter buffer has been sent,
+ *  but characters are written to the terminal as soon as they're sent on the host.
+ */
+
+void rs232::transmit_now (void)
+{
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method gets one character from the serial port, waiting until there is one.
+ *  @return The character which was found in the serial port receive buffer
+ */
+
+int16_t rs232::getchar (void)
+{
+	uint8_t recv_char;
+
+	if (port_num == 0)
+	{
+		while (rcv0_read_index == rcv0_write_index);
+		recv_char = rcv0_buffer[rcv0_read_index];
+		if (++rcv0_read_index >= RSINT_BUF_SIZE)
+			rcv0_read_index = 0;
+	}
+	else
+	{
+		while (rcv1_read_index == rcv1_write_index);
+		recv_char = rcv1_buffer[rcv1_read_index];
+		if (++rcv1_read_index >= RSINT_BUF_SIZE)
+			rcv1_read_index = 0;
+	}
+
+	return (recv_char);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method checks if there is a character in the serial port's receiver queue.
+ *  @return True for character available, false for no character available
+ */
+
+bool rs232::check_for_char (void)
+{
+	if (port_num == 0)
+		return (rcv0_read_index != rcv0_write_index);
+	else
+		return (rcv1_read_index != rcv1_write_index);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method sends the ASCII code to clear a display screen.
+ */
+
+void rs232::clear_screen (void)
+{
+	putchar (CLRSCR_STYLE);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \cond NOT_ENABLED  (These ISR's are not to be documented by Doxygen)
+ *  These interrupt service routines run when the pretend USART has received a
+ *  character. They save the character in the receiver buffer, dropping the oldest
+ *  character if the buffer is full, just as the AVR versions do.
+ */
+
+ISR (RSI_CHAR_RECV_INT_0)
+{
+	rcv0_buffer[rcv0_write_index] = UDR0;
+
+	if (++rcv0_write_index >= RSINT_BUF_SIZE)
+		rcv0_write_index = 0;
+
+	if (rcv0_write_index == rcv0_read_index)
+		if (++rcv0_read_index >= RSINT_BUF_SIZE)
+			rcv0_read_index = 0;
+}
+
+
+ISR (RSI_CHAR_RECV_INT_1)
+{
+	rcv1_buffer[rcv1_write_index] = UDR1;
+
+	if (++rcv1_write_index >= RSINT_BUF_SIZE)
+		rcv1_write_index = 0;
+
+	if (rcv1_write_index == rcv1_read_index)
+		if (++rcv1_read_index >= RSINT_BUF_SIZE)
+			rcv1_read_index = 0;
+}
+/** \endcond  (End of section which is not to be documented by Doxygen) */
@@ -0,0 +1,171 @@
+//*************************************************************************************
+/** \file sim_operator.cpp
+ *    This file contains a simulated person standing at the truing stand. See
+ *    \c sim_operator.h for what the person does.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, host build of the truing stand
+ *    \li 10-18-26 The operator can answer with the acknowledge button instead of 'n'
+ *    \li 10-18-26 The operator turns the spoke as many quarter turns as asked
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include <avr/io.h>
+#include "host_hardware.h"                  // Pretend hardware for the host build
+#include "sim_operator.h"
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This constructor sets up an operator who works on the given wheel.
+ *  @param a_wheel The wheel whose spokes the operator turns
+ *  @param a_style How the operator decides which way to turn a spoke
+ *  @param a_reaction_ticks How many RTOS ticks it takes to turn a spoke and press 'n'
+ */
+
+sim_operator::sim_operator (wheel_sim* a_wheel, sim_operator_style a_style,
+							uint32_t a_reaction_ticks)
+{
+	p_wheel = a_wheel;
+	style = a_style;
+	reaction_ticks = a_reaction_ticks;
+	line_length = 0;
+	asked_direction = 0;
+	asked_turns = 1;
+	prompt_waiting = false;
+	answer_tick = 0;
+	prompts = 0;
+	use_button = false;
+	release_tick = 0;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method looks at one character printed by the user interface.
+ *  \details Characters are saved until the end of a line, then the line is read.
+ *  Anything past the end of the line buffer is ignored.
+ *  @param ch The character which was printed
+ */
+
+void sim_operator::see (char ch)
+{
+	if (ch == '\n' || ch == '\r')
+	{
+		line[line_length] = '\0';
+		read_line ();
+		line_length = 0;
+	}
+	else if (line_length < SIM_LINE_SIZE - 1)
+	{
+		line[line_length++] = ch;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method acts on one complete line of user interface output.
+ *  \details A line saying which way and how far to turn a spoke is remembered, and
+ *  the following
+ *  one asking for 'n' sets the operator to work, unless a person at the terminal is
+ *  doing the job instead.
+ */
+
+void sim_operator::read_line (void)
+{
+	int turns;
+
+	if (sscanf (line, "Tighten the spoke %d quarter turns", &turns) == 1)
+	{
+		asked_direction = 1;
+		asked_turns = (int8_t)turns;
+	}
+	else if (sscanf (line, "Loosen the spoke %d quarter turns", &turns) == 1)
+	{
+		asked_direction = -1;
+		asked_turns = (int8_t)turns;
+	}
+	else if (strcmp (line, "Press n to continue") == 0)
+	{
+		prompts++;
+		if (style != SIM_OPERATOR_NONE)
+		{
+			prompt_waiting = true;
+		}
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method carries on with turning a spoke, if one's being turned.
+ *  \details When a prompt first turns up, the operator starts on it; after the
+ *  reaction time the spoke nearest the sensors has been turned as many quarter turns
+ *  as asked and 'n' is pressed. A mechanic ignores the direction in the prompt and
+ *  turns the spoke whichever way brings the rim back toward the middle. An operator with the button
+ *  presses it briefly instead of typing 'n'.
+ *  @param now The number of RTOS ticks since the scheduler started
+ */
+
+void sim_operator::tick (uint32_t now)
+{
+	if (release_tick != 0 && now >= release_tick)
+	{
+		host_set_input (&PINE, PE7, true);
+		release_tick = 0;
+	}
+
+	if (!prompt_waiting)
+	{
+		return;
+	}
+
+	if (answer_tick == 0)
+	{
+		answer_tick = now + reaction_ticks;
+		return;
+	}
+
+	if (now < answer_tick)
+	{
+		return;
+	}
+
+	if (p_wheel != NULL)
+	{
+		uint8_t spoke = p_wheel->nearest_spoke ();
+		int8_t direction = asked_direction;
+		if (style == SIM_OPERATOR_MECHANIC)
+		{
+			// Tightening pulls the rim toward the spoke's flange, so if the rim is
+			// already off to that side, this spoke needs loosening
+			direction = (p_wheel->lateral (p_wheel->get_angle ())
+						 * p_wheel->side (spoke) > 0.0) ? -1 : 1;
+		}
+		p_wheel->turn_spoke (spoke, direction * asked_turns);
+	}
+
+	answer_tick = 0;
+	prompt_waiting = false;
+	if (use_button)
+	{
+		host_set_input (&PINE, PE7, false);
+		release_tick = now + SIM_PRESS_TICKS;
+	}
+	else
+	{
+		host_serial_inject ("n");
+	}
+}
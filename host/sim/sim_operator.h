@@ -0,0 +1,123 @@
+//*************************************************************************************
+/** \file sim_operator.h
+ *    This file contains the interface to a simulated person standing at the truing
+ *    stand. The person reads what the user interface prints, and when asked to
+ *    tighten or loosen a spoke, turns the spoke nearest the sensors and then presses
+ *    'n' to carry on, just as a person at the terminal would.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, host build of the truing stand
+ *    \li 10-18-26 The operator can answer with the acknowledge button instead of 'n'
+ *    \li 10-18-26 The operator turns the spoke as many quarter turns as asked
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+// This define prevents this .h file from being included multiple times in a .cpp file
+#ifndef _SIM_OPERATOR_H_
+#define _SIM_OPERATOR_H_
+
+#include <stdint.h>
+#include "wheel_sim.h"
+
+
+/// The longest line of user interface output the operator pays attention to
+#define SIM_LINE_SIZE			80
+
+/// How many RTOS ticks the operator holds the acknowledge button down for
+#define SIM_PRESS_TICKS			120
+
+
+/** This enumeration lists the ways the simulated operator can behave.
+ */
+enum sim_operator_style
+{
+	SIM_OPERATOR_NONE,          ///< Does nothing; a person at the terminal takes over
+	SIM_OPERATOR_LITERAL,       ///< Does exactly what the prompt says
+	SIM_OPERATOR_MECHANIC       ///< Looks at the rim and turns whichever way trues it
+};
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This class simulates the person who turns the spokes.
+ *  \details The user interface's output is passed to \c see() a character at a time
+ *  by the task which prints it, and \c tick() is run at every RTOS tick in interrupt
+ *  context. The two only share the volatile request to answer a prompt, which
+ *  \c see() sets with a single write once the direction has been saved. If there's
+ *  no wheel, as when a capture is being played back, the operator just presses 'n'.
+ */
+
+class sim_operator
+{
+	protected:
+		/// The wheel whose spokes get turned
+		wheel_sim* p_wheel;
+
+		/// How this operator behaves
+		sim_operator_style style;
+
+		/// How many RTOS ticks it takes to turn a spoke and press 'n'
+		uint32_t reaction_ticks;
+
+		/// The line of user interface output being read
+		char line[SIM_LINE_SIZE];
+
+		/// How many characters are in the line so far
+		uint8_t line_length;
+
+		/// Which way the last prompt said to turn: +1 to tighten, -1 to loosen
+		int8_t asked_direction;
+
+		/// How many quarter turns the last prompt asked for
+		int8_t asked_turns;
+
+		/// Set when a prompt to press 'n' is waiting to be answered
+		volatile bool prompt_waiting;
+
+		/// The tick at which the operator will have finished with the spoke, or zero
+		uint32_t answer_tick;
+
+		/// How many times the operator has been asked to turn a spoke
+		uint16_t prompts;
+
+		/// True if the operator answers with the acknowledge button, not the keyboard
+		bool use_button;
+
+		/// The tick at which the operator lets go of the button, or zero if it's up
+		uint32_t release_tick;
+
+		// Act on one complete line of user interface output
+		void read_line (void);
+
+	public:
+		// The constructor sets up an operator who works on the given wheel
+		sim_operator (wheel_sim* a_wheel, sim_operator_style a_style,
+					  uint32_t a_reaction_ticks);
+
+		// Look at one character printed by the user interface
+		void see (char ch);
+
+		// Carry on with turning a spoke, if one's being turned
+		void tick (uint32_t now);
+
+		/** Have the operator answer prompts with the acknowledge button on PE7
+		 *  rather than by typing 'n'. */
+		void answer_with_button (void) { use_button = true; }
+
+		/// Get the number of times the operator has been asked to turn a spoke
+		uint16_t get_prompts (void) { return (prompts); }
+};
+
+#endif // _SIM_OPERATOR_H_
@@ -0,0 +1,243 @@
+//*************************************************************************************
+/** \file sim_replay.cpp
+ *    This file contains the replayer of captured sensor events. See \c sim_replay.h
+ *    for what it does and \c event_log.h for the format of the capture.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, capture of sensor events for replay
+ *    \li 10-18-26 Captures hold both edges of the spoke sensor
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <avr/io.h>
+#include "host_hardware.h"                  // Pretend hardware for the host build
+#include "event_log.h"                      // The format of the capture
+#include "sim_replay.h"
+
+
+/// The longest line of a terminal log which is looked at
+#define REPLAY_LINE_SIZE		256
+
+/// What an A/D reading is before the capture has given one
+#define REPLAY_NO_READING		512
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This constructor reads a capture from a terminal log file.
+ *  \details Every line with "@E" in it is taken to be a line of records; whatever is
+ *  before the "@E" is ignored, as other tasks' printouts sometimes get there first.
+ *  A line whose checksum is wrong is skipped. Lines are numbered on the stand, so
+ *  any which went missing on the way are counted. If the file can't be read, the
+ *  program stops with a message saying why.
+ *  @param file_name The name of the terminal log file
+ */
+
+sim_replay::sim_replay (const char* file_name)
+{
+	char line[REPLAY_LINE_SIZE];
+	uint16_t records[EVENT_LOG_LINE_WORDS + 1];
+	uint32_t tick = 0;
+	int expected_line = -1;
+
+	next_edge = 0;
+	next_reading = 0;
+	bad_lines = 0;
+	missing_lines = 0;
+	lost_records = 0;
+
+	FILE* p_file = fopen (file_name, "r");
+	if (p_file == NULL)
+	{
+		perror (file_name);
+		exit (EXIT_FAILURE);
+	}
+
+	while (fgets (line, sizeof (line), p_file) != NULL)
+	{
+		char* p_char = strstr (line, "@E ");
+		if (p_char == NULL)
+		{
+			continue;
+		}
+
+		// Read the line number, then up to one more number than there are records on
+		// a line, since the last number on the line is the checksum
+		char* p_end;
+		unsigned long line_number = strtoul (p_char + 3, &p_end, 16);
+		uint8_t count = 0;
+		uint8_t checksum = (uint8_t)line_number;
+		bool bad = (p_end == p_char + 3);
+
+		for (p_char = p_end; !bad && count <= EVENT_LOG_LINE_WORDS; count++)
+		{
+			unsigned long number = strtoul (p_char, &p_end, 16);
+			if (p_end == p_char)
+			{
+				break;
+			}
+			records[count] = (uint16_t)number;
+			p_char = p_end;
+		}
+
+		// The checksum covers the line number and the records but not itself
+		if (!bad && count >= 2)
+		{
+			count--;
+			for (uint8_t index = 0; index < count; index++)
+			{
+				checksum += (uint8_t)(records[index] >> 8) + (uint8_t)records[index];
+			}
+			bad = (checksum != records[count]);
+		}
+		else
+		{
+			bad = true;
+		}
+
+		if (bad)
+		{
+			bad_lines++;
+			continue;
+		}
+
+		if (expected_line >= 0)
+		{
+			missing_lines += (uint8_t)(line_number - expected_line);
+		}
+		expected_line = (line_number + 1) & 0xFF;
+
+		add_records (records, count, tick);
+	}
+
+	fclose (p_file);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method works out the times of a line's worth of records and saves them.
+ *  @param p_records A pointer to the records
+ *  @param count How many records there are
+ *  @param tick The time of the last record before these, which is moved on to the
+ *              time of the last of these
+ */
+
+void sim_replay::add_records (const uint16_t* p_records, uint8_t count, uint32_t& tick)
+{
+	for (uint8_t index = 0; index < count; index++)
+	{
+		uint16_t record = p_records[index];
+		event new_event;
+
+		switch (record >> EVENT_TYPE_SHIFT)
+		{
+			case EVENT_TIME:
+				tick += record & EVENT_COUNT_MAX;
+				break;
+
+			case EVENT_INT4:
+			case EVENT_INT5:
+			case EVENT_INT6:
+				tick += record & EVENT_EDGE_MAX_DT;
+				new_event.tick = tick;
+				new_event.record = record;
+				edges.push_back (new_event);
+				break;
+
+			case EVENT_ADC:
+				new_event.tick = tick;
+				new_event.record = record;
+				readings.push_back (new_event);
+				break;
+
+			case EVENT_LOST:
+				lost_records += record & EVENT_COUNT_MAX;
+				break;
+
+			default:
+				break;
+		}
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method makes all the edges which have come due.
+ *  \details Captures made while the spoke sensor's ISR only ran on rising edges hold
+ *  only those; if a pin is already at the level an edge goes to, it's first set the
+ *  other way so that the edge really happens. It must be called in interrupt context.
+ *  @param now The number of RTOS ticks since the scheduler started
+ */
+
+void sim_replay::step (uint32_t now)
+{
+	while (next_edge < edges.size () && edges[next_edge].tick <= now)
+	{
+		uint16_t record = edges[next_edge].record;
+		uint8_t bit = PE4 + (record >> EVENT_TYPE_SHIFT) - EVENT_INT4;
+		bool level = record & (1 << EVENT_LEVEL_BIT);
+
+		if (((PINE & (1 << bit)) != 0) == level)
+		{
+			host_set_input (&PINE, bit, !level);
+		}
+		host_set_input (&PINE, bit, level);
+
+		next_edge++;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method hands out the next captured A/D reading on a channel.
+ *  \details Readings on other channels are skipped over. Once the capture's readings
+ *  have run out, the last one is given again.
+ *  @param channel The A/D channel being read
+ *  @return The reading, or \c REPLAY_NO_READING if the capture has none
+ */
+
+uint16_t sim_replay::adc (uint8_t channel)
+{
+	while (next_reading < readings.size ())
+	{
+		uint16_t record = readings[next_reading++].record;
+		if (((record >> 10) & 0x07) == channel)
+		{
+			return (record & 0x03FF);
+		}
+	}
+
+	return (readings.empty () ? REPLAY_NO_READING : readings.back ().record & 0x03FF);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method gets the time of the last event in the capture.
+ *  @return The time, in RTOS ticks since the scheduler started
+ */
+
+uint32_t sim_replay::get_end_tick (void)
+{
+	uint32_t end = edges.empty () ? 0 : edges.back ().tick;
+
+	if (!readings.empty () && readings.back ().tick > end)
+	{
+		end = readings.back ().tick;
+	}
+	return (end);
+}
@@ -0,0 +1,110 @@
+//*************************************************************************************
+/** \file sim_replay.h
+ *    This file contains the interface to the replayer of captured sensor events. A
+ *    stand built with \c -DEVENT_CAPTURE streams every spoke sensor and encoder edge
+ *    and every potentiometer reading out of its serial port (see \c event_log.h); a
+ *    terminal log of that session can be played back through the host build, so the
+ *    spoke counter, wheel encoder and mastermind code see exactly what they saw on the
+ *    stand, at the same times, as often as is needed to work on them.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, capture of sensor events for replay
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+// This define prevents this .h file from being included multiple times in a .cpp file
+#ifndef _SIM_REPLAY_H_
+#define _SIM_REPLAY_H_
+
+#include <stdint.h>
+#include <vector>
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This class plays back a captured stream of sensor events.
+ *  \details The whole capture is read into memory when the object is made. Then at
+ *  each RTOS tick, \c step() makes every edge whose time has come. Times are RTOS
+ *  ticks since the scheduler started, on the stand and here alike. The A/D readings
+ *  are handed out by \c adc() in the order they were taken rather than by time, as
+ *  the tasks here don't run at exactly the same moments as they did on the stand,
+ *  and a reading taken a tick early would belong to the previous spoke.
+ */
+
+class sim_replay
+{
+	protected:
+		/** This structure holds one event from the capture, with its time worked out.
+		 */
+		struct event
+		{
+			uint32_t tick;                  ///< When the event happened
+			uint16_t record;                ///< The record from the capture
+		};
+
+		/// All the edge events, in order
+		std::vector<event> edges;
+
+		/// All the A/D readings, in order
+		std::vector<event> readings;
+
+		/// The next edge to be made
+		size_t next_edge;
+
+		/// The next A/D reading to be handed out
+		size_t next_reading;
+
+		/// The number of lines of the capture which were damaged and skipped
+		uint16_t bad_lines;
+
+		/// The number of lines of the capture which were missing
+		uint16_t missing_lines;
+
+		/// The number of records the stand said it had to throw away
+		uint32_t lost_records;
+
+		// Work out the times of a line's worth of records and save them
+		void add_records (const uint16_t* p_records, uint8_t count, uint32_t& tick);
+
+	public:
+		// The constructor reads a capture from a terminal log file
+		sim_replay (const char* file_name);
+
+		// Make all the edges which have come due
+		void step (uint32_t now);
+
+		// Get the latest A/D reading on a channel
+		uint16_t adc (uint8_t channel);
+
+		/// Find out if every edge has been made
+		bool done (void) { return (next_edge >= edges.size ()); }
+
+		// Get the time of the last event in the capture
+		uint32_t get_end_tick (void);
+
+		/// Get the number of edges in the capture
+		size_t get_num_edges (void) { return (edges.size ()); }
+
+		/// Get the number of damaged lines which were skipped
+		uint16_t get_bad_lines (void) { return (bad_lines); }
+
+		/// Get the number of lines which were missing from the capture
+		uint16_t get_missing_lines (void) { return (missing_lines); }
+
+		/// Get the number of records the stand had to throw away
+		uint32_t get_lost_records (void) { return (lost_records); }
+};
+
+#endif // _SIM_REPLAY_H_
@@ -0,0 +1,558 @@
+//*************************************************************************************
+/** \file sim_session.cpp
+ *    This file connects the simulated wheel and operator to the pretend hardware of
+ *    the host build and keeps score of a truing session. The truing stand software
+ *    isn't changed at all; the wheel is moved by the motor driver's registers and is
+ *    seen through the spoke sensor, encoder and potentiometer, and the operator reads
+ *    and types into the serial port.
+ *
+ *    These environment variables control the simulation:
+ *    \li \c SIM_SEED     Number from which the wheel's faults are made up (default 1)
+ *    \li \c SIM_SPOKES   How many spokes the wheel has (default \c DEFAULT_SPOKES). If
+ *                        it isn't the number the stand starts with, the operator
+ *                        types <tt>spokes</tt> with it as the first session starts
+ *    \li \c SIM_OPERATOR \c literal (the default), \c mechanic or \c none; see
+ *                        \c sim_operator.h
+ *    \li \c SIM_REACTION Seconds the operator takes to turn a spoke (default 2)
+ *    \li \c SIM_TIME_LIMIT Simulated seconds after which a session is given up as
+ *                        unfinished (default 3600; 0 for no limit)
+ *    \li \c SIM_BATCH    Run this many wheels, one after the other, each with the
+ *                        next seed, and print a table of results (default 0, which
+ *                        runs one wheel with its output on the terminal)
+ *    \li \c SIM_VERBOSE  If set, batch runs print the user interface's output too
+ *    \li \c SIM_BUTTON   If set, the operator answers prompts by pressing the
+ *                        acknowledge button rather than typing 'n'
+ *    \li \c SIM_RADIAL   If set, radial truing is switched on before the session
+ *                        starts, as if the user had typed <tt>radial on</tt>
+ *    \li \c SIM_TENSION  If set, tension mapping is switched on in the same way
+ *    \li \c SIM_VALVE    If set, the spoke sensor sees the valve hole once a turn
+ *    \li \c SIM_GLITCHES How many false edges the spoke sensor sees, on average, per
+ *                        spoke the wheel turns by (default 0)
+ *    \li \c SIM_WHEEL    The number the wheel is given before the first session, as
+ *                        with the <tt>wheel</tt> command, so it's homed and
+ *                        remembered (default 0, not named)
+ *    \li \c SIM_RETURN   If set, the wheel comes back for a second session: once
+ *                        it's been trued, this many spokes are knocked out of true,
+ *                        it's put back on turned round by a random number of spokes,
+ *                        and the next session is started. Only the second session is
+ *                        scored
+ *    \li \c SIM_REPLAY   The name of a terminal log holding a capture from a stand
+ *                        built with \c -DEVENT_CAPTURE; the capture's sensor events are
+ *                        played back instead of simulating a wheel (see
+ *                        \c sim_replay.h), and the session ends a few seconds after
+ *                        the last of them
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, host build of the truing stand
+ *    \li 10-18-26 The operator doesn't look at binary telemetry records
+ *    \li 10-18-26 The acknowledge button is let go at the start; SIM_BUTTON uses it
+ *    \li 10-18-26 The second pot reads the rim's radial position; SIM_RADIAL
+ *    \li 10-18-26 A tensiometer reads the spokes' tensions; SIM_TENSION
+ *    \li 10-18-26 The spoke sensor can see a valve hole and glitches; SIM_VALVE and
+ *        SIM_GLITCHES; the spoke counter's filtering is reported
+ *    \li 10-18-26 The wheel can be named and can come back; SIM_WHEEL and SIM_RETURN
+ *    \li 10-18-26 The wheel can have any number of spokes the stand can; SIM_SPOKES
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>                          // For open()
+#include <unistd.h>                         // For fork(), pipe(), dup2() and _exit()
+#include <time.h>                           // For clock_gettime()
+#include <sys/wait.h>                       // For waitpid()
+#include "host_hardware.h"                  // Pretend hardware for the host build
+#include "shares.h"                         // The truing stand's shared variables
+#include "telemetry_frame.h"                // To tell telemetry records from text
+#include "wheel_sim.h"
+#include "sim_operator.h"
+#include "sim_replay.h"
+
+
+/// How long a replay carries on after the capture's last event, in RTOS ticks
+#define SIM_REPLAY_TAIL			5000
+
+
+/** This structure holds the results of one truing session. A batch run's child
+ *  process sends it to the parent through a pipe.
+ */
+struct sim_result
+{
+	uint32_t seed;                          ///< The seed from which the wheel was made
+	bool finished;                          ///< True if the software said it was done
+	uint32_t sim_ticks;                     ///< How long the session took, in ticks
+	uint16_t moves;                         ///< How many times desired_spoke changed
+	uint16_t prompts;                       ///< How often the operator turned a spoke
+	double spokes_travelled;                ///< How far the wheel turned, in spokes
+	double runout_before;                   ///< Runout of the wheel at the start, mm
+	double runout_after;                    ///< Runout of the wheel at the end, mm
+	double hop_before;                      ///< Radial runout at the start, mm
+	double hop_after;                       ///< Radial runout at the end, mm
+	double spread_before;                   ///< Tension spread at the start, turns
+	double spread_after;                    ///< Tension spread at the end, turns
+};
+
+
+/// The simulated wheel, or NULL when a capture is being played back
+static wheel_sim* p_wheel = NULL;
+
+/// The capture being played back, or NULL when a wheel is being simulated
+static sim_replay* p_replay = NULL;
+
+/// The simulated person at the stand
+static sim_operator* p_operator = NULL;
+
+/// The results of the session, filled in as it goes
+static sim_result result;
+
+/// The tick at which an unfinished session is given up, or zero for no limit
+static uint32_t time_limit_ticks = 0;
+
+/// The pipe to a batch run's parent process, or -1 when this isn't a batch run
+static int result_pipe = -1;
+
+/// The value of desired_spoke at the last tick, used to count moves
+static int8_t last_desired_spoke = 0;
+
+/// The wheel's angle at the last tick, used to work out how far it has turned
+static double last_angle = 0.0;
+
+/// How many spokes are knocked out of true before the wheel comes back, or zero if
+/// it doesn't come back
+static uint8_t return_knocks = 0;
+
+/// True from the end of the first session until the one the wheel comes back for
+/// has started
+static bool returning = false;
+
+/// The tick at which the session being scored started
+static uint32_t start_tick = 0;
+
+/// How many prompts the operator had been given before the session being scored
+static uint16_t prompts_before = 0;
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function supplies the A/D converter's readings.
+ *  @param channel The A/D channel being read
+ *  @return The rim potentiometers' readings on their channels and zero on the others
+ */
+
+static uint16_t sim_adc (uint8_t channel)
+{
+	if (p_replay != NULL)
+	{
+		return (p_replay->adc (channel));
+	}
+	if (channel == SIM_POT_CHANNEL)
+	{
+		return (p_wheel->pot_reading ());
+	}
+	if (channel == SIM_HOP_CHANNEL)
+	{
+		return (p_wheel->hop_reading ());
+	}
+	return ((channel == SIM_TENSION_CHANNEL) ? p_wheel->tension_reading () : 0);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function shows the simulated operator what the software printed.
+ *  \details Binary telemetry records are skipped, as a person at a terminal would
+ *  skip the rubbish they make on the screen. A record starts and ends with a
+ *  delimiter and is never empty, so two delimiters in a row are the end of one
+ *  record and the start of the next.
+ *  @param ch The character which was printed
+ */
+
+static void sim_monitor (char ch)
+{
+	static bool in_record = false;
+	static bool record_empty = true;
+
+	if (ch == TELEM_DELIMITER)
+	{
+		in_record = !in_record || record_empty;
+		record_empty = true;
+	}
+	else if (in_record)
+	{
+		record_empty = false;
+	}
+	else
+	{
+		p_operator->see (ch);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function ends the session and reports how it went.
+ *  \details A batch run's child sends its results to the parent; a single run prints
+ *  them on \c stderr, out of the way of the user interface's output. The program then
+ *  stops at once, without running static destructors, as the RTOS's threads are still
+ *  around. It's called in interrupt context.
+ */
+
+static void sim_finish (void)
+{
+	char text[320];
+
+	result.sim_ticks = host_ticks () - start_tick;
+	result.prompts = p_operator->get_prompts () - prompts_before;
+	if (p_wheel != NULL)
+	{
+		result.runout_after = p_wheel->runout ();
+		result.hop_after = p_wheel->hop ();
+		result.spread_after = p_wheel->tension_spread ();
+	}
+
+	if (result_pipe >= 0)
+	{
+		if (write (result_pipe, &result, sizeof (result)) != sizeof (result))
+		{
+			_exit (EXIT_FAILURE);
+		}
+		_exit (EXIT_SUCCESS);
+	}
+
+	int length;
+	if (p_replay != NULL)
+	{
+		length = snprintf (text, sizeof (text), "\nReplayed session %s after %.1f s: "
+			"%u moves, %u prompts, %u edges; %u bad and %u missing lines, %u lost "
+			"records\n", result.finished ? "finished" : "unfinished",
+			result.sim_ticks / 1000.0, result.moves, result.prompts,
+			(unsigned)p_replay->get_num_edges (), p_replay->get_bad_lines (),
+			p_replay->get_missing_lines (), (unsigned)p_replay->get_lost_records ());
+	}
+	else
+	{
+		length = snprintf (text, sizeof (text), "\nSimulated session %s after %.1f s: "
+			"%u moves, %.0f spokes turned, %u prompts, runout %.2f mm -> %.2f mm, "
+			"hop %.2f mm -> %.2f mm, tension spread %.1f -> %.1f quarter turns; "
+			"spoke sensor %u glitches, %u turned back, %u index corrections\n",
+			result.finished ? "finished" : "given up", result.sim_ticks / 1000.0,
+			result.moves, result.spokes_travelled, result.prompts,
+			result.runout_before, result.runout_after, result.hop_before,
+			result.hop_after, result.spread_before, result.spread_after,
+			spoke_glitches, spoke_reversals, spoke_corrections);
+	}
+	if (write (STDERR_FILENO, text, length) != length)
+	{
+		_exit (EXIT_FAILURE);
+	}
+	_exit (EXIT_SUCCESS);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function sends the wheel away and brings it back for another session.
+ *  \details The wheel is knocked out of true and put back on turned round, the score
+ *  is started again, and the user types \c start. It's called in interrupt context.
+ *  @param now The number of RTOS ticks since the scheduler started
+ */
+
+static void sim_return (uint32_t now)
+{
+	p_wheel->knock (return_knocks);
+	p_wheel->remount ();
+	return_knocks = 0;
+	returning = true;
+
+	start_tick = now;
+	prompts_before = p_operator->get_prompts ();
+	result.moves = 0;
+	result.spokes_travelled = 0.0;
+	result.runout_before = p_wheel->runout ();
+	result.hop_before = p_wheel->hop ();
+	result.spread_before = p_wheel->tension_spread ();
+	last_angle = p_wheel->get_angle ();
+
+	host_serial_inject ("start\r");
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function runs the simulation for one RTOS tick.
+ *  \details It's hooked onto the tick, so it runs in interrupt context just before
+ *  the kernel decides which task runs next.
+ */
+
+static void sim_tick (void)
+{
+	uint32_t now = host_ticks ();
+
+	if (p_replay != NULL)
+	{
+		p_replay->step (now);
+	}
+	else
+	{
+		p_wheel->step (host_motor_output (SIM_MOTOR_CHANNEL));
+		result.spokes_travelled += fabs (p_wheel->get_angle () - last_angle)
+								   * p_wheel->get_num_spokes () / (2.0 * M_PI);
+		last_angle = p_wheel->get_angle ();
+	}
+
+	if (desired_spoke != last_desired_spoke)
+	{
+		last_desired_spoke = desired_spoke;
+		result.moves++;
+	}
+
+	p_operator->tick (now);
+
+	if (returning)
+	{
+		returning = session_finished;
+	}
+	else if (session_finished && return_knocks > 0)
+	{
+		sim_return (now);
+	}
+	else if (session_finished)
+	{
+		result.finished = true;
+		sim_finish ();
+	}
+	if (time_limit_ticks != 0 && now - start_tick >= time_limit_ticks)
+	{
+		sim_finish ();
+	}
+	if (p_replay != NULL && p_replay->done ()
+		&& now >= p_replay->get_end_tick () + SIM_REPLAY_TAIL)
+	{
+		sim_finish ();
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function gets a number from an environment variable.
+ *  @param name The name of the environment variable
+ *  @param default_value The number to use if the variable isn't set
+ *  @return The number
+ */
+
+static double sim_getenv (const char* name, double default_value)
+{
+	const char* value = getenv (name);
+
+	return ((value != NULL) ? strtod (value, NULL) : default_value);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function gets the time from a clock which doesn't jump.
+ *  @return The time in seconds
+ */
+
+static double sim_wall_time (void)
+{
+	struct timespec now;
+
+	clock_gettime (CLOCK_MONOTONIC, &now);
+	return (now.tv_sec + now.tv_nsec / 1e9);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function runs a batch of sessions and prints what happened in each.
+ *  \details Each session is run in a child process, made before any of the RTOS's
+ *  threads exist, which goes on to run \c main() as usual and reports through a pipe.
+ *  The sessions are run one at a time so that the wall-clock times are comparable.
+ *  This process never returns from this function.
+ *  @param count How many sessions to run
+ *  @param first_seed The seed for the first wheel; each wheel uses the next one
+ */
+
+static void sim_batch (uint16_t count, uint32_t first_seed)
+{
+	uint16_t num_finished = 0;
+	double total_sim = 0.0, total_wall = 0.0, total_moves = 0.0, total_prompts = 0.0;
+
+	printf ("%6s %-8s %9s %9s %6s %8s %7s %7s %7s %7s %7s %5s %5s\n", "seed",
+			"result", "sim s", "wall s", "moves", "spokes", "prompts", "rob mm",
+			"roa mm", "hob mm", "hoa mm", "tsb", "tsa");
+
+	for (uint16_t run = 0; run < count; run++)
+	{
+		int fds[2];
+		sim_result run_result;
+		double start = sim_wall_time ();
+
+		fflush (stdout);
+		if (pipe (fds) != 0)
+		{
+			perror ("pipe");
+			exit (EXIT_FAILURE);
+		}
+
+		pid_t child = fork ();
+		if (child < 0)
+		{
+			perror ("fork");
+			exit (EXIT_FAILURE);
+		}
+		if (child == 0)
+		{
+			// The child runs one session, quietly unless asked not to, with nothing
+			// coming from the terminal to get mixed up with the operator's typing
+			close (fds[0]);
+			result_pipe = fds[1];
+			result.seed = first_seed + run;
+
+			int null_fd = open ("/dev/null", O_RDWR);
+			dup2 (null_fd, STDIN_FILENO);
+			if (getenv ("SIM_VERBOSE") == NULL)
+			{
+				dup2 (null_fd, STDOUT_FILENO);
+			}
+			close (null_fd);
+			return;
+		}
+
+		close (fds[1]);
+		bool got_result = (read (fds[0], &run_result, sizeof (run_result))
+						   == sizeof (run_result));
+		close (fds[0]);
+		waitpid (child, NULL, 0);
+		double wall = sim_wall_time () - start;
+
+		if (!got_result)
+		{
+			printf ("%6u %-8s\n", first_seed + run, "crashed");
+			continue;
+		}
+
+		printf ("%6u %-8s %9.1f %9.2f %6u %8.0f %7u %7.2f %7.2f %7.2f %7.2f %5.1f "
+				"%5.1f\n", run_result.seed, run_result.finished ? "finished" : "gave up",
+				run_result.sim_ticks / 1000.0, wall, run_result.moves,
+				run_result.spokes_travelled, run_result.prompts,
+				run_result.runout_before, run_result.runout_after,
+				run_result.hop_before, run_result.hop_after,
+				run_result.spread_before, run_result.spread_after);
+
+		num_finished += run_result.finished ? 1 : 0;
+		total_sim += run_result.sim_ticks / 1000.0;
+		total_wall += wall;
+		total_moves += run_result.moves;
+		total_prompts += run_result.prompts;
+	}
+
+	printf ("%u of %u finished; mean %.1f sim s, %.2f wall s, %.1f moves, "
+			"%.1f prompts\n", num_finished, count, total_sim / count,
+			total_wall / count, total_moves / count, total_prompts / count);
+	exit (EXIT_SUCCESS);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function sets up the simulation before \c main() runs.
+ *  \details A batch run only gets as far as \c sim_batch() in the parent process; the
+ *  children carry on here with their own seeds.
+ */
+
+static void sim_setup (void)
+{
+	const char* style_name = getenv ("SIM_OPERATOR");
+	sim_operator_style style = SIM_OPERATOR_LITERAL;
+	uint16_t batch = (uint16_t)sim_getenv ("SIM_BATCH", 0);
+	double num_spokes = sim_getenv ("SIM_SPOKES", DEFAULT_SPOKES);
+
+	result.seed = (uint32_t)sim_getenv ("SIM_SEED", 1);
+	unsigned most_spokes = (MAX_SPOKES < SIM_MAX_SPOKES) ? MAX_SPOKES : SIM_MAX_SPOKES;
+	if (num_spokes < 2 || num_spokes > most_spokes)
+	{
+		fprintf (stderr, "SIM_SPOKES must be from 2 to %u\n", most_spokes);
+		exit (EXIT_FAILURE);
+	}
+	if (batch > 0)
+	{
+		sim_batch (batch, result.seed);
+	}
+
+	if (style_name != NULL && strcmp (style_name, "mechanic") == 0)
+	{
+		style = SIM_OPERATOR_MECHANIC;
+	}
+	else if (style_name != NULL && strcmp (style_name, "none") == 0)
+	{
+		style = SIM_OPERATOR_NONE;
+	}
+
+	time_limit_ticks = (uint32_t)(sim_getenv ("SIM_TIME_LIMIT", 3600) * 1000.0);
+
+	if (getenv ("SIM_REPLAY") != NULL)
+	{
+		p_replay = new sim_replay (getenv ("SIM_REPLAY"));
+	}
+	else
+	{
+		p_wheel = new wheel_sim ((uint8_t)num_spokes, result.seed);
+		result.runout_before = p_wheel->runout ();
+		result.hop_before = p_wheel->hop ();
+		result.spread_before = p_wheel->tension_spread ();
+		last_angle = p_wheel->get_angle ();
+		p_wheel->set_marks (getenv ("SIM_VALVE") != NULL,
+							sim_getenv ("SIM_GLITCHES", 0));
+		return_knocks = (uint8_t)sim_getenv ("SIM_RETURN", 0);
+	}
+	p_operator = new sim_operator (p_wheel, style,
+								   (uint32_t)(sim_getenv ("SIM_REACTION", 2) * 1000.0));
+
+	if (getenv ("SIM_BUTTON") != NULL)
+	{
+		p_operator->answer_with_button ();
+	}
+	if (p_wheel != NULL && p_wheel->get_num_spokes () != DEFAULT_SPOKES)
+	{
+		char command[16];
+
+		snprintf (command, sizeof (command), "spokes %u\r",
+				  (unsigned)p_wheel->get_num_spokes ());
+		host_serial_inject (command);
+	}
+	if (getenv ("SIM_RADIAL") != NULL)
+	{
+		host_serial_inject ("radial on\r");
+	}
+	if (getenv ("SIM_TENSION") != NULL)
+	{
+		host_serial_inject ("tension on\r");
+	}
+
+	// The first session starts as soon as the stand is up, before anything typed
+	// could get there, so the wheel's number is set as if it had been typed earlier
+	wheel_number = (uint8_t)sim_getenv ("SIM_WHEEL", 0);
+
+	// The button's pull-up holds its pin high until it's pressed
+	host_set_input (&PINE, PE7, true);
+
+	host_set_adc_source (sim_adc);
+	host_set_serial_monitor (sim_monitor);
+	host_add_tick_hook (sim_tick);
+}
+
+
+/// This object's only job is to run sim_setup() before main()
+static struct sim_starter
+{
+	sim_starter (void) { sim_setup (); }
+} starter;
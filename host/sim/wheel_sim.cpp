@@ -0,0 +1,466 @@
+//*************************************************************************************
+/** \file wheel_sim.cpp
+ *    This file contains a simulated wheel on a simulated truing stand. See
+ *    \c wheel_sim.h for what's modelled. The model is deliberately simple; it's meant
+ *    to give the control and truing logic something realistic enough to work against
+ *    that how many moves, prompts and seconds a session takes can be compared between
+ *    versions of the software, not to predict exactly what a real wheel will do.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, host build of the truing stand
+ *    \li 10-18-26 Radial position of the rim, read by a second potentiometer
+ *    \li 10-18-26 A tensiometer reads the tension of the spoke at the sensors
+ *    \li 10-18-26 A valve hole and random glitches can be seen by the spoke sensor
+ *    \li 10-18-26 The valve hole is just before the spoke half way round; the wheel
+ *        can be knocked out of true and put back on the stand turned round
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include <math.h>
+#include <avr/io.h>
+#include "host_hardware.h"                  // Pretend hardware for the host build
+#include "wheel_sim.h"
+
+
+/// The length of one physics step, in seconds
+#define SIM_DT					(0.001 / SIM_STEPS_PER_TICK)
+
+/// The number of encoder edges in one turn of the wheel
+#define SIM_EDGES_PER_TURN		(4 * SIM_ENCODER_LINES)
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This constructor sets up a wheel with randomly wrong spoke tensions.
+ *  \details Each spoke's tension error is drawn from a normal distribution whose
+ *  standard deviation is \c SIM_TENSION_SPREAD quarter turns, so the same seed always
+ *  gives the same wheel.
+ *  @param a_num_spokes The number of spokes in the wheel, up to \c SIM_MAX_SPOKES
+ *  @param seed A number from which the wheel's faults are made up; zero isn't allowed
+ */
+
+wheel_sim::wheel_sim (uint8_t a_num_spokes, uint32_t seed)
+{
+	num_spokes = (a_num_spokes > SIM_MAX_SPOKES) ? SIM_MAX_SPOKES : a_num_spokes;
+	pitch = 2.0 * M_PI / num_spokes;
+	angle = pitch / 2.0;
+	speed = 0.0;
+	spoke_in_beam = false;
+	valve = false;
+	glitch_rate = 0.0;
+	glitch_left = 0.0;
+	encoder_edges = (int32_t)floor (angle * SIM_EDGES_PER_TURN / (2.0 * M_PI));
+
+	random_state = seed ? seed : 1;
+	for (uint8_t spoke = 0; spoke < num_spokes; spoke++)
+	{
+		tension[spoke] = gaussian (SIM_TENSION_SPREAD);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method makes the spoke sensor see things which aren't spokes.
+ *  \details Random numbers are only drawn for glitches if there are to be some, so
+ *  a wheel without them is the same as it always was.
+ *  @param a_valve True if the sensor sees the valve hole
+ *  @param a_glitch_rate How many glitches, on average, it sees per spoke turned by
+ */
+
+void wheel_sim::set_marks (bool a_valve, double a_glitch_rate)
+{
+	valve = a_valve;
+	glitch_rate = a_glitch_rate;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method gets a random number from 0 up to but not including 1.
+ *  \details It uses a xorshift generator, so runs don't depend on the C library's
+ *  \c rand() and can't disturb anything else which uses it.
+ *  @return The random number
+ */
+
+double wheel_sim::uniform (void)
+{
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 17;
+	random_state ^= random_state << 5;
+
+	return (random_state / 4294967296.0);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method gets a normally distributed random number with a mean of zero.
+ *  @param std_dev The standard deviation of the distribution
+ *  @return The random number
+ */
+
+double wheel_sim::gaussian (double std_dev)
+{
+	double u1 = 1.0 - uniform ();           // Never zero, so the log is finite
+	double u2 = uniform ();
+
+	return (std_dev * sqrt (-2.0 * log (u1)) * cos (2.0 * M_PI * u2));
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method moves the wheel along by one RTOS tick.
+ *  \details The motor pushes the wheel toward a speed proportional to the power it's
+ *  given, with the time constant of the motor and wheel together; friction slows it
+ *  by a fixed amount. A stopped wheel stays stopped unless the motor pushes harder
+ *  than stiction, and a wheel which friction would slow past zero just stops. The
+ *  sensor edges are made after each step, so they come in the right order.
+ *  @param power The motor power as a signed fraction of full power
+ */
+
+void wheel_sim::step (float power)
+{
+	for (uint8_t count = 0; count < SIM_STEPS_PER_TICK; count++)
+	{
+		double drive = (SIM_MAX_SPEED * power - speed) / SIM_TIME_CONSTANT;
+
+		if (speed == 0.0)
+		{
+			if (fabs (power) <= SIM_STICTION)
+			{
+				continue;
+			}
+			drive -= copysign (SIM_MAX_SPEED * SIM_FRICTION / SIM_TIME_CONSTANT, power);
+			speed = drive * SIM_DT;
+		}
+		else
+		{
+			double new_speed = speed + (drive - copysign (SIM_MAX_SPEED * SIM_FRICTION
+				/ SIM_TIME_CONSTANT, speed)) * SIM_DT;
+
+			// Friction can stop the wheel but can't make it turn the other way
+			speed = (new_speed * speed < 0.0) ? 0.0 : new_speed;
+		}
+
+		angle += speed * SIM_DT;
+		make_edges ();
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method makes the spoke and encoder sensor edges the wheel has passed.
+ *  \details The encoder's two channels go through the states 00, 10, 11, 01 (A on
+ *  PE5, B on PE6) as the wheel turns forward, one state per edge. The spoke sensor
+ *  (PE4) goes high while a spoke, the valve hole or a glitch is in its beam. The
+ *  encoder is done first so that the direction it gives is up to date when the spoke
+ *  sensor's edge arrives.
+ */
+
+void wheel_sim::make_edges (void)
+{
+	static const uint8_t quadrature[4] = { 0x00, 0x01, 0x03, 0x02 };
+
+	int32_t new_edges = (int32_t)floor (angle * SIM_EDGES_PER_TURN / (2.0 * M_PI));
+	while (encoder_edges != new_edges)
+	{
+		uint8_t old_state = quadrature[encoder_edges & 3];
+		encoder_edges += (new_edges > encoder_edges) ? 1 : -1;
+		uint8_t new_state = quadrature[encoder_edges & 3];
+
+		if ((old_state ^ new_state) & 0x01)
+		{
+			host_set_input (&PINE, PE5, new_state & 0x01);
+		}
+		if ((old_state ^ new_state) & 0x02)
+		{
+			host_set_input (&PINE, PE6, new_state & 0x02);
+		}
+	}
+
+	double from_spoke = angle - pitch * floor (angle / pitch + 0.5);
+	bool in_beam = fabs (from_spoke) < pitch * SIM_SPOKE_WIDTH / 2.0;
+
+	if (valve)
+	{
+		double from_valve = remainder (angle - pitch * (num_spokes / 2 - 0.5),
+									   2.0 * M_PI);
+		in_beam = in_beam || fabs (from_valve) < pitch * SIM_MARK_WIDTH / 2.0;
+	}
+
+	// A glitch starts at random as the wheel turns, and lasts while it turns a little
+	double moved = fabs (speed * SIM_DT);
+	if (glitch_left > 0.0)
+	{
+		glitch_left -= moved;
+		in_beam = true;
+	}
+	else if (glitch_rate > 0.0 && moved > 0.0
+			 && uniform () < glitch_rate * moved / pitch)
+	{
+		glitch_left = pitch * SIM_MARK_WIDTH;
+	}
+
+	if (in_beam != spoke_in_beam)
+	{
+		spoke_in_beam = in_beam;
+		host_set_input (&PINE, PE4, in_beam);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method finds the sideways position of the rim at a given angle.
+ *  \details Each spoke pulls the rim toward its flange in proportion to its tension
+ *  error, and its pull falls off along the rim as a Gaussian bump a little wider than
+ *  the spoke spacing, so neighbouring spokes share the work as they do in a real rim.
+ *  @param an_angle The angle at which to find the rim's position, in radians
+ *  @return The rim's sideways position in mm, positive toward the left flange
+ */
+
+double wheel_sim::lateral (double an_angle)
+{
+	double position = 0.0;
+
+	for (uint8_t spoke = 0; spoke < num_spokes; spoke++)
+	{
+		double apart = remainder (an_angle - spoke * pitch, 2.0 * M_PI)
+					   / (pitch * SIM_INFLUENCE_WIDTH);
+		position += side (spoke) * tension[spoke] * SIM_MM_PER_QUARTER
+					* exp (-apart * apart);
+	}
+
+	return (position);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method finds the radial position of the rim at a given angle.
+ *  \details Each spoke pulls the rim in toward the hub in proportion to its tension
+ *  error, whichever flange it goes to, spread along the rim as for \c lateral().
+ *  @param an_angle The angle at which to find the rim's position, in radians
+ *  @return The rim's radial position in mm, positive outward
+ */
+
+double wheel_sim::radial (double an_angle)
+{
+	double position = 0.0;
+
+	for (uint8_t spoke = 0; spoke < num_spokes; spoke++)
+	{
+		double apart = remainder (an_angle - spoke * pitch, 2.0 * M_PI)
+					   / (pitch * SIM_INFLUENCE_WIDTH);
+		position -= tension[spoke] * SIM_MM_PER_QUARTER_IN * exp (-apart * apart);
+	}
+
+	return (position);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method finds how far out of true the wheel is.
+ *  @return The biggest difference in rim position between any two spokes, in mm
+ */
+
+double wheel_sim::runout (void)
+{
+	double lowest = lateral (0.0);
+	double highest = lowest;
+
+	for (uint8_t spoke = 1; spoke < num_spokes; spoke++)
+	{
+		double position = lateral (spoke * pitch);
+		lowest = (position < lowest) ? position : lowest;
+		highest = (position > highest) ? position : highest;
+	}
+
+	return (highest - lowest);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method finds how far out of round the wheel is.
+ *  @return The biggest difference in radial rim position between any two spokes, in mm
+ */
+
+double wheel_sim::hop (void)
+{
+	double lowest = radial (0.0);
+	double highest = lowest;
+
+	for (uint8_t spoke = 1; spoke < num_spokes; spoke++)
+	{
+		double position = radial (spoke * pitch);
+		lowest = (position < lowest) ? position : lowest;
+		highest = (position > highest) ? position : highest;
+	}
+
+	return (highest - lowest);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method finds how uneven the spokes' tensions are.
+ *  @return The biggest difference in tension between any two spokes, in quarter
+ *          turns of a nipple
+ */
+
+double wheel_sim::tension_spread (void)
+{
+	double lowest = tension[0];
+	double highest = lowest;
+
+	for (uint8_t spoke = 1; spoke < num_spokes; spoke++)
+	{
+		lowest = (tension[spoke] < lowest) ? tension[spoke] : lowest;
+		highest = (tension[spoke] > highest) ? tension[spoke] : highest;
+	}
+
+	return (highest - lowest);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method finds what the rim potentiometer reads where the wheel is now.
+ *  @return The A/D reading, from 0 to 1023
+ */
+
+uint16_t wheel_sim::pot_reading (void)
+{
+	double reading = SIM_POT_CENTER + SIM_POT_COUNTS_PER_MM * lateral (angle)
+					 + gaussian (SIM_POT_NOISE);
+
+	if (reading < 0.0)
+	{
+		return (0);
+	}
+	if (reading > 1023.0)
+	{
+		return (1023);
+	}
+	return ((uint16_t)(reading + 0.5));
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method finds what the potentiometer which reads the rim's radial
+ *  position reads where the wheel is now. It's mounted and scaled as the rim pot is.
+ *  @return The A/D reading, from 0 to 1023
+ */
+
+uint16_t wheel_sim::hop_reading (void)
+{
+	double reading = SIM_POT_CENTER + SIM_POT_COUNTS_PER_MM * radial (angle)
+					 + gaussian (SIM_POT_NOISE);
+
+	if (reading < 0.0)
+	{
+		return (0);
+	}
+	if (reading > 1023.0)
+	{
+		return (1023);
+	}
+	return ((uint16_t)(reading + 0.5));
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method finds what the tensiometer reads where the wheel is now. It
+ *  reads the spoke nearest the sensors, with the same noise as the pots.
+ *  @return The A/D reading, from 0 to 1023
+ */
+
+uint16_t wheel_sim::tension_reading (void)
+{
+	double reading = SIM_TENSION_CENTER + SIM_TENSION_COUNTS * tension[nearest_spoke ()]
+					 + gaussian (SIM_POT_NOISE);
+
+	if (reading < 0.0)
+	{
+		return (0);
+	}
+	if (reading > 1023.0)
+	{
+		return (1023);
+	}
+	return ((uint16_t)(reading + 0.5));
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method finds which spoke is nearest the sensors, which is the one a
+ *  person standing at the stand would reach for.
+ *  @return The number of the spoke, from 0 to one less than the number of spokes
+ */
+
+uint8_t wheel_sim::nearest_spoke (void)
+{
+	int32_t spoke = (int32_t)floor (angle / pitch + 0.5) % num_spokes;
+
+	return ((uint8_t)((spoke < 0) ? spoke + num_spokes : spoke));
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method turns a spoke's nipple, changing its tension.
+ *  @param spoke The number of the spoke to be turned
+ *  @param quarter_turns How far to turn it; positive tightens and negative loosens
+ */
+
+void wheel_sim::turn_spoke (uint8_t spoke, int8_t quarter_turns)
+{
+	if (spoke < num_spokes)
+	{
+		tension[spoke] += quarter_turns;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method knocks some spokes out of true, as riding the wheel would.
+ *  \details Each of the spokes, picked at random, has its tension changed by as
+ *  much as a spoke of a new wheel is off by.
+ *  @param spokes How many spokes to knock
+ */
+
+void wheel_sim::knock (uint8_t spokes)
+{
+	for (uint8_t count = 0; count < spokes; count++)
+	{
+		uint8_t spoke = (uint8_t)(uniform () * num_spokes);
+
+		tension[spoke] += gaussian (SIM_TENSION_SPREAD);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method takes the wheel off the stand and puts it back on turned round
+ *  by a random number of whole spokes.
+ *  \details The wheel is turned all at once, so the encoder's edges are made but the
+ *  spoke sensor doesn't see the spokes go by; the stand's spoke count is left where
+ *  it was, as it would be, pointing at some other spoke.
+ *  @return How many spokes the wheel was turned round by
+ */
+
+uint8_t wheel_sim::remount (void)
+{
+	uint8_t turned = 1 + (uint8_t)(uniform () * (num_spokes - 1));
+
+	angle += turned * pitch;
+	speed = 0.0;
+	make_edges ();
+
+	return (turned);
+}
@@ -0,0 +1,229 @@
+//*************************************************************************************
+/** \file wheel_sim.h
+ *    This file contains the interface to a simulated wheel on a simulated truing stand.
+ *    The wheel is spun by the motor on channel 2 of the pretend motor driver through a
+ *    first order model of the motor and wheel with Coulomb friction and stiction. As
+ *    it turns it makes the edges the spoke sensor (PE4) and the quadrature encoder
+ *    (PE5 and PE6) would make, and its rim wobbles from side to side according to how
+ *    far each spoke's tension is from where it ought to be. The potentiometer which
+ *    rides on the rim reads that wobble, plus some noise.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, host build of the truing stand
+ *    \li 10-18-26 Radial position of the rim, read by a second potentiometer
+ *    \li 10-18-26 A tensiometer reads the tension of the spoke at the sensors
+ *    \li 10-18-26 A valve hole and random glitches can be seen by the spoke sensor
+ *    \li 10-18-26 The valve hole is just before the spoke half way round; the wheel
+ *        can be knocked out of true and put back on the stand turned round
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+// This define prevents this .h file from being included multiple times in a .cpp file
+#ifndef _WHEEL_SIM_H_
+#define _WHEEL_SIM_H_
+
+#include <stdint.h>
+
+
+/// The most spokes a simulated wheel can have
+#define SIM_MAX_SPOKES			48
+
+/// The number of lines on the encoder disc; each line makes four edges per turn
+#define SIM_ENCODER_LINES		64
+
+/// The motor driver channel which turns the wheel, as in \c task_pos_controller
+#define SIM_MOTOR_CHANNEL		2
+
+/// The A/D channel to which the rim potentiometer is connected
+#define SIM_POT_CHANNEL			0
+
+/// The A/D channel to which the potentiometer reading the rim's radial position is
+/// connected, as \c HOP_CHANNEL in \c mastermind.h
+#define SIM_HOP_CHANNEL			1
+
+/// The A/D channel to which the tensiometer is connected, as \c TENSION_CHANNEL in
+/// \c mastermind.h
+#define SIM_TENSION_CHANNEL		2
+
+/// The tensiometer's reading for a spoke at the right tension
+#define SIM_TENSION_CENTER		512
+
+/// How much the tensiometer's reading goes up for each quarter turn of tightening
+#define SIM_TENSION_COUNTS		8.0
+
+/// The number of physics steps done in each 1 ms RTOS tick
+#define SIM_STEPS_PER_TICK		10
+
+/// Wheel speed at full power with no friction, in radians per second
+#define SIM_MAX_SPEED			3.14
+
+/// Time constant of the motor and wheel, in seconds
+#define SIM_TIME_CONSTANT		0.1
+
+/// Coulomb (sliding) friction, as the fraction of full power needed to overcome it
+#define SIM_FRICTION			0.03
+
+/// Stiction, as the fraction of full power needed to get a stopped wheel moving
+#define SIM_STICTION			0.05
+
+/// The width of a spoke as it passes the spoke sensor, as a fraction of spoke spacing
+#define SIM_SPOKE_WIDTH			0.2
+
+/// The width of the valve hole and of a glitch as the spoke sensor sees them, as a
+/// fraction of spoke spacing
+#define SIM_MARK_WIDTH			0.05
+
+/// How far one quarter turn of a spoke's nipple moves the rim at that spoke, in mm
+#define SIM_MM_PER_QUARTER		0.25
+
+/// How far one quarter turn of a spoke's nipple pulls the rim in toward the hub at
+/// that spoke, in mm
+#define SIM_MM_PER_QUARTER_IN	0.08
+
+/// How far along the rim one spoke's pull spreads, in spoke spacings
+#define SIM_INFLUENCE_WIDTH		1.2
+
+/// Potentiometer reading with the rim in the middle of its travel, in A/D counts
+#define SIM_POT_CENTER			512
+
+/// Potentiometer sensitivity in A/D counts per mm of sideways rim movement
+#define SIM_POT_COUNTS_PER_MM	20.0
+
+/// Standard deviation of the noise on potentiometer readings, in A/D counts
+#define SIM_POT_NOISE			1.5
+
+/// Standard deviation of each spoke's initial tension error, in quarter turns
+#define SIM_TENSION_SPREAD		3.0
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This class simulates a bicycle wheel on the truing stand.
+ *  \details Angles are in radians, with spoke \c k at angle \c k times the spoke
+ *  spacing; the wheel starts half way between spokes 0 and 1, having just passed
+ *  spoke 0, so the software's spoke count of zero is right from the start. Spokes
+ *  alternate between the left and right flanges, starting with the left. Tightening
+ *  a spoke by a quarter turn pulls the rim toward its flange, which is positive for
+ *  left spokes and negative for right ones, and a little way in toward the hub,
+ *  whichever flange it goes to.
+ *
+ *  The valve hole, if the spoke sensor sees it, is in the middle of the gap half way
+ *  round the wheel from the start, before spoke \c num_spokes / 2, out of the way of
+ *  the first measuring's run up. A stand homed to it numbers that spoke 0, which
+ *  with an even number of spokes is on the same flange as this wheel's spoke 0.
+ */
+
+class wheel_sim
+{
+	protected:
+		/// The number of spokes in the wheel
+		uint8_t num_spokes;
+
+		/// The angle from one spoke to the next, in radians
+		double pitch;
+
+		/// The angle through which the wheel has turned, in radians
+		double angle;
+
+		/// How fast the wheel is turning, in radians per second
+		double speed;
+
+		/// How far each spoke's tension is from right, in quarter turns of its nipple
+		double tension[SIM_MAX_SPOKES];
+
+		/// The number of encoder edges the wheel has passed, used to make new edges
+		int32_t encoder_edges;
+
+		/// Whether a spoke is in the spoke sensor's beam
+		bool spoke_in_beam;
+
+		/// Whether the spoke sensor sees the valve hole
+		bool valve;
+
+		/// How many glitches the spoke sensor sees per spoke the wheel turns by
+		double glitch_rate;
+
+		/// How much further the wheel turns before the glitch in the beam ends
+		double glitch_left;
+
+		/// State of the random number generator
+		uint32_t random_state;
+
+		// Get a random number from 0 up to but not including 1
+		double uniform (void);
+
+		// Get a normally distributed random number with the given standard deviation
+		double gaussian (double std_dev);
+
+		// Make the spoke and encoder sensor edges which the wheel has passed
+		void make_edges (void);
+
+	public:
+		// The constructor sets up a wheel with randomly wrong spoke tensions
+		wheel_sim (uint8_t a_num_spokes, uint32_t seed);
+
+		// Make the spoke sensor see the valve hole, random glitches, or both
+		void set_marks (bool a_valve, double a_glitch_rate);
+
+		// Move the wheel along by one RTOS tick
+		void step (float power);
+
+		// Get the sideways position of the rim at the given angle
+		double lateral (double an_angle);
+
+		// Get the radial position of the rim at the given angle
+		double radial (double an_angle);
+
+		// Get the biggest difference in rim position between any two spokes
+		double runout (void);
+
+		// Get the biggest difference in radial rim position between any two spokes
+		double hop (void);
+
+		// Get the biggest difference in tension between any two spokes
+		double tension_spread (void);
+
+		// Get the A/D reading from the rim potentiometer
+		uint16_t pot_reading (void);
+
+		// Get the A/D reading from the potentiometer reading the rim's radial position
+		uint16_t hop_reading (void);
+
+		// Get the A/D reading from the tensiometer
+		uint16_t tension_reading (void);
+
+		// Get the number of the spoke nearest the sensors
+		uint8_t nearest_spoke (void);
+
+		// Turn a spoke's nipple by some quarter turns; positive to tighten
+		void turn_spoke (uint8_t spoke, int8_t quarter_turns);
+
+		// Knock some spokes at random out of true, as riding the wheel would
+		void knock (uint8_t spokes);
+
+		// Take the wheel off and put it back on turned round by some whole spokes
+		uint8_t remount (void);
+
+		/// Get the number of spokes in the wheel
+		uint8_t get_num_spokes (void) { return (num_spokes); }
+
+		/// Get the angle through which the wheel has turned, in radians
+		double get_angle (void) { return (angle); }
+
+		/// Find which flange a spoke goes to: +1 for the left one, -1 for the right
+		int8_t side (uint8_t spoke) { return ((spoke & 1) ? -1 : 1); }
+};
+
+#endif // _WHEEL_SIM_H_
@@ -0,0 +1,245 @@
+//*************************************************************************************
+/** \file format_check.cpp
+ *    This file contains a program for a Linux PC which checks the emstream's fast
+ *    decimal conversions, \c ems_u16_to_dec() and \c ems_u32_to_dec(), against the
+ *    avr-libc conversions (\c utoa() and friends) which the inserters used before.
+ *    Every 16-bit number, unsigned and signed, is checked; so are the 32-bit numbers
+ *    below \c FC_ALL_BELOW, those \c FC_STEP apart above it, the numbers on either
+ *    side of each power of ten, and the largest and smallest. Each mismatch is
+ *    printed, and the program exits with a failure status if there were any. Then
+ *    both ways are timed by the PC's clock.
+ *
+ *    Usage: \c format_check [-a]
+ *    \li \c -a  Check every 32-bit number, which takes a few minutes
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, host check of the number formatting
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>                         // The stand-in, with utoa() and friends
+#include <string.h>
+#include <unistd.h>                         // For getopt()
+#include <time.h>                           // For clock_gettime()
+#include "emstream.h"                       // For ems_u16_to_dec() and ems_u32_to_dec()
+
+
+/// Every 32-bit number below this one is checked
+#define FC_ALL_BELOW			0x01000000UL
+
+/// Above \c FC_ALL_BELOW, 32-bit numbers this far apart are checked. It's prime so
+/// that the numbers checked end in every digit
+#define FC_STEP					997UL
+
+/// The most mismatches which are printed; the rest are only counted
+#define FC_MAX_PRINTED			20
+
+
+/// The number of conversions compared so far
+static uint64_t checked = 0;
+
+/// The number of those which didn't match
+static uint64_t wrong = 0;
+
+/// Written by the timing loops so that the compiler can't leave the work out
+static volatile char sink;
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function reads the PC's clock.
+ *  @return The time in nanoseconds since some fixed moment
+ */
+
+static uint64_t nanoseconds (void)
+{
+	struct timespec now;
+
+	clock_gettime (CLOCK_MONOTONIC, &now);
+	return ((uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function compares two conversions of the same number.
+ *  \details A mismatch is counted, and printed if not too many have been already.
+ *  @param number The number which was converted, as the caller should see it
+ *  @param library The text from the avr-libc function
+ *  @param fast The text from the emstream's function
+ */
+
+static void compare (long long number, const char* library, const char* fast)
+{
+	checked++;
+	if (strcmp (library, fast) != 0)
+	{
+		if (++wrong <= FC_MAX_PRINTED)
+		{
+			printf ("%lld: library \"%s\", fast \"%s\"\n", number, library, fast);
+		}
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function checks one 16-bit number, unsigned and signed.
+ *  \details The signed number is printed the way the \c int16_t inserter does it,
+ *  as a minus sign and then the magnitude.
+ *  @param number The number to be checked
+ */
+
+static void check_16 (uint16_t number)
+{
+	char library[12];
+	char fast[12];
+
+	utoa (number, library, 10);
+	ems_u16_to_dec (number, fast);
+	compare (number, library, fast);
+
+	int16_t signed16 = (int16_t)number;
+	itoa (signed16, library, 10);
+	fast[0] = '-';
+	ems_u16_to_dec ((signed16 < 0) ? 0 - number : number, fast + (signed16 < 0));
+	compare (signed16, library, fast);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function checks one 32-bit number, unsigned and signed.
+ *  @param number The number to be checked
+ */
+
+static void check_32 (uint32_t number)
+{
+	char library[12];
+	char fast[12];
+
+	ultoa (number, library, 10);
+	ems_u32_to_dec (number, fast);
+	compare (number, library, fast);
+
+	int32_t signed32 = (int32_t)number;
+	ltoa (signed32, library, 10);
+	fast[0] = '-';
+	ems_u32_to_dec ((signed32 < 0) ? 0 - number : number, fast + (signed32 < 0));
+	compare (signed32, library, fast);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function checks the conversions, then times them.
+ *  @param argc The number of command line arguments
+ *  @param argv The command line arguments
+ *  @return \c EXIT_SUCCESS if every conversion matched, \c EXIT_FAILURE if not
+ */
+
+int main (int argc, char** argv)
+{
+	bool check_all = false;
+	int option;
+
+	while ((option = getopt (argc, argv, "a")) != -1)
+	{
+		if (option == 'a')
+		{
+			check_all = true;
+		}
+		else
+		{
+			fprintf (stderr, "Usage: %s [-a]\n", argv[0]);
+			return (EXIT_FAILURE);
+		}
+	}
+
+	uint16_t num16 = 0;
+	do
+	{
+		check_16 (num16);
+	}
+	while (++num16 != 0);
+
+	// The count is kept in 64 bits so that it can go past the largest 32-bit number
+	uint64_t step = check_all ? 1 : FC_STEP;
+	for (uint64_t count = 0; count <= 0xFFFFFFFFULL;
+		 count += (count < FC_ALL_BELOW) ? 1 : step)
+	{
+		check_32 ((uint32_t)count);
+	}
+
+	for (uint32_t power = 10; power <= 1000000000UL; power *= 10)
+	{
+		check_32 (power - 1);
+		check_32 (power);
+		check_32 (power + 1);
+	}
+	check_32 (0x7FFFFFFFUL);
+	check_32 (0x80000000UL);
+	check_32 (0xFFFFFFFFUL);
+
+	printf ("Number format check, %llu numbers, %llu wrong\n",
+			(unsigned long long)checked, (unsigned long long)wrong);
+
+	// Time each way over every 16-bit number and the same spread of 32-bit ones
+	char text[12];
+	uint64_t start;
+	uint32_t num32;
+
+	start = nanoseconds ();
+	num16 = 0;
+	do
+	{
+		utoa (num16, text, 10);
+		sink = text[0];
+	}
+	while (++num16 != 0);
+	uint64_t lib_16_ns = nanoseconds () - start;
+
+	start = nanoseconds ();
+	do
+	{
+		ems_u16_to_dec (num16, text);
+		sink = text[0];
+	}
+	while (++num16 != 0);
+	uint64_t fast_16_ns = nanoseconds () - start;
+
+	start = nanoseconds ();
+	for (num32 = 0; num32 <= 0xFFFFFFFFUL - FC_STEP; num32 += FC_STEP)
+	{
+		ultoa (num32, text, 10);
+		sink = text[0];
+	}
+	uint64_t lib_32_ns = nanoseconds () - start;
+
+	start = nanoseconds ();
+	for (num32 = 0; num32 <= 0xFFFFFFFFUL - FC_STEP; num32 += FC_STEP)
+	{
+		ems_u32_to_dec (num32, text);
+		sink = text[0];
+	}
+	uint64_t fast_32_ns = nanoseconds () - start;
+
+	printf ("16 bit: utoa %llu us, pairs %llu us\n",
+			(unsigned long long)(lib_16_ns / 1000),
+			(unsigned long long)(fast_16_ns / 1000));
+	printf ("32 bit: ultoa %llu us, pairs %llu us\n",
+			(unsigned long long)(lib_32_ns / 1000),
+			(unsigned long long)(fast_32_ns / 1000));
+
+	return (wrong ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -0,0 +1,386 @@
+//*************************************************************************************
+/** \file session_analyser.cpp
+ *    This file contains the analyser which sorts telemetry records into sessions.
+ *    See \c session_analyser.h for the files it writes.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, telemetry recorder and session analyser
+ *    \li 10-18-26 Radial offsets are written to their own file
+ *    \li 10-18-26 So are spoke tensions
+ *    \li 10-18-26 The stand sends micrometres, so runouts need no scale to be given
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>                         // For access()
+#include "session_analyser.h"
+
+
+/// The longest file name the analyser makes
+#define ANALYSER_NAME_SIZE		512
+
+/// The names of the phases, as written in the files
+static const char* phase_names[ANALYSER_PHASES] =
+	{ "none", "measure", "move", "adjust", "done" };
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This constructor sets up an analyser which writes into the given directory.
+ *  @param a_directory The directory into which the files are written
+ */
+
+session_analyser::session_analyser (const char* a_directory)
+{
+	directory = a_directory;
+	session_number = 0;
+	active = false;
+	p_measurements = NULL;
+	p_offsets = NULL;
+	p_radial = NULL;
+	p_tensions = NULL;
+	p_phases = NULL;
+	p_worst = NULL;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method starts a new session.
+ *  \details The session's files aren't opened until there's something to put in them.
+ *  @param time_ms The time of the session's first record
+ */
+
+void session_analyser::start (uint32_t time_ms)
+{
+	session_number++;
+	active = true;
+	start_ms = time_ms;
+	last_ms = time_ms;
+	iteration = 0;
+	finished = false;
+	memset (phase_ms, 0, sizeof (phase_ms));
+	memset (phase_count, 0, sizeof (phase_count));
+	first_runout = -1;
+	last_runout = -1;
+	next_sequence = -1;
+	missing_records = 0;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method takes in one record.
+ *  \details A record whose body is the wrong length for its type is ignored. A first
+ *  measuring phase, or a clock which has gone backwards, starts a new session.
+ *  @param record The record
+ */
+
+void session_analyser::add (const telem_record& record)
+{
+	const uint8_t* p_body = record.p_body;
+	uint8_t body_length = record.body_length;
+
+	bool restart = (record.type == TELEM_STATE && body_length == 5
+					&& p_body[0] == TELEM_PHASE_MEASURE
+					&& telem_get_int16 (p_body + 1) == 0);
+	if (active && (restart || record.time_ms < last_ms))
+	{
+		finish ();
+	}
+	if (!active)
+	{
+		start (record.time_ms);
+	}
+
+	if (next_sequence >= 0)
+	{
+		missing_records += (uint8_t)(record.sequence - next_sequence);
+	}
+	next_sequence = (record.sequence + 1) & 0xFF;
+	last_ms = record.time_ms;
+
+	switch (record.type)
+	{
+		case TELEM_MEASUREMENTS:
+			if (body_length >= 1 && body_length == 3 + 2 * p_body[0])
+			{
+				write_spokes (&p_measurements, "measurements", "average", record,
+							  telem_get_int16 (p_body + 1 + 2 * p_body[0]));
+			}
+			break;
+
+		case TELEM_TENSIONS:
+			if (body_length >= 1 && body_length == 3 + 2 * p_body[0])
+			{
+				write_spokes (&p_tensions, "tensions", "average", record,
+							  telem_get_int16 (p_body + 1 + 2 * p_body[0]));
+			}
+			break;
+
+		case TELEM_OFFSETS:
+			if (body_length >= 1 && body_length == 1 + 2 * p_body[0] && p_body[0] > 0)
+			{
+				last_runout = spread (record);
+				if (first_runout < 0)
+				{
+					first_runout = last_runout;
+				}
+				write_spokes (&p_offsets, "offsets", "runout", record, last_runout);
+			}
+			break;
+
+		case TELEM_RADIAL_OFFSETS:
+			if (body_length >= 1 && body_length == 1 + 2 * p_body[0] && p_body[0] > 0)
+			{
+				write_spokes (&p_radial, "radial", "runout", record, spread (record));
+			}
+			break;
+
+		case TELEM_WORST:
+			if (body_length == 3)
+			{
+				if (p_worst == NULL)
+				{
+					p_worst = open_file ("worst", "time_ms,iteration,spoke,offset", 0);
+				}
+				if (p_worst != NULL)
+				{
+					fprintf (p_worst, "%u,%u,%u,%d\n", record.time_ms, iteration,
+							 p_body[0], telem_get_int16 (p_body + 1));
+				}
+			}
+			break;
+
+		case TELEM_STATE:
+			if (body_length == 5)
+			{
+				iteration = (uint16_t)telem_get_int16 (p_body + 1);
+				if (p_body[0] == TELEM_PHASE_DONE)
+				{
+					finished = true;
+					finish ();
+				}
+			}
+			break;
+
+		case TELEM_TIMING:
+			if (body_length == 5 && p_body[0] < ANALYSER_PHASES)
+			{
+				uint32_t duration = telem_get_uint32 (p_body + 1);
+				phase_ms[p_body[0]] += duration;
+				phase_count[p_body[0]]++;
+				if (p_phases == NULL)
+				{
+					p_phases = open_file ("phases",
+										  "end_ms,phase,iteration,duration_ms", 0);
+				}
+				if (p_phases != NULL)
+				{
+					fprintf (p_phases, "%u,%s,%u,%u\n", record.time_ms,
+							 phase_names[p_body[0]], iteration, duration);
+				}
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method opens one of a session's files and writes its header line.
+ *  @param kind The kind of file, which is part of its name
+ *  @param header The header line, without the end of line
+ *  @param num_spokes If not zero, columns for this many spokes are added to the header
+ *  @return The open file, or \c NULL if it couldn't be opened
+ */
+
+FILE* session_analyser::open_file (const char* kind, const char* header,
+								   uint8_t num_spokes)
+{
+	char name[ANALYSER_NAME_SIZE];
+
+	snprintf (name, sizeof (name), "%s/session-%u-%s.csv", directory, session_number,
+			  kind);
+	FILE* p_file = fopen (name, "w");
+	if (p_file == NULL)
+	{
+		perror (name);
+		return (NULL);
+	}
+
+	fputs (header, p_file);
+	for (uint8_t spoke = 0; spoke < num_spokes; spoke++)
+	{
+		fprintf (p_file, ",spoke_%u", spoke);
+	}
+	fputc ('\n', p_file);
+
+	return (p_file);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method writes a row of spoke values to a file.
+ *  \details The row is the record's time, the iteration, one extra value and the
+ *  value at each spoke. The file is opened, with columns for as many spokes as this
+ *  record has, if it isn't open yet.
+ *  @param pp_file A pointer to the pointer to the file
+ *  @param kind The kind of file, which is part of its name
+ *  @param extra_name The name of the extra value's column
+ *  @param record A measurement or offset record, whose length has been checked
+ *  @param extra_value The extra value
+ */
+
+void session_analyser::write_spokes (FILE** pp_file, const char* kind,
+									 const char* extra_name, const telem_record& record,
+									 int32_t extra_value)
+{
+	uint8_t num_spokes = record.p_body[0];
+
+	if (*pp_file == NULL)
+	{
+		char header[64];
+		snprintf (header, sizeof (header), "time_ms,iteration,%s", extra_name);
+		*pp_file = open_file (kind, header, num_spokes);
+		if (*pp_file == NULL)
+		{
+			return;
+		}
+	}
+
+	fprintf (*pp_file, "%u,%u,%d", record.time_ms, iteration, extra_value);
+	for (uint8_t spoke = 0; spoke < num_spokes; spoke++)
+	{
+		fprintf (*pp_file, ",%d", telem_get_int16 (record.p_body + 1 + 2 * spoke));
+	}
+	fputc ('\n', *pp_file);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method finds the runout in a record of offsets.
+ *  @param record An offset record, whose length has been checked
+ *  @return The biggest difference between any two spokes' offsets, in micrometres
+ */
+
+int32_t session_analyser::spread (const telem_record& record)
+{
+	int16_t lowest = telem_get_int16 (record.p_body + 1);
+	int16_t highest = lowest;
+
+	for (uint8_t index = 1; index < record.p_body[0]; index++)
+	{
+		int16_t offset = telem_get_int16 (record.p_body + 1 + 2 * index);
+		lowest = (offset < lowest) ? offset : lowest;
+		highest = (offset > highest) ? offset : highest;
+	}
+
+	return (highest - lowest);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method prints a runout in micrometres and millimetres.
+ *  @param p_file The file to print on
+ *  @param runout The runout in micrometres, or -1 if it isn't known
+ */
+
+void session_analyser::print_runout (FILE* p_file, int32_t runout)
+{
+	if (runout < 0)
+	{
+		fputs ("unknown", p_file);
+	}
+	else
+	{
+		fprintf (p_file, "%d um (%.2f mm)", runout, runout / 1000.0);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method ends the session going on, if there is one, and reports on it.
+ *  \details The summary is printed on \c stdout and added to \c summary.csv, whose
+ *  header line is written if the file is new.
+ */
+
+void session_analyser::finish (void)
+{
+	if (!active)
+	{
+		return;
+	}
+	active = false;
+
+	FILE** files[] = { &p_measurements, &p_offsets, &p_radial, &p_tensions, &p_phases,
+					   &p_worst };
+	for (uint8_t index = 0; index < sizeof (files) / sizeof (files[0]); index++)
+	{
+		if (*files[index] != NULL)
+		{
+			fclose (*files[index]);
+			*files[index] = NULL;
+		}
+	}
+
+	double seconds = (last_ms - start_ms) / 1000.0;
+	printf ("Session %u: %s after %.1f s, %u iterations\n", session_number,
+			finished ? "finished" : "unfinished", seconds, iteration);
+	printf ("  ");
+	for (uint8_t phase = TELEM_PHASE_MEASURE; phase < TELEM_PHASE_DONE; phase++)
+	{
+		printf ("%s%s %.1f s in %u", (phase == TELEM_PHASE_MEASURE) ? "" : ", ",
+				phase_names[phase], phase_ms[phase] / 1000.0, phase_count[phase]);
+	}
+	printf ("\n  runout ");
+	print_runout (stdout, first_runout);
+	printf (" -> ");
+	print_runout (stdout, last_runout);
+	printf ("\n  %u records missing\n", missing_records);
+	fflush (stdout);
+
+	char name[ANALYSER_NAME_SIZE];
+	snprintf (name, sizeof (name), "%s/summary.csv", directory);
+	bool is_new = (access (name, F_OK) != 0);
+	FILE* p_summary = fopen (name, "a");
+	if (p_summary == NULL)
+	{
+		perror (name);
+		return;
+	}
+
+	if (is_new)
+	{
+		fputs ("session,finished,duration_s,iterations,moves,measure_s,move_s,"
+			   "adjust_s,runout_before,runout_after,runout_before_mm,runout_after_mm,"
+			   "missing_records\n", p_summary);
+	}
+	fprintf (p_summary, "%u,%d,%.3f,%u,%u,%.3f,%.3f,%.3f,%d,%d,", session_number,
+			 finished ? 1 : 0, seconds, iteration, phase_count[TELEM_PHASE_MOVE],
+			 phase_ms[TELEM_PHASE_MEASURE] / 1000.0, phase_ms[TELEM_PHASE_MOVE] / 1000.0,
+			 phase_ms[TELEM_PHASE_ADJUST] / 1000.0, first_runout, last_runout);
+	if (first_runout >= 0)
+	{
+		fprintf (p_summary, "%.3f,%.3f", first_runout / 1000.0, last_runout / 1000.0);
+	}
+	else
+	{
+		fputc (',', p_summary);
+	}
+	fprintf (p_summary, ",%u\n", missing_records);
+	fclose (p_summary);
+}
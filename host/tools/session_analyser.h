@@ -0,0 +1,140 @@
+//*************************************************************************************
+/** \file session_analyser.h
+ *    This file contains the interface to the analyser which sorts the truing stand's
+ *    telemetry records into sessions, writes each session's data to columnar files
+ *    and works out how each session went.
+ *
+ *    A session starts with the first measuring phase, iteration 0, and ends when the
+ *    stand says the wheel is true. If the stand's clock goes backwards, it has been
+ *    reset, so whatever session was going on is ended as unfinished. For session
+ *    number n, these files are written, each with a header line:
+ *    \li \c session-n-measurements.csv  Time, iteration, average and the reading at
+ *        each spoke, for every pass around the wheel
+ *    \li \c session-n-offsets.csv  Time, iteration, runout and each spoke's offset
+ *    \li \c session-n-radial.csv  Time, iteration, radial runout and each spoke's
+ *        radial offset, if the stand was truing the rim radially too
+ *    \li \c session-n-tensions.csv  Time, iteration, average and each spoke's
+ *        tensiometer reading, if the stand was mapping tensions
+ *    \li \c session-n-phases.csv  End time, phase, iteration and duration of every
+ *        phase which finished
+ *    \li \c session-n-worst.csv  Time, iteration, spoke and offset of the worst spoke
+ *    And one line for each session is added to \c summary.csv.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, telemetry recorder and session analyser
+ *    \li 10-18-26 Radial offsets are written to their own file
+ *    \li 10-18-26 So are spoke tensions
+ *    \li 10-18-26 The stand sends micrometres, so runouts need no scale to be given
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+// This define prevents this .h file from being included multiple times in a .cpp file
+#ifndef _SESSION_ANALYSER_H_
+#define _SESSION_ANALYSER_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include "telemetry_decoder.h"
+
+
+/// The number of phases, counting the unused number 0
+#define ANALYSER_PHASES			(TELEM_PHASE_DONE + 1)
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This class sorts telemetry records into sessions and analyses them.
+ *  \details Records are given to \c add() as they arrive. Each session's summary is
+ *  printed on \c stdout when the session ends, and \c finish() ends the last one when
+ *  there are no more records.
+ */
+
+class session_analyser
+{
+	protected:
+		/// The directory into which the files are written
+		const char* directory;
+
+		/// The number of the session going on, or of the last one
+		uint16_t session_number;
+
+		/// Set while a session is going on
+		bool active;
+
+		/// The files for the session going on
+		FILE* p_measurements;
+		FILE* p_offsets;                    ///< \see p_measurements
+		FILE* p_radial;                     ///< \see p_measurements
+		FILE* p_tensions;                   ///< \see p_measurements
+		FILE* p_phases;                     ///< \see p_measurements
+		FILE* p_worst;                      ///< \see p_measurements
+
+		/// The time of the session's first record and of its last, in milliseconds
+		uint32_t start_ms;
+		uint32_t last_ms;                   ///< \see start_ms
+
+		/// The iteration the stand said it was on most recently
+		uint16_t iteration;
+
+		/// Set when the stand has said the wheel is true
+		bool finished;
+
+		/// The total time spent in each phase, in milliseconds
+		uint32_t phase_ms[ANALYSER_PHASES];
+
+		/// The number of times each phase finished
+		uint16_t phase_count[ANALYSER_PHASES];
+
+		/// The runout from the first and last offset records, or -1 if there weren't any
+		int32_t first_runout;
+		int32_t last_runout;                ///< \see first_runout
+
+		/// The sequence number expected on the next record, or -1 if any will do
+		int16_t next_sequence;
+
+		/// The number of records the sequence numbers show went missing
+		uint32_t missing_records;
+
+		// Start a new session
+		void start (uint32_t time_ms);
+
+		// Open one of a session's files and write its header line
+		FILE* open_file (const char* kind, const char* header, uint8_t num_spokes);
+
+		// Write a row of spoke values to a file, opening the file if needed
+		void write_spokes (FILE** pp_file, const char* kind, const char* extra_name,
+						   const telem_record& record, int32_t extra_value);
+
+		// Find the runout in a record of offsets
+		int32_t spread (const telem_record& record);
+
+		// Print a runout in micrometres and millimetres
+		void print_runout (FILE* p_file, int32_t runout);
+
+	public:
+		// The constructor sets up an analyser which writes into the given directory
+		session_analyser (const char* a_directory);
+
+		// Take in one record
+		void add (const telem_record& record);
+
+		// End the session going on, if there is one, and report on it
+		void finish (void);
+
+		/// Get the number of sessions seen
+		uint16_t get_sessions (void) { return (session_number); }
+};
+
+#endif // _SESSION_ANALYSER_H_
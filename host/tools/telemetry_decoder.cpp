@@ -0,0 +1,146 @@
+//*************************************************************************************
+/** \file telemetry_decoder.cpp
+ *    This file contains the decoder which separates telemetry records from text. See
+ *    \c telemetry_decoder.h for how it works.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, telemetry recorder and session analyser
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include "telemetry_decoder.h"
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This constructor sets up a decoder which hasn't seen anything yet.
+ *  \details Until the first delimiter comes along, everything is taken to be text.
+ */
+
+telemetry_decoder::telemetry_decoder (void)
+{
+	encoded_length = 0;
+	in_record = false;
+	text = '\0';
+	bad_records = 0;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method looks at the next byte from the serial port.
+ *  \details After a bad record, the decoder gets back in step by itself, though the
+ *  text between that record and the next is lost.
+ *  @param byte The byte
+ *  @return What the byte turned out to be; when it's the last byte of a good record
+ *          or a character of text, the record or text can then be got
+ */
+
+telem_result telemetry_decoder::feed (uint8_t byte)
+{
+	if (byte == TELEM_DELIMITER)
+	{
+		if (in_record && encoded_length > 0 && finish_record ())
+		{
+			in_record = false;
+			return (TELEM_RECORD);
+		}
+
+		// If what came before wasn't a good record, the decoder may have started
+		// reading in the middle of one or missed the end of one; either way, this
+		// delimiter is most likely the start of the next record
+		in_record = true;
+		encoded_length = 0;
+		return (TELEM_NOTHING);
+	}
+
+	if (!in_record)
+	{
+		text = (char)byte;
+		return (TELEM_TEXT);
+	}
+
+	// One byte more than fits is kept so that finish_record() sees it's too long
+	if (encoded_length <= TELEM_MAX_ENCODED)
+	{
+		if (encoded_length < TELEM_MAX_ENCODED)
+		{
+			encoded[encoded_length] = byte;
+		}
+		encoded_length++;
+	}
+	return (TELEM_NOTHING);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method decodes and checks the record which has been collected.
+ *  @return True if the record is good, false if it was thrown away
+ */
+
+bool telemetry_decoder::finish_record (void)
+{
+	uint8_t length = 0;
+
+	if (encoded_length <= TELEM_MAX_ENCODED)
+	{
+		length = telem_cobs_decode (encoded, (uint8_t)encoded_length, decoded);
+	}
+
+	if (length < TELEM_HEADER_SIZE + TELEM_CRC_SIZE)
+	{
+		bad_records++;
+		return (false);
+	}
+
+	length -= TELEM_CRC_SIZE;
+	uint16_t crc = (uint16_t)decoded[length] | ((uint16_t)decoded[length + 1] << 8);
+	if (crc != telem_crc16 (decoded, length))
+	{
+		bad_records++;
+		return (false);
+	}
+
+	record.type = decoded[0];
+	record.sequence = decoded[1];
+	record.time_ms = telem_get_uint32 (decoded + 2);
+	record.p_body = decoded + TELEM_HEADER_SIZE;
+	record.body_length = length - TELEM_HEADER_SIZE;
+	return (true);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function gets a 16 bit number from a record body.
+ *  @param p_bytes A pointer to the number's low byte
+ *  @return The number
+ */
+
+int16_t telem_get_int16 (const uint8_t* p_bytes)
+{
+	return ((int16_t)((uint16_t)p_bytes[0] | ((uint16_t)p_bytes[1] << 8)));
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function gets a 32 bit number from a record body.
+ *  @param p_bytes A pointer to the number's low byte
+ *  @return The number
+ */
+
+uint32_t telem_get_uint32 (const uint8_t* p_bytes)
+{
+	return ((uint32_t)p_bytes[0] | ((uint32_t)p_bytes[1] << 8)
+			| ((uint32_t)p_bytes[2] << 16) | ((uint32_t)p_bytes[3] << 24));
+}
@@ -0,0 +1,116 @@
+//*************************************************************************************
+/** \file telemetry_decoder.h
+ *    This file contains the interface to a decoder which separates the binary
+ *    telemetry records the truing stand sends from the text sent along with them on
+ *    the same serial port, and checks each record's CRC. See \c telemetry_frame.h for
+ *    the format of the records.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, telemetry recorder and session analyser
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+// This define prevents this .h file from being included multiple times in a .cpp file
+#ifndef _TELEMETRY_DECODER_H_
+#define _TELEMETRY_DECODER_H_
+
+#include <stdint.h>
+#include "telemetry_frame.h"                // The format of the records
+
+
+/** This enumeration lists what a byte fed to the decoder turned out to be.
+ */
+enum telem_result
+{
+	TELEM_NOTHING,              ///< Part of a record which isn't finished yet
+	TELEM_TEXT,                 ///< A character of text, from \c get_text()
+	TELEM_RECORD                ///< The end of a good record, from \c get_record()
+};
+
+
+/** This structure holds a decoded record which has passed its CRC check.
+ */
+struct telem_record
+{
+	uint8_t type;                   ///< The type of record, such as \c TELEM_STATE
+	uint8_t sequence;               ///< The record's sequence number
+	uint32_t time_ms;               ///< Milliseconds since the stand's scheduler started
+	const uint8_t* p_body;          ///< The record's body, after the header
+	uint8_t body_length;            ///< The number of bytes in the body
+};
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This class separates telemetry records from text.
+ *  \details Bytes from the serial port are fed in one at a time. A record starts and
+ *  ends with a delimiter and is never empty, so two delimiters in a row are the end of
+ *  one record and the start of the next. A record which is too long, won't decode or
+ *  fails its CRC check is counted and thrown away, and the delimiter after it is
+ *  taken to be the start of another record.
+ */
+
+class telemetry_decoder
+{
+	protected:
+		/// The encoded record being collected
+		uint8_t encoded[TELEM_MAX_ENCODED];
+
+		/// The last record which was decoded
+		uint8_t decoded[TELEM_MAX_ENCODED];
+
+		/// How many bytes of the encoded record have been collected
+		uint16_t encoded_length;
+
+		/// Set between the delimiters at the start and end of a record
+		bool in_record;
+
+		/// The last character of text
+		char text;
+
+		/// The last good record
+		telem_record record;
+
+		/// The number of records which were thrown away
+		uint32_t bad_records;
+
+		// Decode and check the record which has been collected
+		bool finish_record (void);
+
+	public:
+		// The constructor sets up a decoder which hasn't seen anything yet
+		telemetry_decoder (void);
+
+		// Look at the next byte from the serial port
+		telem_result feed (uint8_t byte);
+
+		/// Get the character of text which \c feed() found
+		char get_text (void) { return (text); }
+
+		/// Get the record which \c feed() found
+		const telem_record& get_record (void) { return (record); }
+
+		/// Get the number of records which were thrown away
+		uint32_t get_bad_records (void) { return (bad_records); }
+};
+
+
+// Get a 16 bit number from a record body, sent low byte first
+int16_t telem_get_int16 (const uint8_t* p_bytes);
+
+// Get a 32 bit number from a record body, sent low byte first
+uint32_t telem_get_uint32 (const uint8_t* p_bytes);
+
+#endif // _TELEMETRY_DECODER_H_
@@ -0,0 +1,249 @@
+//*************************************************************************************
+/** \file telemetry_recorder.cpp
+ *    This file contains a program for a Linux PC which records and analyses what the
+ *    truing stand sends out of its serial port. The text meant for people is shown on
+ *    the terminal, and the binary telemetry records are sorted into sessions, written
+ *    into columnar files and summarised (see \c session_analyser.h).
+ *
+ *    Usage: \c telemetry_recorder [options] input
+ *    \li \c input  A serial port such as \c /dev/ttyUSB0, the pseudo-terminal of a host
+ *        build run with \c HOST_SERIAL=pty, a file saved earlier, or \c - to read
+ *        from standard input (such as the output of a host build piped in)
+ *    \li \c -d dir  The directory for the session files (default: the current one)
+ *    \li \c -b baud  The baud rate, if the input is a serial port (default 9600)
+ *    \li \c -r file  Also save everything which comes in to a file, which can be
+ *        given as the input later to analyse the same sessions again
+ *    \li \c -q  Don't show the text meant for people
+ *
+ *    Reading stops at the end of a file, when a serial port hangs up, or on Ctrl-C;
+ *    the session going on then is reported as unfinished.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, telemetry recorder and session analyser
+ *    \li 10-18-26 No -k option, as the stand sends micrometres
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>                          // For open()
+#include <signal.h>                         // For catching Ctrl-C
+#include <termios.h>                        // For setting up serial ports
+#include <unistd.h>                         // For read() and getopt()
+#include "telemetry_decoder.h"
+#include "session_analyser.h"
+
+
+/// The number of bytes read from the input at a time
+#define RECORDER_READ_SIZE		256
+
+
+/// Set when Ctrl-C has been pressed, so the program stops reading and reports
+static volatile sig_atomic_t stop_reading = 0;
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function is called when Ctrl-C is pressed.
+ *  @param signal_number The signal which was caught
+ */
+
+static void recorder_stop (int signal_number)
+{
+	stop_reading = 1;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function finds the termios speed for a baud rate.
+ *  @param baud The baud rate
+ *  @return The speed, or \c B0 if the baud rate isn't one a serial port can use
+ */
+
+static speed_t recorder_speed (long baud)
+{
+	switch (baud)
+	{
+		case 9600:   return (B9600);
+		case 19200:  return (B19200);
+		case 38400:  return (B38400);
+		case 57600:  return (B57600);
+		case 115200: return (B115200);
+		default:     return (B0);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function sets up a serial port or pseudo-terminal to pass bytes
+ *  through untouched at the given speed.
+ *  @param file The open port
+ *  @param speed The termios speed
+ *  @return True if the port was set up, false if not
+ */
+
+static bool recorder_set_up_port (int file, speed_t speed)
+{
+	struct termios settings;
+
+	if (tcgetattr (file, &settings) != 0)
+	{
+		return (false);
+	}
+	cfmakeraw (&settings);
+	settings.c_cflag |= CLOCAL | CREAD;
+	settings.c_cc[VMIN] = 1;
+	settings.c_cc[VTIME] = 0;
+	cfsetispeed (&settings, speed);
+	cfsetospeed (&settings, speed);
+
+	return (tcsetattr (file, TCSANOW, &settings) == 0);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function prints how to use the program.
+ *  @param program_name The name the program was run by
+ */
+
+static void recorder_usage (const char* program_name)
+{
+	fprintf (stderr, "Usage: %s [-d dir] [-b baud] [-r raw_file] "
+			 "[-q] input\n"
+			 "  input is a serial port, a pseudo-terminal, a saved file, or - for "
+			 "standard input\n", program_name);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This is the program which records and analyses the stand's output.
+ *  @param argc The number of command line arguments, including the program name
+ *  @param argv The command line arguments
+ *  @return \c EXIT_SUCCESS if the input could be read, \c EXIT_FAILURE if not
+ */
+
+int main (int argc, char** argv)
+{
+	const char* directory = ".";
+	const char* raw_name = NULL;
+	long baud = 9600;
+	bool show_text = true;
+	int option;
+
+	while ((option = getopt (argc, argv, "d:b:r:q")) != -1)
+	{
+		switch (option)
+		{
+			case 'd': directory = optarg; break;
+			case 'b': baud = strtol (optarg, NULL, 10); break;
+			case 'r': raw_name = optarg; break;
+			case 'q': show_text = false; break;
+			default:
+				recorder_usage (argv[0]);
+				return (EXIT_FAILURE);
+		}
+	}
+	if (optind != argc - 1 || recorder_speed (baud) == B0)
+	{
+		recorder_usage (argv[0]);
+		return (EXIT_FAILURE);
+	}
+
+	const char* input_name = argv[optind];
+	int input = STDIN_FILENO;
+	if (strcmp (input_name, "-") != 0)
+	{
+		input = open (input_name, O_RDONLY | O_NOCTTY);
+		if (input < 0)
+		{
+			perror (input_name);
+			return (EXIT_FAILURE);
+		}
+	}
+	if (isatty (input) && !recorder_set_up_port (input, recorder_speed (baud)))
+	{
+		perror (input_name);
+		return (EXIT_FAILURE);
+	}
+
+	FILE* p_raw = NULL;
+	if (raw_name != NULL && (p_raw = fopen (raw_name, "wb")) == NULL)
+	{
+		perror (raw_name);
+		return (EXIT_FAILURE);
+	}
+
+	// Ctrl-C interrupts read() rather than killing the program, so that the session
+	// going on can still be reported
+	struct sigaction action;
+	memset (&action, 0, sizeof (action));
+	action.sa_handler = recorder_stop;
+	sigaction (SIGINT, &action, NULL);
+	sigaction (SIGTERM, &action, NULL);
+
+	telemetry_decoder decoder;
+	session_analyser analyser (directory);
+	uint8_t buffer[RECORDER_READ_SIZE];
+
+	while (!stop_reading)
+	{
+		ssize_t count = read (input, buffer, sizeof (buffer));
+		if (count < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (count <= 0)
+		{
+			break;
+		}
+
+		if (p_raw != NULL)
+		{
+			fwrite (buffer, 1, count, p_raw);
+		}
+
+		for (ssize_t index = 0; index < count; index++)
+		{
+			switch (decoder.feed (buffer[index]))
+			{
+				case TELEM_TEXT:
+					if (show_text)
+					{
+						putchar (decoder.get_text ());
+					}
+					break;
+
+				case TELEM_RECORD:
+					analyser.add (decoder.get_record ());
+					break;
+
+				default:
+					break;
+			}
+		}
+	}
+
+	analyser.finish ();
+	printf ("%u sessions, %u damaged records\n", analyser.get_sessions (),
+			decoder.get_bad_records ());
+
+	if (p_raw != NULL)
+	{
+		fclose (p_raw);
+	}
+	return (EXIT_SUCCESS);
+}
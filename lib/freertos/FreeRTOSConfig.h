@@ -135,16 +135,26 @@
 #define configMINIMAL_STACK_SIZE        ( ( unsigned short ) 100 )
 
 /** This define sets the size of the block of memory from which all dynamically 
- *  allocated memory is allocated -- including task stacks, queues, and whatever the
- *  user's functions need (but not the main system stack). Since the amount of SRAM
- *  available depends on the processor, we'll use a formula to estimate the right
- *  amount of SRAM to use for the RTOS heap. For a 2K chip such as the ATmega32, we
- *  end up using about half of SRAM; for a larger chip, we use about 3/4 of the total 
- *  data memory for the heap. The default from FreeRTOS for the ATmega323 is 2500 
- *  bytes, which seems strange because the data sheets say is only has 2K of SRAM. 
- *  This formula is intended to be altered by the user for different configurations.
- */
-#define configTOTAL_HEAP_SIZE           (1024 + ((((uint32_t)RAMEND - 2143) * 3) / 4 ))
+ *  allocated memory is allocated -- including task control blocks, the stacks of 
+ *  tasks which aren't given a static stack, queues, and whatever the user's functions
+ *  need (but not the main system stack). The truing stand gives all its tasks static
+ *  stacks and builds all its objects in static storage, so the heap only has to hold
+ *  the kernel's own data: a control block for each task, the idle task's stack of 
+ *  \c configMINIMAL_STACK_SIZE bytes, and the queues with their storage. As heap_1 
+ *  never frees anything, this is really a bump arena which is only used at startup.
+ *  A check in \c auto_truing_stand_main.cpp adds up what the tasks and queues take
+ *  and stops the compiler if it doesn't fit; about 790 bytes are needed on the AVR,
+ *  or 870 with the profiling and capture tasks. The amount actually used is printed
+ *  by the stack profiling task when the program is built with \c -DSTACK_PROFILE. 
+ *  The old formula, which used about 3/4 of SRAM for the heap, was:
+ *  \code (1024 + ((((uint32_t)RAMEND - 2143) * 3) / 4 )) \endcode
+ */
+#ifndef GCC_POSIX_HOST
+	#define configTOTAL_HEAP_SIZE       ( ( size_t ) 1024 )
+#else
+	// Control blocks and queues are full of 64-bit pointers in the host build
+	#define configTOTAL_HEAP_SIZE       ( ( size_t ) 3072 )
+#endif
 
 /** This define sets the maximum length of task names, plus one byte for the '\0'
  *  which signifies the end of the string. When set to 8, it allows 7-letter names.
@@ -152,15 +162,20 @@
 #define configMAX_TASK_NAME_LEN         ( 10 )
 
 /** This define enables use of vApplicationIdleHook() to run a task (or a set of
- *  "co-routines", cooperatively scheduled tasks) at the lowest priority.
+ *  "co-routines", cooperatively scheduled tasks) at the lowest priority. The host
+ *  build's port takes each RTOS tick from the idle hook, once every task waits.
  */
-#define configUSE_IDLE_HOOK             0
+#ifndef GCC_POSIX_HOST
+	#define configUSE_IDLE_HOOK         0
+#else
+	#define configUSE_IDLE_HOOK         1
+#endif
 
 /** This define enables the use of vApplicationTickHook(), which runs within the
- *  RTOS tick timer interrupt. Code which does timing tasks can be put here. This
- *  functionality is seldom used.
+ *  RTOS tick timer interrupt. Code which does timing tasks can be put here. The
+ *  truing stand uses it to time presses of the acknowledge button.
  */
-#define configUSE_TICK_HOOK             0
+#define configUSE_TICK_HOOK             1
 
 /** When this define is set to 1, the RTOS tick counter will only be 16 bits in size.
  *  This makes the RTOS tick interrupt a little quicker and saves some memory, but
@@ -189,9 +204,12 @@
 #define configUSE_MUTEXES               1
 
 /** The RAM pointer size on an AVR processor is 16 bits; set it here to shut up a dumb
- *  compiler warning that comes out in tasks.c if the default 32 bits is used. 
+ *  compiler warning that comes out in tasks.c if the default 32 bits is used. The 
+ *  host build's port sets its own pointer size.
  */
-#define portPOINTER_SIZE_TYPE           uint16_t
+#ifndef GCC_POSIX_HOST
+	#define portPOINTER_SIZE_TYPE       uint16_t
+#endif
 
 /** This define is set to 1 in order to allow the use of co-routines, which are a sort
  *  of cooperatively multitasked set of tasks.
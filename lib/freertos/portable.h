@@ -87,6 +87,10 @@
 	#include "portmacro.h"
 #endif
 
+#ifdef GCC_POSIX_HOST
+	#include "../../host/freertos/portmacro.h"
+#endif
+
 #ifdef IAR_MEGA_AVR
 	#include "../portable/IAR/ATMega323/portmacro.h"
 #endif
@@ -172,6 +172,8 @@ signed portBASE_TYPE xQueueAltGenericReceive( xQueueHandle pxQueue, void * const
 signed portBASE_TYPE xQueueIsQueueEmptyFromISR( const xQueueHandle pxQueue ) PRIVILEGED_FUNCTION;
 signed portBASE_TYPE xQueueIsQueueFullFromISR( const xQueueHandle pxQueue ) PRIVILEGED_FUNCTION;
 unsigned portBASE_TYPE uxQueueMessagesWaitingFromISR( const xQueueHandle pxQueue ) PRIVILEGED_FUNCTION;
+signed portBASE_TYPE xQueueSendMultipleToBack( xQueueHandle pxQueue, const void * const pvItems, unsigned portBASE_TYPE uxCount ) PRIVILEGED_FUNCTION;
+unsigned portBASE_TYPE uxQueueReceiveMultiple( xQueueHandle pxQueue, void * const pvBuffer, unsigned portBASE_TYPE uxMaxCount ) PRIVILEGED_FUNCTION;
 void vQueueWaitForMessageRestricted( xQueueHandle pxQueue, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
 unsigned char ucQueueGetQueueNumber( xQueueHandle pxQueue ) PRIVILEGED_FUNCTION;
 void vQueueSetQueueNumber( xQueueHandle pxQueue, unsigned char ucQueueNumber ) PRIVILEGED_FUNCTION;
@@ -1157,6 +1159,131 @@ unsigned portBASE_TYPE uxSavedInterruptStatus;
 }
 /*-----------------------------------------------------------*/
 
+signed portBASE_TYPE xQueueSendMultipleToBack( xQueueHandle pxQueue, const void * const pvItems, unsigned portBASE_TYPE uxCount )
+{
+signed portBASE_TYPE xReturn = errQUEUE_FULL;
+unsigned portBASE_TYPE uxBytes, uxFirstBytes;
+
+	configASSERT( pxQueue );
+	configASSERT( pxQueue->uxItemSize != ( unsigned portBASE_TYPE ) 0U );
+
+	taskENTER_CRITICAL();
+	{
+		if( ( pxQueue->uxLength - pxQueue->uxMessagesWaiting ) >= uxCount )
+		{
+			traceQUEUE_SEND( pxQueue );
+
+			/* Copy the items in as one block, or as two if they run past the
+			end of the queue's storage area. */
+			uxBytes = uxCount * pxQueue->uxItemSize;
+			uxFirstBytes = ( unsigned portBASE_TYPE ) ( pxQueue->pcTail - pxQueue->pcWriteTo );
+			if( uxFirstBytes > uxBytes )
+			{
+				uxFirstBytes = uxBytes;
+			}
+
+			memcpy( ( void * ) pxQueue->pcWriteTo, pvItems, ( unsigned ) uxFirstBytes );
+			pxQueue->pcWriteTo += uxFirstBytes;
+
+			if( uxFirstBytes < uxBytes )
+			{
+				memcpy( ( void * ) pxQueue->pcHead, ( const void * ) ( ( const signed char * ) pvItems + uxFirstBytes ), ( unsigned ) ( uxBytes - uxFirstBytes ) );
+				pxQueue->pcWriteTo = pxQueue->pcHead + ( uxBytes - uxFirstBytes );
+			}
+
+			if( pxQueue->pcWriteTo >= pxQueue->pcTail )
+			{
+				pxQueue->pcWriteTo = pxQueue->pcHead;
+			}
+
+			pxQueue->uxMessagesWaiting += uxCount;
+
+			/* If there was a task waiting for data to arrive on the queue then
+			unblock it now, just as xQueueGenericSend() does. */
+			if( ( uxCount > ( unsigned portBASE_TYPE ) 0 ) && ( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE ) )
+			{
+				if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) == pdTRUE )
+				{
+					portYIELD_WITHIN_API();
+				}
+			}
+
+			xReturn = pdPASS;
+		}
+		else
+		{
+			traceQUEUE_SEND_FAILED( pxQueue );
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+unsigned portBASE_TYPE uxQueueReceiveMultiple( xQueueHandle pxQueue, void * const pvBuffer, unsigned portBASE_TYPE uxMaxCount )
+{
+unsigned portBASE_TYPE uxCount, uxBytes, uxFirstBytes;
+signed char *pcFirst;
+
+	configASSERT( pxQueue );
+	configASSERT( pxQueue->uxItemSize != ( unsigned portBASE_TYPE ) 0U );
+
+	taskENTER_CRITICAL();
+	{
+		uxCount = pxQueue->uxMessagesWaiting;
+		if( uxCount > uxMaxCount )
+		{
+			uxCount = uxMaxCount;
+		}
+
+		if( uxCount > ( unsigned portBASE_TYPE ) 0 )
+		{
+			traceQUEUE_RECEIVE( pxQueue );
+
+			/* pcReadFrom points at the last item read, so the first one to be
+			copied out is the one after it. */
+			pcFirst = pxQueue->pcReadFrom + pxQueue->uxItemSize;
+			if( pcFirst >= pxQueue->pcTail )
+			{
+				pcFirst = pxQueue->pcHead;
+			}
+
+			uxBytes = uxCount * pxQueue->uxItemSize;
+			uxFirstBytes = ( unsigned portBASE_TYPE ) ( pxQueue->pcTail - pcFirst );
+			if( uxFirstBytes > uxBytes )
+			{
+				uxFirstBytes = uxBytes;
+			}
+
+			memcpy( pvBuffer, ( void * ) pcFirst, ( unsigned ) uxFirstBytes );
+			pxQueue->pcReadFrom = pcFirst + uxFirstBytes - pxQueue->uxItemSize;
+
+			if( uxFirstBytes < uxBytes )
+			{
+				memcpy( ( void * ) ( ( signed char * ) pvBuffer + uxFirstBytes ), ( void * ) pxQueue->pcHead, ( unsigned ) ( uxBytes - uxFirstBytes ) );
+				pxQueue->pcReadFrom = pxQueue->pcHead + ( uxBytes - uxFirstBytes ) - pxQueue->uxItemSize;
+			}
+
+			pxQueue->uxMessagesWaiting -= uxCount;
+
+			/* There is now room on the queue, so unblock a task which was
+			waiting to send to it, just as xQueueGenericReceive() does. */
+			if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToSend ) ) == pdFALSE )
+			{
+				if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToSend ) ) == pdTRUE )
+				{
+					portYIELD_WITHIN_API();
+				}
+			}
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	return uxCount;
+}
+/*-----------------------------------------------------------*/
+
 unsigned portBASE_TYPE uxQueueMessagesWaiting( const xQueueHandle pxQueue )
 {
 unsigned portBASE_TYPE uxReturn;
@@ -1197,6 +1197,24 @@ signed portBASE_TYPE xQueueIsQueueEmptyFromISR( const xQueueHandle pxQueue );
 signed portBASE_TYPE xQueueIsQueueFullFromISR( const xQueueHandle pxQueue );
 unsigned portBASE_TYPE uxQueueMessagesWaitingFromISR( const xQueueHandle pxQueue );
 
+/*
+ * xQueueSendMultipleToBack() and uxQueueReceiveMultiple() move a run of items
+ * into or out of a queue inside a single critical section, copying them as one
+ * block (or two, where the run wraps round the end of the queue's storage)
+ * instead of one item and one critical section at a time.  They are meant for
+ * queues of characters, where sending or receiving a line one character at a
+ * time costs far more than copying it.  Neither of them ever blocks, and
+ * neither may be used on a semaphore or mutex or from an ISR.
+ *
+ * xQueueSendMultipleToBack() posts all uxCount items or, if there isn't room
+ * for all of them, none of them and returns errQUEUE_FULL.
+ * uxQueueReceiveMultiple() takes up to uxMaxCount items, as many as there are,
+ * and returns how many it took.  Interrupts are off while the items are
+ * copied, so the runs should be kept short.
+ */
+signed portBASE_TYPE xQueueSendMultipleToBack( xQueueHandle pxQueue, const void * const pvItems, unsigned portBASE_TYPE uxCount );
+unsigned portBASE_TYPE uxQueueReceiveMultiple( xQueueHandle pxQueue, void * const pvBuffer, unsigned portBASE_TYPE uxMaxCount );
+
 
 /*
  * xQueueAltGenericSend() is an alternative version of xQueueGenericSend().
@@ -178,12 +178,17 @@ void frt_task::transition_to (uint8_t new_state)
  *                      (default: configMINIMAL_STACK_SIZE)
  *  @param p_ser_dev Pointer to a serial device (port, radio, SD card, etc.) which can
  *                   be used by this task to communicate (default: NULL)
+ *  @param p_stack_buffer Pointer to a statically allocated array of at least 
+ *                   \c a_stack_size bytes to be used as this task's stack. If it's 
+ *                   \c NULL, the stack is allocated from the FreeRTOS heap 
+ *                   (default: NULL)
  */
 
 frt_task::frt_task (const char* a_name, 
 					unsigned portBASE_TYPE a_priority, 
 					size_t a_stack_size,
-					emstream* p_ser_dev
+					emstream* p_ser_dev,
+					portSTACK_TYPE* p_stack_buffer
 					)
 {
 	// Make sure the user doesn't send an excessively long task name to xTaskCreate()
@@ -197,14 +202,18 @@ frt_task::frt_task (const char* a_name,
 	}
 	temp_name[index] = '\0';
 
-	// Create the task with a call to the RTOS task creation function
-	portBASE_TYPE task_status = xTaskCreate
+	// Create the task with a call to the RTOS task creation function. The generic
+	// version is used so that a stack buffer can be given; if it's NULL, FreeRTOS
+	// gets the stack from its heap just as xTaskCreate() would
+	portBASE_TYPE task_status = xTaskGenericCreate
 		(reinterpret_cast<void(*)(void*)>(_call_static_run_method),  // The run method
 		 (const signed char*)temp_name,                              // Task name
 		 a_stack_size,                                               // Task stack size
 		 this,                                       // Pointer to this frt_task object
 		 a_priority,                                 // Priority for the new task
-		 &handle                                     // The new task's handle
+		 &handle,                                    // The new task's handle
+		 p_stack_buffer,                             // Stack buffer, or NULL for heap
+		 NULL                                        // No MPU memory regions
 		);
 
 	// Save the serial port pointer and the total stack size
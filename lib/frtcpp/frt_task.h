@@ -10,6 +10,7 @@
  *
  *  Revised:
  *    \li 10-21-2012 JRR Original file
+ *    \li 10-18-2026 The top of the stack is kept as wide as a pointer
  *
  *  Credits:
  *    Much of this code uses techniques learned from Amigo software, which is 
@@ -242,10 +243,10 @@ class frt_task
 			/// This is the size of the task's total stack space. 
 			size_t total_stack;
 
-			/** This is a pointer to the top (beginning) of the task's stack. It is
+			/** This is the address of the top (beginning) of the task's stack. It is
 			 *  used when we want to print out the stack for debugging purposes.
 			 */
-			uint16_t top_of_stack;
+			size_t top_of_stack;
 		#endif
 
 		/** This is the state in which the finite state machine of the task is. This
@@ -280,11 +281,12 @@ class frt_task
 	// pointer or reference to an object of this class
 	public:
 		// This constructor creates a FreeRTOS task with the given task run function, 
-		// name, priority, and stack size
+		// name, priority, stack size, and (optionally) statically allocated stack
 		explicit frt_task (const char* a_name, 
 						   unsigned portBASE_TYPE a_priority = 0, 
 						   size_t a_stack_size = configMINIMAL_STACK_SIZE,
-						   emstream* p_ser_dev = NULL);
+						   emstream* p_ser_dev = NULL,
+						   portSTACK_TYPE* p_stack_buffer = NULL);
 
 		/** \cond NO_DOXY 
 		 *  This method is called by the task's static run method which is, in turn,
@@ -582,6 +584,17 @@ class frt_task
 			return (last_created_task_pointer);
 		}
 
+		/** This method returns a pointer to the task which was created just before
+		 *  this one, or \c NULL if this is the first task created. It allows code
+		 *  outside the task classes to walk the linked list of tasks, starting at
+		 *  \c last_created_task_pointer.
+		 *  @return A pointer to the previously created task
+		 */
+		frt_task* get_previous_task (void)
+		{
+			return (prev_task_pointer);
+		}
+
 		/** This method returns the handle of the FreeRTOS task which is inside this
 		 *  object. Advanced users might want to use it to access task manipulation 
 		 *  functions that aren't in this wrapper class or for other creative hacking.
@@ -5,6 +5,7 @@
  *
  *  Revisions:
  *    \li 12-02-2012 JRR Split off from time_stamp.cpp to save memory in machine file
+ *    \li 10-18-2026 The idle task's stack top is cast through size_t
  *
  *  License:
  *    This file is copyright 2012 by JR Ridgely and released under the Lesser GNU 
@@ -43,8 +44,9 @@ void print_task_stacks (emstream* ser_dev)
 	// Now print the stack for the idle task, which isn't user created and so isn't
 	// in the regular task list
 	*ser_dev << ATERM_BOLD << PMS ("Task: IDLE") << ATERM_NORM_INT << endl;
-	hex_dump_memory ((uint8_t*)(portStackTopForTask - configMINIMAL_STACK_SIZE + 1), 
-							(uint8_t*)(portStackTopForTask + 1), ser_dev, true, 0x11);
+	size_t idle_top = (size_t)portStackTopForTask;
+	hex_dump_memory ((uint8_t*)(idle_top - configMINIMAL_STACK_SIZE + 1), 
+							(uint8_t*)(idle_top + 1), ser_dev, true, 0x11);
 }
 
 
@@ -5,6 +5,12 @@
  *
  *  Revised:
  *    \li 10-21-2012 JRR Original file
+ *    \li 10-18-26 Counts of dropped characters and the high water mark; all-or-
+ *        nothing write(); tx_space() and transmit_now() for a console writer task
+ *    \li 10-18-26 write() and read() move whole runs of characters through the
+ *        queue at once; strings go through write() rather than putchar()
+ *    \li 10-18-26 The counts are changed in critical sections, as tasks at any
+ *        priority write to the queue
  *
  *  License:
  *    This file is copyright 2012 by JR Ridgely and released under the Lesser GNU 
@@ -24,6 +30,7 @@
 
 
 #include "frt_text_queue.h"                 // Pull in the base class header file
+#include "task.h"                           // Suspending the scheduler and delays
 
 
 //-------------------------------------------------------------------------------------
@@ -48,6 +55,9 @@ frt_text_queue::frt_text_queue (uint16_t queue_size, emstream* p_ser_dev,
 
 	// Create a FreeRTOS queue object which holds the given number of characters
 	the_queue = xQueueCreate (queue_size, sizeof (char));
+	this->queue_size = queue_size;
+	dropped = 0;
+	high_water = 0;
 
 	// Store the wait time; it will be used when writing to the queue
 	ticks_to_wait = a_wait_time;
@@ -69,24 +79,168 @@ inline bool frt_text_queue::putchar (char a_char)
 	// If the data is successfully put in the queue, return true
 	if (xQueueSendToBack (the_queue, &a_char, ticks_to_wait))
 	{
+		note_level ();
 		return (true);
 	}
 
-	// If we get here, something went wrong (probably a timeout), so return false
+	// If we get here, something went wrong (probably a timeout), so count the
+	// character as dropped and return false
+	count_dropped (1);
 	return (false);
 }
 
 
 //-------------------------------------------------------------------------------------
-/** This method writes a string to the queue. It just calls putchar() lots of times
- *  until a null character ('\0') is encountered. 
+/** This method adds characters which didn't fit to the count of dropped ones, which
+ *  stops at 65535. Tasks of different priorities print into the same queue, so the
+ *  count is changed in a critical section; otherwise a task which preempted another
+ *  part way through could have its characters left out of the count. 
+ *  @param count The number of characters which were thrown away
  */
 
-inline void frt_text_queue::puts (char const* p_str)
+void frt_text_queue::count_dropped (uint16_t count)
 {
-	while (*p_str)
+	portENTER_CRITICAL ();
+	dropped = (dropped > 0xFFFF - count) ? 0xFFFF : dropped + count;
+	portEXIT_CRITICAL ();
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method notes how full the queue is after a character has been put in, so
+ *  that the high water mark can show whether the queue is big enough. Like the count
+ *  of dropped characters, the mark is changed in a critical section. 
+ */
+
+void frt_text_queue::note_level (void)
+{
+	portENTER_CRITICAL ();
+	uint16_t level = uxQueueMessagesWaiting (the_queue);
+
+	if (level > high_water)
+	{
+		high_water = level;
+	}
+	portEXIT_CRITICAL ();
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method writes a run of characters to the queue. If there's room for all of
+ *  them, or room is made within the wait time given to the constructor, they're all
+ *  put in; if not, none of them are, and they're all counted as dropped. Strings and
+ *  line endings printed with \c << come here, so a line never comes out with a hole
+ *  in the middle of it. A run longer than the whole queue is written in pieces which
+ *  each fit. 
+ * 
+ *  The characters are copied in \c FRT_TEXT_QUEUE_CHUNK at a time, each piece in
+ *  one critical section, rather than one at a time with a critical section (and a
+ *  trip through the RTOS's queue code) for each. The scheduler is suspended while
+ *  the pieces go in so that no other task's characters get mixed in with them. If
+ *  the wait time isn't zero, this method mustn't be called with the scheduler
+ *  already suspended unless there's known to be room. 
+ *  @param p_data A pointer to the characters
+ *  @param count The number of characters
+ *  @return True if the characters were put in the queue, false if they didn't fit
+ */
+
+bool frt_text_queue::write (const char* p_data, uint16_t count)
+{
+	if (count > queue_size)
+	{
+		bool all_written = write (p_data, queue_size);
+		return (write (p_data + queue_size, count - queue_size) && all_written);
+	}
+
+	for (portTickType waited = 0; ; waited++)
+	{
+		vTaskSuspendAll ();
+		if (tx_space () >= count)
+		{
+			break;
+		}
+		xTaskResumeAll ();
+
+		if (waited >= ticks_to_wait)
+		{
+			count_dropped (count);
+			return (false);
+		}
+		vTaskDelay (1);
+	}
+
+	while (count > 0)
+	{
+		uint8_t piece = (count > FRT_TEXT_QUEUE_CHUNK) ? FRT_TEXT_QUEUE_CHUNK : count;
+		xQueueSendMultipleToBack (the_queue, p_data, piece);
+		p_data += piece;
+		count -= piece;
+	}
+	note_level ();
+
+	xTaskResumeAll ();
+	return (true);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method takes as many characters as are waiting in the queue, up to the size
+ *  of the buffer given, without waiting for any more to arrive. Like \c write(), it
+ *  copies them \c FRT_TEXT_QUEUE_CHUNK at a time rather than one at a time, so a
+ *  task which empties the queue should use it instead of \c getchar(). 
+ *  @param p_buffer A pointer to the buffer into which the characters are put
+ *  @param max_count The most characters which will fit in the buffer
+ *  @return The number of characters which were taken from the queue
+ */
+
+uint16_t frt_text_queue::read (char* p_buffer, uint16_t max_count)
+{
+	uint16_t count = 0;
+
+	while (count < max_count)
+	{
+		uint8_t piece = (max_count - count > FRT_TEXT_QUEUE_CHUNK)
+						? FRT_TEXT_QUEUE_CHUNK : max_count - count;
+		uint8_t taken = uxQueueReceiveMultiple (the_queue, p_buffer + count, piece);
+
+		count += taken;
+		if (taken < piece)
+		{
+			break;
+		}
+	}
+
+	return (count);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method finds how many more characters will fit in the queue. 
+ *  @return The number of characters which can be written without waiting
+ */
+
+uint16_t frt_text_queue::tx_space (void)
+{
+	return (queue_size - uxQueueMessagesWaiting (the_queue));
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method waits until the task which reads the queue has taken everything out
+ *  of it, then asks the serial device to which that task writes, if one was given to
+ *  the constructor, to finish sending. It should be called before shutting down. 
+ */
+
+void frt_text_queue::transmit_now (void)
+{
+	while (uxQueueMessagesWaiting (the_queue) != 0)
+	{
+		vTaskDelay (1);
+	}
+
+	if (p_serial != NULL)
 	{
-		putchar (*p_str++);
+		p_serial->transmit_now ();
 	}
 }
 
@@ -5,6 +5,11 @@
  *
  *  Revised:
  *    \li 10-21-2012 JRR Original file
+ *    \li 10-18-26 Counts of dropped characters and the high water mark; all-or-
+ *        nothing write(); tx_space() and transmit_now() for a console writer task
+ *    \li 10-18-26 write() and read() move whole runs of characters through the
+ *        queue at once; strings go through write() rather than putchar()
+ *    \li 10-18-26 The counts are changed and read in critical sections
  *
  *  License:
  *    This file is copyright 2012 by JR Ridgely and released under the Lesser GNU 
@@ -31,6 +36,14 @@
 #include "emstream.h"                       // Pull in the base class header file
 
 
+/** This is the most characters \c frt_text_queue::write() and \c read() copy into or
+ *  out of the queue at once. Interrupts are off while a piece is copied, so it's kept
+ *  small enough that they're held off for no more than a few tens of microseconds. 
+ *  It must be no more than 255. 
+ */
+#define FRT_TEXT_QUEUE_CHUNK	32
+
+
 //-------------------------------------------------------------------------------------
 /** \brief This class uses the \c emstream structure and its \c "<<" operator
  *  to convert data to characters and write the characters into a FreeRTOS queue. 
@@ -81,6 +94,14 @@
  *      my_card->putchar (p_text_queue->getchar ());
  *  }
  *  \endcode
+ *  Strings and numbers printed with \c << go into the queue as whole runs through
+ *  \c write(). The receiving task can likewise take whatever is waiting all at once
+ *  with \c read(), which is much quicker than a character at a time:
+ *  \code
+ *  char buffer[32];
+ *  uint16_t count = p_text_queue->read (buffer, sizeof (buffer));
+ *  my_card->write (buffer, count);
+ *  \endcode
  *  The reason that the data was not directly written to the SD card in the sending
  *  task is timing: in this example, we assume that the sending task takes data at
  *  regular intervals. Writing data to an SD card, however, takes varying amounts of
@@ -96,6 +117,15 @@ class frt_text_queue : public emstream
 		xQueueHandle the_queue;             ///< The handle for the queue we use
 		portTickType ticks_to_wait;         ///< RTOS ticks to wait for empty queue
 		emstream* p_serial;                 ///< Serial device used for debugging
+		uint16_t queue_size;                ///< How many characters the queue holds
+		uint16_t dropped;                   ///< Characters which didn't fit
+		uint16_t high_water;                ///< Most characters ever in the queue
+
+		// Note how full the queue is after a character has been put in
+		void note_level (void);
+
+		// Add characters which didn't fit to the count of dropped ones
+		void count_dropped (uint16_t count);
 
 	// Public methods can be called from anywhere in the program where there is a 
 	// pointer or reference to an object of this class
@@ -104,7 +134,15 @@ class frt_text_queue : public emstream
 		frt_text_queue (uint16_t, emstream* = NULL, portTickType = portMAX_DELAY);
 
 		bool putchar (char);					// Write one character to the queue
-		void puts (char const*);				// Write a string constant to queue
+
+		// Write a run of characters, all of them or (if they won't fit) none
+		bool write (const char* p_data, uint16_t count);
+
+		// Take as many characters as are waiting, up to the size of a buffer
+		uint16_t read (char* p_buffer, uint16_t max_count);
+
+		uint16_t tx_space (void);				// Room left in the queue
+		void transmit_now (void);				// Wait until the queue has been sent
 		bool check_for_char (void);			// Check if a character is in the queue
 		int16_t getchar (void);				// Read a character from the queue
 
@@ -127,6 +165,39 @@ class frt_text_queue : public emstream
 		{
 			return (the_queue);
 		}
+
+		/** This method gets the number of characters which have been thrown away
+		 *  because the queue was full. The count stops at 65535. It's read in a
+		 *  critical section, as the AVR reads its two bytes one at a time.
+		 *  @return The number of characters dropped
+		 */
+		uint16_t get_dropped (void)
+		{
+			portENTER_CRITICAL ();
+			uint16_t count = dropped;
+			portEXIT_CRITICAL ();
+			return (count);
+		}
+
+		/** This method gets the most characters there have ever been in the queue,
+		 *  which shows whether the queue is big enough.
+		 *  @return The high water mark, in characters
+		 */
+		uint16_t get_high_water (void)
+		{
+			portENTER_CRITICAL ();
+			uint16_t level = high_water;
+			portEXIT_CRITICAL ();
+			return (level);
+		}
+
+		/** This method gets the number of characters the queue can hold.
+		 *  @return The size of the queue, in characters
+		 */
+		uint16_t get_size (void)
+		{
+			return (queue_size);
+		}
 };
 
 #endif  // _FRT_TEXT_QUEUE_H_
@@ -142,6 +142,16 @@ base232::base232 (char* port_name)
 			 << endl;
 	}
 }
+
+
+/** This constructor uses a file, such as standard output or a pseudo-terminal, which
+ *  has already been opened as the serial port. 
+ *  @param file_descriptor The file descriptor of the open file
+ */
+base232::base232 (int file_descriptor)
+{
+	serial_file = file_descriptor;
+}
 #endif // __AVR
 
 
@@ -112,6 +112,9 @@ class base232
 	#else
 		/// The constructor sets up the port with the given name.
 		base232 (char*);
+
+		/// This constructor uses a file which has already been opened.
+		base232 (int);
 	#endif
 
 		/// This method checks if the serial port is ready to transmit data.
@@ -23,6 +23,10 @@
  *    \li 10-22-2012 JRR Fixed (OK, hacked around) bug which caused spurious warning 
  *                       for all Program Memory Strings
  *    \li 11-12-2012 JRR Made puts() non-virtual; made ENDL_STYLE() a function macro
+ *    \li 10-18-26 Added tx_space() so a caller can see how much fits without waiting
+ *    \li 10-18-26 Added write(); puts() and endl hand whole runs of characters to
+ *                  it rather than sending them a character at a time
+ *    \li 10-18-26 Added puts_P() for program memory strings found through a pointer
  *
  *  License:
  *    This file released under the Lesser GNU Public License, version 2. This program
@@ -87,6 +91,19 @@ bool emstream::ready_to_send (void)
 }
 
 
+//-------------------------------------------------------------------------------------
+/** This function finds how many characters can be sent without having to wait. The
+ *  base method doesn't know, so it says there's no limit; devices which buffer what
+ *  they send override it to report how much room is left in the buffer. 
+ *  @return The number of characters which can be sent without waiting
+ */
+
+uint16_t emstream::tx_space (void)
+{
+	return (0xFFFF);                        // By default there's always room
+}
+
+
 //-------------------------------------------------------------------------------------
 /** This base method just returns zero, because it shouldn't be called. There might be
  *  classes which only send characters and don't ever receive them, and this method
@@ -137,35 +154,101 @@ void emstream::clear_screen (void)
 
 
 //-------------------------------------------------------------------------------------
-/** This method writes a string to the serial device. It just works through the 
- *  character buffer to which its parameter points, calling \c putchar() to print each
- *  character until and end of string character (the null character, \c '\0') is 
- *  reached.
+/** This method writes a run of characters to the serial device. The base method just
+ *  calls \c putchar() for each one; devices which can take a whole run at once, such
+ *  as a queue which would otherwise need a critical section for every character,
+ *  override it to do so. 
+ *  @param p_data A pointer to the characters to be written
+ *  @param count The number of characters
+ *  @return True if all the characters were written, false if any weren't
+ */
+
+bool emstream::write (const char* p_data, uint16_t count)
+{
+	bool all_written = true;
+
+	while (count--)
+	{
+		if (!putchar (*p_data++))
+		{
+			all_written = false;
+		}
+	}
+
+	return (all_written);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method writes a string to the serial device. A string in RAM is handed to
+ *  \c write() all at once; one in program memory, marked with \c PMS(), is written
+ *  by \c puts_P(). 
  *  @param p_string A pointer to the string which is to be printed
  */
 
 void emstream::puts (const char* p_string)
 {
-	char ch;                                // Temporary storage for a character
-
 	// If the program-string variable is set, this string is to be found in program
 	// memory rather than data memory
 	if (pgm_string)
 	{
 		pgm_string = false;
-		while ((ch = pgm_read_byte_near (p_string++)))
-		{
-			putchar (ch);
-		}
+		puts_P (p_string);
 	}
-	// If the program-string variable is not set, the string is in RAM and printed
-	// in the normal way
+	// If the program-string variable is not set, the string is in RAM and can be
+	// written as it is
 	else
 	{
-		while (*p_string)
+		write (p_string, strlen (p_string));
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method writes a string in program memory to the serial device. The string is
+ *  copied out in pieces of \c EMS_PGM_CHUNK characters, each of which is handed to
+ *  \c write(), so as not to need a buffer as long as the string. It's for strings
+ *  which are found through a pointer, such as those in a table, which \c PMS() can't
+ *  mark. If parameters are given, each \c % in the string is replaced by the next
+ *  one, printed as a signed number in the current base; \c %% gives a \c %. 
+ *  @param p_string A pointer to the string, which is in program memory
+ *  @param p_params A pointer to the parameters, or \c NULL if the string has none,
+ *                  in which case a \c % is printed as it is (default: \c NULL)
+ */
+
+void emstream::puts_P (const char* p_string, const int16_t* p_params)
+{
+	char chunk[EMS_PGM_CHUNK];              // Piece of the string copied into RAM
+	uint8_t count = 0;                      // Number of characters in the piece
+	char ch;                                // Temporary storage for a character
+
+	while ((ch = pgm_read_byte_near (p_string++)))
+	{
+		if (ch == '%' && p_params != NULL)
 		{
-			putchar (*p_string++);
+			if (pgm_read_byte_near (p_string) == '%')
+			{
+				p_string++;
+			}
+			else
+			{
+				write (chunk, count);
+				count = 0;
+				*this << *p_params++;
+				continue;
+			}
 		}
+
+		chunk[count++] = ch;
+		if (count == EMS_PGM_CHUNK)
+		{
+			write (chunk, count);
+			count = 0;
+		}
+	}
+	if (count > 0)
+	{
+		write (chunk, count);
 	}
 }
 
@@ -23,6 +23,11 @@
  *    \li 10-22-2012 JRR Fixed (OK, hacked around) bug which caused spurious warning 
  *                       for all Program Memory Strings
  *    \li 11-12-2012 JRR Made puts() non-virtual; made ENDL_STYLE() a function macro
+ *    \li 10-18-26 Added tx_space() so a caller can see how much fits without waiting
+ *    \li 10-18-26 Added write(); puts() and endl hand whole runs of characters to
+ *                  it rather than sending them a character at a time
+ *    \li 10-18-26 Added division-free decimal conversion for the number inserters
+ *    \li 10-18-26 Added puts_P() for program memory strings found through a pointer
  *
  *  License:
  *    This file released under the Lesser GNU Public License, version 2. This program
@@ -97,7 +102,14 @@ extern "C"
  *  \details Different recieving programs want different end-of-line markers. 
  *  Traditionally, UNIX uses "\r" while PC's use "\r\n" and Macs use "\n" (I think). 
  */
-#define ENDL_STYLE()        putchar ('\r'); putchar ('\n')
+#define ENDL_STYLE()        write ("\r\n", 2)
+
+/** \brief This define sets how many characters of a string in program memory are
+ *  copied into RAM at a time to be written.
+ *  \details The piece is kept on the stack of the task doing the printing, so it
+ *  shouldn't be made very large. 
+ */
+#define EMS_PGM_CHUNK       16
 
 
 /** \brief This define selects the character which asks a terminal to clear its screen.
@@ -211,6 +223,12 @@ ser_manipulator setprecision (uint8_t);
 // This variable is used by setprecision() and documented in emstream.cpp
 extern uint8_t bts_glob_prec;
 
+//-------------------------------------------------------------------------------------
+// These functions convert unsigned numbers to decimal text without dividing; they're
+// in emstream_format.cpp and are used by the number inserters
+uint8_t ems_u16_to_dec (uint16_t, char*);
+uint8_t ems_u32_to_dec (uint32_t, char*);
+
 
 // A forward declaration of this class is needed so that pointers to an object of this
 // class can be declared in hex_receiver and worked with in emstream
@@ -457,6 +475,7 @@ class emstream
 	public:
 		emstream (void);            // Simple constructor doesn't do much
 		virtual bool ready_to_send (void);  // Virtual and not defined in base class
+		virtual uint16_t tx_space (void);   // How many characters fit without waiting
 
 		/** This is a pure virtual base method for the \c putchar() method which must
 		 *  be overridden in every descendent of this class. Since \c putchar() has no
@@ -471,6 +490,12 @@ class emstream
 
 		void puts (const char*);            // Write a string to the serial device
 
+		// Write a string in program memory, filling in any parameters
+		void puts_P (const char* p_string, const int16_t* p_params = NULL);
+
+		// Write a run of characters; devices which can take them all at once do so
+		virtual bool write (const char* p_data, uint16_t count);
+
 		virtual bool check_for_char (void); // Check if a character is in the buffer
 		virtual int16_t getchar (void);     // Get a character; wait if none is ready
 		virtual void transmit_now (void);   // Immediately transmit any buffered data
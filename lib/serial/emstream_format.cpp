@@ -0,0 +1,183 @@
+//*************************************************************************************
+/** \file emstream_format.cpp
+ *    This file contains functions which turn unsigned integers into decimal text for
+ *    the \c emstream number inserters. The AVR has no divide instruction, so the
+ *    library's \c utoa() and \c ultoa(), which divide by 10 once for every digit,
+ *    spend most of their time in the software division routine. These functions
+ *    take two digits at a time from a table and get the quotient by 100 with a
+ *    multiplication and a shift, which the AVR's hardware multiplier does quickly.
+ *
+ *  Revised:
+ *    \li 10-18-26 Original file, division-free decimal conversion
+ *
+ *  License:
+ *    This file released under the Lesser GNU Public License, version 2. This program
+ *    is intended for educational use only, but it is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+ *    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ *    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include "emstream.h"
+
+
+/** This table holds the pairs of digits "00" through "99", so that the two digits of
+ *  a number less than 100 are found at twice that number.
+ */
+static const char ems_digit_pairs[200] PROGMEM =
+{
+	'0','0', '0','1', '0','2', '0','3', '0','4', '0','5', '0','6', '0','7', '0','8',
+	'0','9', '1','0', '1','1', '1','2', '1','3', '1','4', '1','5', '1','6', '1','7',
+	'1','8', '1','9', '2','0', '2','1', '2','2', '2','3', '2','4', '2','5', '2','6',
+	'2','7', '2','8', '2','9', '3','0', '3','1', '3','2', '3','3', '3','4', '3','5',
+	'3','6', '3','7', '3','8', '3','9', '4','0', '4','1', '4','2', '4','3', '4','4',
+	'4','5', '4','6', '4','7', '4','8', '4','9', '5','0', '5','1', '5','2', '5','3',
+	'5','4', '5','5', '5','6', '5','7', '5','8', '5','9', '6','0', '6','1', '6','2',
+	'6','3', '6','4', '6','5', '6','6', '6','7', '6','8', '6','9', '7','0', '7','1',
+	'7','2', '7','3', '7','4', '7','5', '7','6', '7','7', '7','8', '7','9', '8','0',
+	'8','1', '8','2', '8','3', '8','4', '8','5', '8','6', '8','7', '8','8', '8','9',
+	'9','0', '9','1', '9','2', '9','3', '9','4', '9','5', '9','6', '9','7', '9','8',
+	'9','9'
+};
+
+/** This table holds the powers of ten from 10^9 down to 10^4, which are subtracted to
+ *  find the digits of a 32-bit number above its last four.
+ */
+static const uint32_t ems_powers_of_ten[] PROGMEM =
+{
+	1000000000UL, 100000000UL, 10000000UL, 1000000UL, 100000UL, 10000UL
+};
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function divides a 16-bit number by 100 without dividing.
+ *  \details As 100 is 4 times 25, the number is shifted right by two places and then
+ *  multiplied by 5243, which is 2^17 / 25 rounded up. The product fits in 32 bits,
+ *  and the result is exact for every 16-bit number.
+ *  @param num The number to be divided
+ *  @return The quotient, rounded down
+ */
+
+static inline uint16_t ems_div_100 (uint16_t num)
+{
+	return ((uint16_t)(((uint32_t)(num >> 2) * 5243) >> 17));
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function copies the two digits of a number less than 100.
+ *  @param p_dest Where to put the two digits
+ *  @param pair The number, from 0 to 99
+ */
+
+static inline void ems_put_pair (char* p_dest, uint8_t pair)
+{
+	const char* p_pair = ems_digit_pairs + 2 * pair;
+
+	p_dest[0] = pgm_read_byte_near (p_pair);
+	p_dest[1] = pgm_read_byte_near (p_pair + 1);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function converts a 16-bit unsigned number to decimal text.
+ *  \details The digits are made two at a time from the right-hand end, then moved to
+ *  the front of the buffer. The text gives the same result as \c utoa() in base 10.
+ *  @param num The number to be converted
+ *  @param p_str A buffer for the text, at least 6 characters long
+ *  @return The number of digits, not counting the null character at the end
+ */
+
+uint8_t ems_u16_to_dec (uint16_t num, char* p_str)
+{
+	char digits[5];                         // Digits, built up from the right
+	char* p_digit = digits + sizeof (digits);
+	uint16_t quotient;
+	uint8_t length;
+
+	while (num >= 100)
+	{
+		quotient = ems_div_100 (num);
+		p_digit -= 2;
+		ems_put_pair (p_digit, (uint8_t)(num - quotient * 100));
+		num = quotient;
+	}
+	if (num >= 10)
+	{
+		p_digit -= 2;
+		ems_put_pair (p_digit, (uint8_t)num);
+	}
+	else
+	{
+		*--p_digit = '0' + (uint8_t)num;
+	}
+
+	length = (uint8_t)(digits + sizeof (digits) - p_digit);
+	for (uint8_t index = 0; index < length; index++)
+	{
+		p_str[index] = p_digit[index];
+	}
+	p_str[length] = '\0';
+
+	return (length);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function converts a 32-bit unsigned number to decimal text.
+ *  \details A number which fits in 16 bits is handed to \c ems_u16_to_dec(). For a
+ *  larger one, each digit above the last four is found by counting how many times
+ *  its power of ten can be subtracted, at most nine subtractions a digit; what is
+ *  left is less than 10000, and its four digits are made as two pairs. The text gives
+ *  the same result as \c ultoa() in base 10.
+ *  @param num The number to be converted
+ *  @param p_str A buffer for the text, at least 11 characters long
+ *  @return The number of digits, not counting the null character at the end
+ */
+
+uint8_t ems_u32_to_dec (uint32_t num, char* p_str)
+{
+	if (num <= 0xFFFF)
+	{
+		return (ems_u16_to_dec ((uint16_t)num, p_str));
+	}
+
+	char* p_char = p_str;
+	bool leading = true;                    // Still skipping zeros at the front
+
+	for (uint8_t index = 0; index < sizeof (ems_powers_of_ten) / sizeof (uint32_t);
+		 index++)
+	{
+		uint32_t power = pgm_read_dword (ems_powers_of_ten + index);
+		char digit = '0';
+
+		while (num >= power)
+		{
+			num -= power;
+			digit++;
+		}
+		if (digit != '0' || !leading)
+		{
+			*p_char++ = digit;
+			leading = false;
+		}
+	}
+
+	// A number over 0xFFFF has at least one digit above the last four, so all four
+	// of these are printed, zeros included
+	uint16_t low = (uint16_t)num;
+	uint16_t high = ems_div_100 (low);
+	ems_put_pair (p_char, (uint8_t)high);
+	ems_put_pair (p_char + 2, (uint8_t)(low - high * 100));
+	p_char += 4;
+	*p_char = '\0';
+
+	return ((uint8_t)(p_char - p_str));
+}
@@ -6,6 +6,7 @@
  *  Revised:
  *    \li 12-02-2012 JRR Split this file off from the main \c emstream.cpp to
  *                       allow smaller machine code if stuff in this file isn't used
+ *    \li 10-18-26 Decimal numbers are converted without dividing
  *
  *  License:
  *    This file released under the Lesser GNU Public License, version 2. This program
@@ -45,10 +46,18 @@ emstream& emstream::operator<< (int16_t num)
 	}
 	else
 	{
-		char out_str[17];
+		char out_str[7];
+		uint8_t length = 0;
 
-		itoa (num, out_str, base);
-		puts (out_str);
+		// The magnitude is worked out unsigned so that -32768 comes out right
+		uint16_t magnitude = (uint16_t)num;
+		if (num < 0)
+		{
+			out_str[length++] = '-';
+			magnitude = 0 - magnitude;
+		}
+		length += ems_u16_to_dec (magnitude, out_str + length);
+		write (out_str, length);
 	}
 
 	return (*this);
@@ -6,6 +6,7 @@
  *  Revised:
  *    \li 12-02-2012 JRR Split this file off from the main \c emstream.cpp to
  *                       allow smaller machine code if stuff in this file isn't used
+ *    \li 10-18-26 Decimal numbers are converted without dividing
  *
  *  License:
  *    This file released under the Lesser GNU Public License, version 2. This program
@@ -45,9 +46,19 @@ emstream& emstream::operator<< (int32_t num)
 	}
 	else
 	{
-		char out_str[34];
-		ltoa ((long)num, out_str, base);
-		puts (out_str);
+		char out_str[12];
+		uint8_t length = 0;
+
+		// The magnitude is worked out unsigned so that the most negative number
+		// comes out right
+		uint32_t magnitude = (uint32_t)num;
+		if (num < 0)
+		{
+			out_str[length++] = '-';
+			magnitude = 0 - magnitude;
+		}
+		length += ems_u32_to_dec (magnitude, out_str + length);
+		write (out_str, length);
 	}
 
 	return (*this);
@@ -6,6 +6,7 @@
  *  Revised:
  *    \li 12-02-2012 JRR Split this file off from the main \c emstream.cpp to
  *                       allow smaller machine code if stuff in this file isn't used
+ *    \li 10-18-26 Decimal numbers are converted without dividing
  *
  *  License:
  *    This file released under the Lesser GNU Public License, version 2. This program
@@ -41,8 +42,6 @@
 
 emstream& emstream::operator<< (int8_t num)
 {
-	char out_str[5];
-
 	if (print_ascii)
 	{
 		putchar (num);
@@ -51,8 +50,16 @@ emstream& emstream::operator<< (int8_t num)
 	{
 		if (base == 10)
 		{
-			itoa ((int)num, out_str, 10);
-			puts (out_str);
+			char out_str[7];
+			uint8_t length = 0;
+
+			if (num < 0)
+			{
+				out_str[length++] = '-';
+			}
+			length += ems_u16_to_dec ((num < 0) ? -(int16_t)num : num,
+									  out_str + length);
+			write (out_str, length);
 		}
 		else
 		{
@@ -6,6 +6,7 @@
  *  Revised:
  *    \li 12-02-2012 JRR Split this file off from the main \c emstream.cpp to
  *                       allow smaller machine code if stuff in this file isn't used
+ *    \li 10-18-26 Decimal numbers are converted without dividing
  *
  *  License:
  *    This file released under the Lesser GNU Public License, version 2. This program
@@ -49,6 +50,11 @@ emstream& emstream::operator<< (uint32_t num)
 		parts.whole = num;
 		*this << parts.bits[3] << parts.bits[2] << parts.bits[1] << parts.bits[0];
 	}
+	else if (base == 10)
+	{
+		char out_str[11];
+		write (out_str, ems_u32_to_dec (num, out_str));
+	}
 	else
 	{
 		char out_str[33];
@@ -6,6 +6,7 @@
  *  Revised:
  *    \li 12-02-2012 JRR Split this file off from the main \c emstream.cpp to
  *                       allow smaller machine code if stuff in this file isn't used
+ *    \li 10-18-26 Decimal numbers are converted without dividing
  *
  *  License:
  *    This file released under the Lesser GNU Public License, version 2. This program
@@ -62,6 +63,11 @@ emstream& emstream::operator<< (uint8_t num)
 		temp_char = num & 0x0F;
 		putchar ((temp_char > 9) ? temp_char + ('A' - 10) : temp_char + '0');
 	}
+	else if (base == 10)
+	{
+		char out_str[6];
+		write (out_str, ems_u16_to_dec (num, out_str));
+	}
 	else
 	{
 		char out_str[9];
@@ -23,6 +23,7 @@
  *    \li 07-05-2008 JRR Changed from 1 to 2 stop bits to placate finicky receivers
  *    \li 12-22-2008 JRR Split off stuff in base232.h for efficiency
  *    \li 06-30-2009 JRR Received data interrupt and buffer added
+ *    \li 10-18-26 Transmitter interrupt and buffer added
  *
  *  License:
  *		This file is copyright 2012 by JR Ridgely and released under the Lesser GNU 
@@ -47,8 +48,9 @@
 
 
 // Every AVR has at least one serial port, so enable at least one receiver buffer
-/// This buffer holds characters received through serial port 0 by the ISR. 
-uint8_t* rcv0_buffer = NULL;
+/// This buffer holds characters received through serial port 0 by the ISR. It is 
+/// statically allocated so that creating a port doesn't use any heap memory
+uint8_t rcv0_buffer[RSINT_BUF_SIZE];
 
 /// This index is used to write into serial character receiver buffer 0.
 uint16_t rcv0_read_index;
@@ -59,7 +61,7 @@ uint16_t rcv0_write_index;
 // If there's a UCSR0A register, there are 2 serial ports, so enable another buffer
 #ifdef UCSR1A
 	/// This buffer holds characters received through serial port 1 by the ISR. 
-	uint8_t* rcv1_buffer = NULL;
+	uint8_t rcv1_buffer[RSINT_BUF_SIZE];
 
 	/// This index is used to write into serial character receiver buffer 1.
 	uint16_t rcv1_read_index;
@@ -68,6 +70,33 @@ uint16_t rcv0_write_index;
 	uint16_t rcv1_write_index;
 #endif
 
+/// This buffer holds characters waiting to be sent through serial port 0 by the ISR
+uint8_t tx0_buffer[RSINT_TX_BUF_SIZE];
+
+/// This index is used by the ISR to read from serial transmitter buffer 0.
+volatile uint8_t tx0_read_index;
+
+/// This index is used to write into serial transmitter buffer 0.
+volatile uint8_t tx0_write_index;
+
+#ifdef UCSR1A
+	/// This buffer holds characters waiting to be sent through serial port 1
+	uint8_t tx1_buffer[RSINT_TX_BUF_SIZE];
+
+	/// This index is used by the ISR to read from serial transmitter buffer 1.
+	volatile uint8_t tx1_read_index;
+
+	/// This index is used to write into serial transmitter buffer 1.
+	volatile uint8_t tx1_write_index;
+#endif
+
+// The data register empty interrupt enable bit is in the same place for every port
+#if defined UCSR0A
+	#define RSI_UDRIE_MASK		(1 << UDRIE0)
+#else
+	#define RSI_UDRIE_MASK		(1 << UDRIE)
+#endif
+
 
 //-------------------------------------------------------------------------------------
 /** This method sets up the AVR UART for communications.  It calls the emstream
@@ -88,6 +117,11 @@ rs232::rs232 (uint16_t baud_rate, uint8_t port_number)
 	// Save the number of the serial port, 0 or 1
 	port_num = port_number;
 
+	// Transmitter buffer 0 is used unless port 1 is chosen and exists
+	p_tx_buffer = tx0_buffer;
+	p_tx_read = &tx0_read_index;
+	p_tx_write = &tx0_write_index;
+
 	// If we're compiling for a chip with UCSR0A defined, it has dual serial ports
 	// (examples are ATmega324P and ATmega128). Set up Port 0 or Port 1
 	#if defined UCSR0A // Serial port number 0
@@ -95,8 +129,7 @@ rs232::rs232 (uint16_t baud_rate, uint8_t port_number)
 		{
 			UCSR0B |= (1 << RXCIE0);		// Receive complete interrupt enable
 
-			// Allocate some memory for the receiver buffer and reset the indices
-			rcv0_buffer = new uint8_t[RSINT_BUF_SIZE];
+			// Reset the indices of the statically allocated receiver buffer
 			rcv0_read_index = 0;
 			rcv0_write_index = 0;
 		}
@@ -105,10 +138,14 @@ rs232::rs232 (uint16_t baud_rate, uint8_t port_number)
 		#if defined UCSR1A
 			UCSR1B |= (1 << RXCIE1);		// Receive complete interrupt enable
 
-			// Allocate some memory for the receiver buffer and reset the indices
-			rcv1_buffer = new uint8_t[RSINT_BUF_SIZE];
+			// Reset the indices of the statically allocated receiver buffer
 			rcv1_read_index = 0;
 			rcv1_write_index = 0;
+
+			// Use transmitter buffer 1 instead of buffer 0
+			p_tx_buffer = tx1_buffer;
+			p_tx_read = &tx1_read_index;
+			p_tx_write = &tx1_write_index;
 		#endif // UCSR1A
 		}
 	// We're compiling for a chip which doesn't define UCSR0A; assume it has only one
@@ -116,12 +153,15 @@ rs232::rs232 (uint16_t baud_rate, uint8_t port_number)
 	#else
 		UCSRB |= (1 << RXCIE);				// Receive complete interrupt enable
 
-		// Allocate some memory for the receiver buffer and reset the indices
-		rcv0_buffer = new uint8_t[RSINT_BUF_SIZE];
+		// Reset the indices of the statically allocated receiver buffer
 		rcv0_read_index = 0;
 		rcv0_write_index = 0;
 	#endif
 
+	// Empty the transmitter buffer which this port uses
+	*p_tx_read = 0;
+	*p_tx_write = 0;
+
 	// The Xiphos 1.0 board may need the pullup activated on the RXD1 line in order to
 	// use the XBee radio module
 	#ifdef XIPHOS_HACKS
@@ -132,38 +172,159 @@ rs232::rs232 (uint16_t baud_rate, uint8_t port_number)
 
 
 //-------------------------------------------------------------------------------------
-/** This method sends one character to the serial port.  It waits until the port is
- *  ready, so it can hold up the system for a while.  It times out if it waits too 
- *  long to send the character; you can check the return value to see if the character
- *  was successfully sent, or just cross your fingers and ignore the return value.
- *  Note 1:  It's possible that at slower baud rates and/or higher processor speeds, 
- *  this routine might time out even when the port is working fine.  A solution would
- *  be to change the count variable to an integer and use a larger starting number. 
- *  Note 2:  Fixed!  The count is now an integer and it works at lower baud rates.
+/** This method puts a character into the transmitter buffer if there's room for it
+ *  and makes sure the data register empty interrupt is enabled so that it will be
+ *  sent. Interrupts are held off for a moment so that the ISR, or another task using
+ *  the same port, doesn't change the buffer in the middle. 
  *  @param chout The character to be sent out
- *  @return True if everything was OK and false if there was a timeout
+ *  @return True if the character was put in the buffer, false if the buffer was full
  */
 
-bool rs232::putchar (char chout)
+bool rs232::tx_put (char chout)
+{
+	uint8_t saved_sreg = SREG;
+	cli ();
+
+	uint8_t next_index = *p_tx_write + 1;
+	if (next_index >= RSINT_TX_BUF_SIZE)
+		next_index = 0;
+
+	if (next_index == *p_tx_read)
+	{
+		SREG = saved_sreg;
+		return (false);
+	}
+
+	p_tx_buffer[*p_tx_write] = chout;
+	*p_tx_write = next_index;
+	*p_UCR |= RSI_UDRIE_MASK;
+
+	SREG = saved_sreg;
+	return (true);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method sends the oldest character in the transmitter buffer by waiting for
+ *  the data register to be empty, just as the ISR would have done. It is only used
+ *  when interrupts are off, so that the ISR can't run and the buffer would otherwise
+ *  never empty. If the port doesn't become ready in time, the character is dropped.
+ */
+
+void rs232::tx_poll (void)
 {
-	// Now wait for the serial port transmitter buffer to be empty	 
 	for (uint16_t count = 0; ((*p_USR & mask_UDRE) == 0); count++)
 	{
 		if (count > UART_TX_TOUT)
-			return (false);
+			break;
 	}
 
-	// Clear the TXCn bit so it can be used to check if the serial port is busy.  This
-	// check needs to be done prior to putting the processor into sleep mode.  Oddly,
-	// the TXCn bit is cleared by writing a one to its bit location
+	// Clear the TXCn bit (by writing a one to it) so that it shows when we're done
 	*p_USR |= mask_TXC;
+	*p_UDR = p_tx_buffer[*p_tx_read];
+
+	uint8_t next_index = *p_tx_read + 1;
+	if (next_index >= RSINT_TX_BUF_SIZE)
+		next_index = 0;
+	*p_tx_read = next_index;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method sends one character to the serial port. The character is put into the
+ *  transmitter buffer and sent in the background by the data register empty ISR, so
+ *  this method only waits if the buffer is full. It times out if it waits too long;
+ *  you can check the return value to see if the character was successfully queued,
+ *  or just cross your fingers and ignore the return value. If interrupts are off, as
+ *  they are before the scheduler starts, room is made by sending characters from the
+ *  buffer by polling. 
+ *  @param chout The character to be sent out
+ *  @return True if everything was OK and false if there was a timeout
+ */
+
+bool rs232::putchar (char chout)
+{
+	for (uint16_t count = 0; !tx_put (chout); count++)
+	{
+		if ((SREG & (1 << SREG_I)) == 0)
+			tx_poll ();
+		else if (count > UART_TX_TOUT)
+			return (false);
+	}
 
-	// The CTS line is 0 and the transmitter buffer is empty, so send the character
-	*p_UDR = chout;
 	return (true);
 }
 
 
+//-------------------------------------------------------------------------------------
+/** This method sends one character to the serial port only if it can do so without
+ *  waiting. A task which can't afford to wait uses it to find out that the port is
+ *  backed up, and can then skip or put off what it was going to print. 
+ *  @param chout The character to be sent out
+ *  @return True if the character was queued, false if the transmitter buffer was full
+ */
+
+bool rs232::try_putchar (char chout)
+{
+	return (tx_put (chout));
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method finds how many more characters will fit in the transmitter buffer. A
+ *  task can check this before printing a line to be sure the line won't hold it up.
+ *  @return The number of characters which can be sent without waiting
+ */
+
+uint16_t rs232::tx_space (void)
+{
+	uint8_t saved_sreg = SREG;
+	cli ();
+	uint8_t read_index = *p_tx_read;
+	uint8_t write_index = *p_tx_write;
+	SREG = saved_sreg;
+
+	if (write_index >= read_index)
+		return (RSINT_TX_BUF_SIZE - 1 - (write_index - read_index));
+	else
+		return (read_index - write_index - 1);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method checks if a character can be sent without waiting, which is the case
+ *  whenever there's room for it in the transmitter buffer. 
+ *  @return True if the serial port is ready to send, and false if not
+ */
+
+bool rs232::ready_to_send (void)
+{
+	return (tx_space () != 0);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method waits until every character in the transmitter buffer has been sent
+ *  and the last one has left the USART. It should be called before shutting down or
+ *  putting the processor to sleep, or the end of the output may be lost. 
+ */
+
+void rs232::transmit_now (void)
+{
+	while (*p_tx_read != *p_tx_write)
+	{
+		if ((SREG & (1 << SREG_I)) == 0)
+			tx_poll ();
+	}
+
+	for (uint16_t count = 0; ((*p_USR & mask_TXC) == 0); count++)
+	{
+		if (count > UART_TX_TOUT)
+			break;
+	}
+}
+
+
 //-------------------------------------------------------------------------------------
 /** This method gets one character from the serial port, if one is there.  If not, it
  *  waits until there is a character available.  This can sometimes take a long time
@@ -266,6 +427,40 @@ ISR (RSI_CHAR_RECV_INT_0)
 }
 
 
+//-------------------------------------------------------------------------------------
+/** This interrupt service routine runs whenever the data register of the first serial
+ *  port (number 0) is empty and its interrupt is enabled. It sends the next character
+ *  from the transmitter buffer or, if there isn't one, turns itself off until 
+ *  \c tx_put() has another character to send.
+ */
+
+ISR (RSI_DATA_EMPTY_INT_0)
+{
+	if (tx0_read_index == tx0_write_index)
+	{
+		#if defined UCSR0A
+			UCSR0B &= ~(1 << UDRIE0);
+		#else
+			UCSRB &= ~(1 << UDRIE);
+		#endif
+	}
+	else
+	{
+		// Clear the TXCn bit (by writing a one to it) so that it shows when we're done
+		#if defined UCSR0A
+			UCSR0A |= (1 << TXC0);
+			UDR0 = tx0_buffer[tx0_read_index];
+		#else
+			UCSRA |= (1 << TXC);
+			UDR = tx0_buffer[tx0_read_index];
+		#endif
+
+		if (++tx0_read_index >= RSINT_TX_BUF_SIZE)
+			tx0_read_index = 0;
+	}
+}
+
+
 #ifdef UCSR1A // The second ISR is only compiled for processors with dual serial ports
 	//-------------------------------------------------------------------------------------
 	/** This interrupt service routine runs whenever a character has been received by the
@@ -288,5 +483,28 @@ ISR (RSI_CHAR_RECV_INT_0)
 			if (++rcv1_read_index >= RSINT_BUF_SIZE)
 				rcv1_read_index = 0;
 	}
+
+
+	//-------------------------------------------------------------------------------------
+	/** This interrupt service routine runs whenever the data register of the second
+	*  serial port (number 1) is empty and its interrupt is enabled. It sends the next
+	*  character from the transmitter buffer or turns itself off if there isn't one.
+	*/
+
+	ISR (RSI_DATA_EMPTY_INT_1)
+	{
+		if (tx1_read_index == tx1_write_index)
+		{
+			UCSR1B &= ~(1 << UDRIE1);
+		}
+		else
+		{
+			UCSR1A |= (1 << TXC1);
+			UDR1 = tx1_buffer[tx1_read_index];
+
+			if (++tx1_read_index >= RSINT_TX_BUF_SIZE)
+				tx1_read_index = 0;
+		}
+	}
 #endif // Dual serial ports
 /** \endcond  (End of section which is not to be documented by Doxygen) */
@@ -23,6 +23,7 @@
  *    \li 07-05-2008 JRR Changed from 1 to 2 stop bits to placate finicky receivers
  *    \li 12-22-2008 JRR Split off stuff in base232.h for efficiency
  *    \li 06-30-2009 JRR Received data interrupt and buffer added
+ *    \li 10-18-26 Transmitter interrupt and buffer added
  *
  *  License:
  *		This file is copyright 2012 by JR Ridgely and released under the Lesser GNU 
@@ -73,6 +74,19 @@
 	#endif
 #endif
 
+// In the same way, define the transmitter data register empty interrupt for each port
+#if defined USART_UDRE_vect
+	#define RSI_DATA_EMPTY_INT_0 USART_UDRE_vect
+#elif defined USART0_UDRE_vect
+	#define RSI_DATA_EMPTY_INT_0 USART0_UDRE_vect
+#else
+	#error Unable to determine data register empty interrupt vector for this chip
+#endif
+
+#if defined UCSR1A
+	#define RSI_DATA_EMPTY_INT_1 USART1_UDRE_vect
+#endif
+
 /** This is the size of the buffer which holds characters received by the serial port.
  *  It is usually set to something fairly large (~100 bytes) so that we don't miss
  *  incoming characters. However, when run on an AVR with very little RAM such as an
@@ -81,6 +95,13 @@
  */
 #define RSINT_BUF_SIZE		32
 
+/** This is the size of the buffer which holds characters waiting to be sent by the
+ *  serial port. A full line of text or a whole telemetry record should fit, so that a
+ *  task can send one and get on with its work while it goes out in the background. 
+ *  It must be no more than 255. 
+ */
+#define RSINT_TX_BUF_SIZE	128
+
 
 //-------------------------------------------------------------------------------------
 /** \brief This class controls a UART (Universal Asynchronous Receiver Transmitter), 
@@ -97,8 +118,15 @@
  *  are placed in a buffer whose size is configurable with the macro \c RSINT_BUF_SIZE.
  *  Calls to \c getchar() will check the buffer for received characters. This method,
  *  as opposed to polling the receiver without using interrupts, allows much higher
- *  data rates to be reliably supported in a multitasking program. Sending of 
- *  characters is currently not interrupt based. 
+ *  data rates to be reliably supported in a multitasking program. 
+ * 
+ *  Characters sent are put in another buffer, of size \c RSINT_TX_BUF_SIZE, and the
+ *  USART's data register empty interrupt sends them out one by one, so \c putchar()
+ *  only has to wait when the buffer is full. A task which mustn't wait at all can
+ *  check \c tx_space() or use \c try_putchar(), which gives up at once if there's no
+ *  room. Before shutting down or sleeping, \c transmit_now() waits until everything
+ *  has gone out. If interrupts are off when the buffer fills up, as they are before
+ *  the RTOS scheduler starts, the oldest characters are sent by polling instead. 
  * 
  *  \section Usage
  *  To create and use a serial port driver object requires only code such as the
@@ -121,6 +149,16 @@ class rs232 : public emstream, public base232
 	protected:
 		uint8_t port_num;					///< The USART number, 0 or 1
 
+		uint8_t* p_tx_buffer;				///< This port's transmitter buffer
+		volatile uint8_t* p_tx_read;		///< Where the ISR takes characters out
+		volatile uint8_t* p_tx_write;		///< Where characters are put in
+
+		// Put a character into the transmitter buffer if there's room for it
+		bool tx_put (char);
+
+		// Send the oldest character in the transmitter buffer by polling
+		void tx_poll (void);
+
 	// Public methods can be called from anywhere in the program where there is a 
 	// pointer or reference to an object of this class
 	public:
@@ -130,6 +168,13 @@ class rs232 : public emstream, public base232
 		// This method writes one character to the serial port.
 		bool putchar (char);
 
+		// This method writes a character only if it can be done without waiting
+		bool try_putchar (char);
+
+		uint16_t tx_space (void);			// Room left in the transmitter buffer
+		bool ready_to_send (void);			// Check for room for one character
+		void transmit_now (void);			// Wait until everything has been sent
+
 		bool check_for_char (void);			// Check if a character is in the buffer
 		int16_t getchar (void);				// Get a character; wait if none is ready
 		void clear_screen (void);			// Send the 'clear display screen' code
@@ -6,6 +6,17 @@
 *
 *  Revisions:
 *    \li 02-15-13 HL, TJ, & SG Methods for data collection and analysis.
+*    \li 10-18-26 Progress messages carry the spoke numbers they were sent with
+*    \li 10-18-26 Measuring gives up early if the session is aborted
+*    \li 10-18-26 Measurements start where the wheel is and end at a planned spoke
+*    \li 10-18-26 Filtered readings of the spoke being adjusted, for the live gauge
+*    \li 10-18-26 The rim's radial position can be measured along with its sideways one
+*    \li 10-18-26 Spoke tensions can be read in the same sweep
+*    \li 10-18-26 Pot readings are turned into micrometres by their calibrations
+*    \li 10-18-26 The wheel can be homed, so spokes are numbered from the index mark
+*    \li 10-18-26 Waiting for the wheel sleeps a tick at a time instead of spinning
+*    \li 10-18-26 Measuring stops if the number of spokes is changed
+*    \li 10-18-26 The count is kept in an int8_t with up to MAX_SPOKES spokes
 *
 *  License:
 *    This file is copyright 2013 by Hamilton Little, Trevor Jones and Sean Green 
@@ -29,6 +40,7 @@
 #include "rs232int.h"                       // Include header for serial port class
 #include "mastermind.h"                 // Include header for the mastermind class
 #include "shares.h"
+#include "spoke_counter.h"              // For renumbering the spokes
 
 //-------------------------------------------------------------------------------------
 /** \brief Constructor for the mastermind object. 
@@ -38,52 +50,226 @@
  * 		function to each of this object's methods.
  *  @param  p_serial_port a serial port to allow the object to say stuff
  *  @param  ptr_to_pot the potentiometer to get measurements from
+ *  @param  p_rim_cal the calibration of the pot which reads the rim's sideways
+ * 			position, or NULL to give its readings in A/D counts (default: NULL)
+ *  @param  p_hop_cal the calibration of the second pot, or NULL likewise
  */
-mastermind::mastermind(emstream* p_serial_port, pot_driver* ptr_to_pot) {
+mastermind::mastermind(emstream* p_serial_port, pot_driver* ptr_to_pot,
+					   pot_calibration* p_rim_cal, pot_calibration* p_hop_cal) {
 	
 	// Initialize class variables
 	ptr_to_serial = p_serial_port;
 	pot = ptr_to_pot;
+	rim_cal = p_rim_cal;
+	hop_cal = p_hop_cal;
+	gauge_sum = 0;
+}
+
+//-------------------------------------------------------------------------------------
+/** \brief Reads a pot and turns its reading into micrometres.
+ *  @param  p_cal the pot's calibration, or NULL to give the reading as it is
+ *  @param  channel the pot's A/D channel
+ *  @return the rim's position, in micrometres if the pot has a calibration
+ */
+int16_t mastermind::position(pot_calibration* p_cal, uint8_t channel) {
+	int16_t reading = (int16_t)(pot->get_value(channel));
+	
+	return (p_cal == NULL) ? reading : p_cal->to_microns(reading);
 }
 
 //-------------------------------------------------------------------------------------
 /** \brief Measure each of the spokes' pot readings and stores them in the given param. 
- *  \details This takes the reading from the potentiometer for each spoke and saves
- * 				it in the given meas array.
+ *  \details The wheel is measured in one forward turn from wherever it already is,
+ * 				rather than going back to spoke 0 first. It's backed up MEAS_RUN_UP
+ * 				spokes, then turned forward past every spoke once, reading each one
+ * 				as it goes by, and on at least MEAS_RUN_OUT spokes more until
+ * 				end_spoke is at the sensor. If the spoke to adjust next was guessed
+ * 				right, the wheel is already there when the measuring is done. If the
+ * 				user aborts the session while this is going on, or changes the
+ * 				number of spokes, it stops where it is and the readings are
+ * 				incomplete. If an array is given for them, the second pot's readings
+ * 				of the rim's radial position are taken at the same time, and
+ * 				likewise the tensiometer's readings of each spoke's tension. The
+ * 				pots' readings are in micrometres, if they have calibrations; the
+ * 				tensiometer's are A/D counts. The spoke count is looked at once a
+ * 				tick, and the task sleeps in between, so the others get to run.
  *  @param  meas the array to save the pot readings into.
+ *  @param  end_spoke the spoke the wheel is to stop at once the measuring is done
+ *  @param  radial the array to save the radial readings into, or NULL to leave them
+ *  @param  tension the array to save the tension readings into, or NULL to leave them
  *  @return the given array, so methods can be chain called.
  */
-int16_t *mastermind::measure_all(int16_t meas[]){
+int16_t *mastermind::measure_all(int16_t meas[], uint8_t end_spoke, int16_t* radial,
+								 int16_t* tension){
 	int8_t prev_spoke = -127;  // set this to something we should never reach
+	int8_t first, last;        // the counts at which the first and last spokes are read
+	int16_t stop;              // the count at which the wheel stops at the end
+	int8_t now = spoke_count;
+	uint8_t spokes = max_spokes;  // the number of spokes it's measured with
+	
+	// renumber the spokes so that the wheel is on the turn before spoke 0's first
+	// turn, or the count would go up by a turn every time the wheel is measured. The
+	// count from there, through a turn of measuring and up to a turn to the end
+	// spoke, is under first + 2 * max_spokes + MEAS_RUN_OUT, which fits in an
+	// int8_t, as mastermind.h checks
+	spoke_counter_shift((int8_t)(now - spoke_index(now) + max_spokes));
+	first = spoke_count;
+	last = first + max_spokes - 1;
 
-	// go back -10 to eliminate torque on wheel problem
-	desired_spoke = -10;
-	while(spoke_count != desired_spoke) {	
+	// back up to eliminate torque on wheel problem
+	desired_spoke = first - MEAS_RUN_UP;
+	while(spoke_count != desired_spoke && !abort_session && max_spokes == spokes) {
 		if(prev_spoke != spoke_count) {	
-			to_ui->put(GO_BACK);		// tell the user what spoke when it changes
 			prev_spoke = spoke_count;
+			// tell the user what spoke when it changes
+			to_ui->put(GO_BACK, spoke_index(prev_spoke), spoke_index(desired_spoke));
 		}
+		vTaskDelay(1);
 	}
 	
-	// go 10 past the last spoke to eliminate torque on wheel problem
-	desired_spoke = max_spokes+10;
+	// go on past the last spoke, so we aren't slowing down while reading it, to the
+	// spoke we're to stop at
+	stop = (int16_t)last + MEAS_RUN_OUT;
+	stop += ((int16_t)end_spoke - stop % max_spokes + max_spokes) % max_spokes;
+	desired_spoke = (int8_t)stop;
 	prev_spoke = -127;				// set this to something we should never reach
-	while(spoke_count != desired_spoke) {	
+	while(spoke_count != desired_spoke && !abort_session && max_spokes == spokes) {
 		if(prev_spoke != spoke_count){
-			to_ui->put(PRINT_SPOKE);	// tell the user what spoke when it changes
+			prev_spoke = spoke_count;
 		
 			// take a reading each time we pass a spoke
-			if(spoke_count >= 0 && spoke_count <= max_spokes) {
-				meas[spoke_count] = (int16_t)(pot->get_value(0));
+			int16_t reading = 0;
+			if(prev_spoke >= first && prev_spoke <= last) {
+				reading = position(rim_cal, RIM_CHANNEL);
+				meas[spoke_index(prev_spoke)] = reading;
+				if(radial != NULL) {
+					radial[spoke_index(prev_spoke)] = position(hop_cal, HOP_CHANNEL);
+				}
+				if(tension != NULL) {
+					tension[spoke_index(prev_spoke)] = 
+						(int16_t)(pot->get_value(TENSION_CHANNEL));
+				}
 			}
-			prev_spoke = spoke_count;
+			
+			// tell the user what spoke when it changes
+			to_ui->put(PRINT_SPOKE, spoke_index(prev_spoke), end_spoke, reading);
 		}
+		vTaskDelay(1);
 	}
 	
-	desired_spoke = max_spokes;		// go back to the last spoke (we are now past it)
 	return meas;
 }
 
+//-------------------------------------------------------------------------------------
+/** \brief Finds which spoke is at the sensor when the spoke count is at a given value.
+ *  \details The count goes up and down by one for each spoke that goes by, so the same
+ * 			spoke comes round again every max_spokes counts.
+ *  @param  count a value of the spoke count
+ *  @return the spoke, from 0 to max_spokes - 1
+ */
+uint8_t mastermind::spoke_index(int8_t count) {
+	while(count < 0) {
+		count += max_spokes;
+	}
+	while(count >= max_spokes) {
+		count -= max_spokes;
+	}
+	return (uint8_t)count;
+}
+
+//-------------------------------------------------------------------------------------
+/** \brief Finds the value of the spoke count nearest the wheel's position at which the
+ * 			given spoke is at the sensor.
+ *  \details The wheel can go either way round, so it never has to turn more than half
+ * 			a turn to get to any spoke.
+ *  @param  spoke the spoke to go to, from 0 to max_spokes - 1
+ *  @return the count to set desired_spoke to
+ */
+int8_t mastermind::nearest(uint8_t spoke) {
+	int8_t now = spoke_count;
+	int8_t ahead = (int8_t)spoke - (int8_t)spoke_index(now);
+	
+	if(ahead > (int8_t)(max_spokes / 2)) {
+		ahead -= max_spokes;
+	}
+	else if(ahead < -(int8_t)(max_spokes / 2)) {
+		ahead += max_spokes;
+	}
+	return now + ahead;
+}
+
+//-------------------------------------------------------------------------------------
+/** \brief Turns the wheel to the given spoke by the shortest way, and waits until it
+ * 			gets there or the user aborts the session, looking once a tick.
+ *  @param  spoke the spoke to go to, from 0 to max_spokes - 1
+ */
+void mastermind::go_to(uint8_t spoke) {
+	int8_t now = spoke_count;
+	
+	// the wheel is put on its first turn, so a run of moves can't take the count
+	// past the end of an int8_t
+	spoke_counter_shift((int8_t)(now - spoke_index(now)));
+	desired_spoke = nearest(spoke);
+	while(spoke_count != desired_spoke && !abort_session) {
+		vTaskDelay(1);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+/** \brief Turns the wheel forward until the spoke counter has learned the index mark,
+ * 			then numbers the spokes from it and stops.
+ *  \details The counter learns the spoke spacing from the first few spokes and the
+ * 			mark once it's been seen in the same place twice, so it takes about two
+ * 			turns. The wheel is sent a turn ahead, and a turn further each time it
+ * 			gets through one, the count being kept on its first turn as it is
+ * 			while going to a spoke.
+ *  @return true if spoke 0 is now the first spoke after the mark, false if no mark
+ * 			was found in \c HOME_MAX_TURNS turns or the session was aborted
+ */
+bool mastermind::home(void) {
+	int16_t travelled = max_spokes;	// how many spokes it's been sent forward by
+	
+	desired_spoke = spoke_count + max_spokes;
+	while(!spoke_counter_home()) {
+		if(abort_session || travelled >= HOME_MAX_TURNS * (int16_t)max_spokes) {
+			desired_spoke = spoke_count;
+			return false;
+		}
+		if(spoke_count >= (int8_t)max_spokes || spoke_count == desired_spoke) {
+			if(spoke_count >= (int8_t)max_spokes) {
+				spoke_counter_shift(max_spokes);
+			}
+			desired_spoke = spoke_count + max_spokes;
+			travelled += max_spokes;
+		}
+		vTaskDelay(1);
+	}
+	
+	desired_spoke = spoke_count;
+	return true;
+}
+
+//-------------------------------------------------------------------------------------
+/** \brief Starts the live gauge off at the reading where the wheel now is.
+ *  \details Starting the filter at a real reading, rather than at zero, means the
+ * 			gauge doesn't have to climb up to it over the first few readings.
+ */
+void mastermind::gauge_start(void) {
+	gauge_sum = (int32_t)position(rim_cal, RIM_CHANNEL) << GAUGE_FILTER_SHIFT;
+}
+
+//-------------------------------------------------------------------------------------
+/** \brief Takes a reading of the spoke at the sensor for the live gauge.
+ *  \details The reading is filtered by a running average, which is done with shifts
+ * 			rather than division and keeps the pot's noise from making the gauge
+ * 			jump about.
+ *  @return the filtered reading
+ */
+int16_t mastermind::gauge_read(void) {
+	gauge_sum += position(rim_cal, RIM_CHANNEL) - (gauge_sum >> GAUGE_FILTER_SHIFT);
+	return (int16_t)(gauge_sum >> GAUGE_FILTER_SHIFT);
+}
+
 //-------------------------------------------------------------------------------------
 /** \brief Converts the given meas array into offset values based on the avg param. 
  *  \details This overwrites the values in the meas array, converting them from the 
@@ -106,18 +292,20 @@ int16_t *mastermind::con_to_offs(int16_t meas[], int16_t avg) {
 //-------------------------------------------------------------------------------------
 /** \brief Finds the highest value in offs. 
  *  \details Compares the absolute values of the data in the given array, and returns 
- * 			the index (spoke) where the highest value resides.
+ * 			the index (spoke) where the highest value resides. One spoke can be left
+ * 			out, such as the one being adjusted, to guess which will be worst next.
  *  @param  offs the array of offset values
+ *  @param  skip a spoke to leave out, or -1 to look at them all (default: -1)
  *  @return the spoke whose offset value is the highest (worst)
  */
-uint8_t mastermind::find_worst(int16_t offs[]) {
+uint8_t mastermind::find_worst(int16_t offs[], int8_t skip) {
 	uint8_t ndx, worst_spoke;
 	int16_t worst_val;
 	
-	worst_spoke = 0;
+	worst_spoke = (skip == 0) ? 1 : 0;
 	worst_val = ABS(offs[worst_spoke]);
 	for(ndx = 0; ndx < max_spokes; ++ndx) {
-		if(ABS(offs[ndx]) > worst_val) {
+		if((int8_t)ndx != skip && ABS(offs[ndx]) > worst_val) {
 			worst_spoke = ndx;
 			worst_val = ABS(offs[ndx]);
 		}
@@ -6,6 +6,13 @@
 *
 *  Revisions:
 *    \li 02-15-13 HL, TJ, & SG Methods for data collection and analysis.
+*    \li 10-18-26 Measurements start where the wheel is and end at a planned spoke
+*    \li 10-18-26 Filtered readings of the spoke being adjusted, for the live gauge
+*    \li 10-18-26 The rim's radial position can be measured along with its sideways one
+*    \li 10-18-26 Spoke tensions can be read in the same sweep
+*    \li 10-18-26 Pot readings are turned into micrometres by their calibrations
+*    \li 10-18-26 The wheel can be homed, so spokes are numbered from the index mark
+*    \li 10-18-26 MAX_SPOKES is checked against the counts a measurement runs to
 *
 *  License:
 *    This file is copyright 2013 by Hamilton Little, Trevor Jones and Sean Green 
@@ -33,8 +40,49 @@
 #include "queue.h"                          // Header for FreeRTOS queues
 #include "semphr.h"                         // Header for FreeRTOS semaphores
 #include "pot_driver.h"
+#include "pot_calibration.h"                // Pot readings to micrometres
+#include "wheel_limits.h"                   // The most spokes a wheel can have
 
 
+/** This is how many spokes the wheel is backed up before a measurement, so that it's
+ *  going steadily forward by the time it reaches the first spoke to be read. 
+ */
+#define MEAS_RUN_UP			10
+
+/** This is how many spokes at least the wheel goes on past the last spoke read, so
+ *  that it isn't slowing down while the last spokes are read. 
+ */
+#define MEAS_RUN_OUT		10
+
+// A measurement starts the count on the turn before spoke 0's, backs up MEAS_RUN_UP
+// spokes, and goes on to under 2 * max_spokes + MEAS_RUN_OUT spokes further, all of
+// which must fit in the int8_t spoke count
+#if MAX_SPOKES + MEAS_RUN_UP > 127 || 2 * MAX_SPOKES + MEAS_RUN_OUT > 128
+	#error "MAX_SPOKES is too many for the spoke count to measure a wheel"
+#endif
+
+/** The live gauge's readings are filtered by a running average which takes each new
+ *  reading 1 / 2^GAUGE_FILTER_SHIFT of the way in, smoothing the pot's noise. 
+ */
+#define GAUGE_FILTER_SHIFT	2
+
+/// The A/D channel of the pot which reads the rim's sideways position
+#define RIM_CHANNEL			0
+
+/// The A/D channel of the second pot, which reads the rim's radial position
+#define HOP_CHANNEL			1
+
+/// The A/D channel of the tensiometer, which reads the tension of the spoke at it
+#define TENSION_CHANNEL		2
+
+/** This is true if the second pot's reading goes up as the rim moves out, away from
+ *  the hub, and false if it goes down. Tightening any spoke pulls the rim in.
+ */
+#define HOP_OUT_READS_HIGHER	true
+
+/// How many turns the wheel is turned looking for the index mark before giving up
+#define HOME_MAX_TURNS		3
+
 
 //-------------------------------------------------------------------------------------
 /** \brief Implements the data collection and analysis functionality needed.
@@ -53,19 +101,51 @@ class mastermind
 			
 			/// Mastermind uses this pot to get wheel measurements at each spoke
 			pot_driver* pot;
+			
+			/// The calibration of the pot which reads the rim's sideways position
+			pot_calibration* rim_cal;
+			
+			/// The calibration of the second pot, which reads its radial position
+			pot_calibration* hop_cal;
+			
+			/// The live gauge's filtered reading, times 2^GAUGE_FILTER_SHIFT
+			int32_t gauge_sum;
+			
+			// read a pot and turn the reading into micrometres
+			int16_t position(pot_calibration*, uint8_t channel);
 
       public:
             // constructor for the object
-            mastermind(emstream*, pot_driver*);
+            mastermind(emstream*, pot_driver*, pot_calibration* = NULL,
+					   pot_calibration* = NULL);
             
-			// gets measurements for all spokes
-			int16_t* measure_all(int16_t[]);
+			// gets measurements for all spokes, stopping at the given spoke
+			int16_t* measure_all(int16_t[], uint8_t end_spoke, int16_t* radial = NULL,
+								 int16_t* tension = NULL);
 			
 			// convert measurements to offsets
 			int16_t* con_to_offs(int16_t[], int16_t avg);
 			
-			// find the worst offset spoke
-			uint8_t find_worst(int16_t[]);
+			// find the worst offset spoke, leaving out one spoke if asked to
+			uint8_t find_worst(int16_t[], int8_t skip = -1);
+			
+			// find which spoke is at a given count
+			uint8_t spoke_index(int8_t count);
+			
+			// find the count nearest the wheel at which a spoke is at the sensor
+			int8_t nearest(uint8_t spoke);
+			
+			// go to a spoke by the shortest way
+			void go_to(uint8_t spoke);
+			
+			// turn the wheel until the spokes can be numbered from the index mark
+			bool home(void);
+			
+			// start the live gauge's filter off at the reading where the wheel is
+			void gauge_start(void);
+			
+			// take a reading for the live gauge and give the filtered reading
+			int16_t gauge_read(void);
 			
 			// find the average of the measurements taken
 			int16_t find_avg(int16_t[]);
@@ -7,6 +7,8 @@
 *
 *  Revisions:
 *    \li 03-13-13 HL, TJ, & SG PI control scheme implemented
+*    \li 10-18-26 position and desired position are read together
+*    \li 10-18-26 stops with the spoke at the sensor; integrator cleared on arrival
 * 
 *  License:
 *    This file is copyright 2013 by Hamilton Little, Trevor Jones and Sean Green 
@@ -73,19 +75,31 @@ pos_controller::pos_controller(emstream *p_serial_port, motordriver *md, uint8_t
 * 		but now we let the RTOS handle its scheduling.
 */
 void pos_controller::update() {
-	int8_t pos_act = spoke_count;
-	int8_t pos_des = desired_spoke;
+	int8_t pos_act, pos_des;
+	bool at_spoke;
 	int32_t KI_control = 0, KP_control = 0;
 	int16_t control = 0;
-	int8_t e = pos_des - pos_act;
 	
-	// motor braking if we are at desired spoke
+	// read them all at once, as the spokes may be renumbered in between
+	portENTER_CRITICAL();
+	pos_act = spoke_count;
+	at_spoke = spoke_at_sensor;
+	pos_des = desired_spoke;
+	portEXIT_CRITICAL();
+	
+	// the error is in half spokes, so that the wheel stops with the spoke itself at
+	// the sensor rather than anywhere in the gap after it
+	int16_t e = 2 * (int8_t)(pos_des - pos_act) - (at_spoke ? 0 : 1);
+	
+	// motor braking if we are at desired spoke; the integrator starts again, so it
+	// doesn't carry the wheel on past
 	if(!e) {
 		motor->set_power(0);
+		esum = 0;
 	} 
 	else {
-		// Integrator control, with limiting
-		if(ABS(e) <= limit) {
+		// Integrator control, with limiting; the limit is in whole spokes
+		if(ABS(e) <= 2 * limit) {
 			
 			// integrator clamping
 			if(esum + e > 127) {
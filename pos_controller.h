@@ -7,6 +7,7 @@
 *
 *  Revisions:
 *    \li 03-13-13 HL, TJ, & SG PI control scheme implemented
+*    \li 10-18-26 gains can be changed while the controller is running
 * 
 *  License:
 *    This file is copyright 2013 by Hamilton Little, Trevor Jones and Sean Green 
@@ -37,6 +38,12 @@
 #include "motordriver.h"
 
 
+/// The proportional gain the position controller starts out with
+#define POS_KP_DEFAULT		200
+
+/// The integral gain the position controller starts out with
+#define POS_KI_DEFAULT		25
+
 
 //-------------------------------------------------------------------------------------
 /** \brief PI control scheme to control the position of the wheel.
@@ -78,6 +85,15 @@ class pos_controller
 		// update the motor actuation
 		void update();
 		
+		/** \brief Changes the proportional and integral gains.
+		 *  @param KP_input Proportional gain
+		 *  @param KI_input Integral gain
+		 */
+		void set_gains(uint8_t KP_input, uint8_t KI_input) {
+			KP = KP_input;
+			KI = KI_input;
+		}
+		
 		
 }; // end of class pos_controller
 
@@ -0,0 +1,202 @@
+//*************************************************************************************
+/** \file pot_calibration.cpp
+ *    This file contains the calibration of a potentiometer to micrometres. See
+ *    \c pot_calibration.h for how the table is used and made.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, pots calibrated to micrometres
+ *    \li 10-18-26 The check value is the one all EEPROM records share
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include <stddef.h>                         // For offsetof()
+#include <avr/eeprom.h>                     // For keeping the tables
+#include "eeprom_record.h"                  // For the tables' check values
+#include "pot_calibration.h"
+
+
+/// The calibration tables, one for each A/D channel, kept in EEPROM
+static cal_table EEMEM saved_tables[CAL_CHANNELS];
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This constructor loads the pot's table from EEPROM.
+ *  \details If the table there is damaged, or was never saved, the pot is taken to
+ *  be uncalibrated.
+ *  @param a_channel The A/D channel of the pot, less than \c CAL_CHANNELS
+ */
+
+pot_calibration::pot_calibration (uint8_t a_channel)
+{
+	channel = (a_channel < CAL_CHANNELS) ? a_channel : 0;
+	eeprom_read_block (&table, &saved_tables[channel], sizeof (table));
+	if (table.count < 2 || table.count > CAL_MAX_POINTS
+		|| table.check != eeprom_record_crc (&table, offsetof (cal_table, check)))
+	{
+		set_default ();
+	}
+	pending.count = 0;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method sets up the table for a pot which hasn't been calibrated.
+ *  \details It's two points, at the ends of the A/D converter's range, with the
+ *  middle at zero.
+ */
+
+void pot_calibration::set_default (void)
+{
+	table.count = 2;
+	table.counts[0] = 0;
+	table.microns[0] = -CAL_CENTER * CAL_MICRONS_PER_COUNT;
+	table.counts[1] = 1023;
+	table.microns[1] = (1023 - CAL_CENTER) * CAL_MICRONS_PER_COUNT;
+	table.check = eeprom_record_crc (&table, offsetof (cal_table, check));
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method turns a pot's reading into micrometres.
+ *  \details The segment of the table the reading falls in is found, or the first
+ *  or last if it's off the end, and the reading is put on the line through the ends
+ *  of that segment. The points are so few that they're just searched in order.
+ *  @param reading The A/D reading
+ *  @return The position in micrometres
+ */
+
+int16_t pot_calibration::to_microns (int16_t reading)
+{
+	uint8_t upper = 1;
+
+	while (upper < table.count - 1 && reading > table.counts[upper])
+	{
+		upper++;
+	}
+
+	int32_t span = table.counts[upper] - table.counts[upper - 1];
+	int32_t rise = table.microns[upper] - table.microns[upper - 1];
+	int32_t microns = table.microns[upper - 1]
+					  + (rise * (reading - table.counts[upper - 1])) / span;
+
+	if (microns > 0x7FFF)
+	{
+		return (0x7FFF);
+	}
+	if (microns < -0x7FFF)
+	{
+		return (-0x7FFF);
+	}
+	return ((int16_t)microns);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method starts making a new table, with no points.
+ */
+
+void pot_calibration::begin (void)
+{
+	pending.count = 0;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method adds a point to the table being made.
+ *  \details The points are kept in order of their readings by putting each new one
+ *  in its place. A point whose reading is the same as another's replaces it, as
+ *  it's most likely the same position measured again.
+ *  @param reading The pot's reading at the known position
+ *  @param microns The known position, in micrometres
+ *  @return True if the point was added, false if the table is full
+ */
+
+bool pot_calibration::add_point (int16_t reading, int16_t microns)
+{
+	uint8_t place = 0;
+
+	while (place < pending.count && pending.counts[place] < reading)
+	{
+		place++;
+	}
+	if (place < pending.count && pending.counts[place] == reading)
+	{
+		pending.microns[place] = microns;
+		return (true);
+	}
+	if (pending.count >= CAL_MAX_POINTS)
+	{
+		return (false);
+	}
+
+	for (uint8_t index = pending.count; index > place; index--)
+	{
+		pending.counts[index] = pending.counts[index - 1];
+		pending.microns[index] = pending.microns[index - 1];
+	}
+	pending.counts[place] = reading;
+	pending.microns[place] = microns;
+	pending.count++;
+
+	return (true);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method checks the table being made, and if it's good, uses it and
+ *  saves it in EEPROM.
+ *  \details A good table has at least two points, and its micrometres go all up or
+ *  all down as the readings go up; otherwise some position would have two readings,
+ *  which means a point was entered wrong.
+ *  @return True if the table was good and has been saved, false if not
+ */
+
+bool pot_calibration::save (void)
+{
+	if (pending.count < 2)
+	{
+		return (false);
+	}
+
+	bool rising = (pending.microns[1] > pending.microns[0]);
+	for (uint8_t index = 1; index < pending.count; index++)
+	{
+		if (pending.microns[index] == pending.microns[index - 1]
+			|| (pending.microns[index] > pending.microns[index - 1]) != rising)
+		{
+			return (false);
+		}
+	}
+
+	pending.check = eeprom_record_crc (&pending, offsetof (cal_table, check));
+	table = pending;
+	eeprom_update_block (&table, &saved_tables[channel], sizeof (table));
+	pending.count = 0;
+
+	return (true);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method goes back to the uncalibrated scale, and saves that.
+ */
+
+void pot_calibration::clear (void)
+{
+	set_default ();
+	eeprom_update_block (&table, &saved_tables[channel], sizeof (table));
+	pending.count = 0;
+}
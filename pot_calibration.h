@@ -0,0 +1,127 @@
+//*************************************************************************************
+/** \file pot_calibration.h
+ *    This file contains the calibration of a potentiometer, which turns its A/D
+ *    readings into micrometres of rim movement. The table it works from is made by
+ *    reading the pot at a few known positions, such as against shims of known
+ *    thickness, and is kept in EEPROM so that it's there after the power is cut.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, pots calibrated to micrometres
+ *    \li 10-18-26 The check value is the one all EEPROM records share
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+// This define prevents this .h file from being included multiple times in a .cpp file
+#ifndef _POT_CALIBRATION_H_
+#define _POT_CALIBRATION_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+
+
+/// The most points a calibration table can have
+#define CAL_MAX_POINTS		8
+
+/// How many pots have a calibration table kept in EEPROM, one for each A/D channel
+/// from 0 up
+#define CAL_CHANNELS		2
+
+/** How many micrometres one count is taken to be before a pot has been calibrated.
+ *  It's what a pot mounted as the stand was designed for gives.
+ */
+#define CAL_MICRONS_PER_COUNT	50
+
+/// The reading taken to be the middle of a pot's travel before it's been calibrated
+#define CAL_CENTER			512
+
+/// How many readings are averaged for each calibration point, to get rid of noise
+#define CAL_READINGS		16
+
+
+/** This structure is a calibration table as it's kept in EEPROM. The points are in
+ *  order of their readings, and the micrometres go all one way, up or down, with
+ *  them. The check value tells a table which was saved from an erased EEPROM.
+ */
+struct cal_table
+{
+	uint8_t count;                          ///< How many points there are
+	int16_t counts[CAL_MAX_POINTS];         ///< Each point's A/D reading
+	int16_t microns[CAL_MAX_POINTS];        ///< Each point's position, micrometres
+	uint16_t check;                         ///< CRC of everything above
+};
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This class turns a pot's readings into micrometres, from a piecewise linear
+ *  table, and makes the table from readings taken at known positions.
+ *  \details Between two points of the table, a reading is turned into micrometres by
+ *  drawing a straight line between them; past the first or last point, the line
+ *  through the two nearest points is carried on. So a pot which isn't quite linear,
+ *  or is mounted further from the rim than the stand was designed for, still gives
+ *  the right distance, and tolerances in micrometres mean the same on every stand.
+ *
+ *  Until a pot has been calibrated, or if the table in EEPROM is damaged, it's taken
+ *  to be \c CAL_MICRONS_PER_COUNT micrometres a count either side of its middle.
+ *
+ *  While a new table is being made, the old one is still used; the new one takes
+ *  over only once it's been checked and saved.
+ */
+
+class pot_calibration
+{
+	protected:
+		/// The A/D channel of the pot, which is also where its table is in EEPROM
+		uint8_t channel;
+
+		/// The table in use
+		cal_table table;
+
+		/// The table being made
+		cal_table pending;
+
+		// Set up the table for a pot which hasn't been calibrated
+		void set_default (void);
+
+	public:
+		// The constructor loads the pot's table from EEPROM
+		pot_calibration (uint8_t a_channel);
+
+		// Turn a reading into micrometres
+		int16_t to_microns (int16_t reading);
+
+		// Start making a new table
+		void begin (void);
+
+		// Add a point to the table being made
+		bool add_point (int16_t reading, int16_t microns);
+
+		// Check the new table, and use and save it if it's good
+		bool save (void);
+
+		// Go back to the uncalibrated scale and save that
+		void clear (void);
+
+		/// Get the A/D channel of the pot
+		uint8_t get_channel (void) { return (channel); }
+
+		/// Get how many points the table in use has
+		uint8_t get_count (void) { return (table.count); }
+
+		/// Get how many points the table being made has
+		uint8_t get_pending (void) { return (pending.count); }
+};
+
+#endif // _POT_CALIBRATION_H_
@@ -6,6 +6,7 @@
  *
  *  Revisions:
 *    \li 03-13-13 HL, TJ, & SG pot_driver is a wrapper for ADC on the board
+*    \li 10-18-26 readings go into the capture log
  *
  *  License:
  *    This file is copyright 2013 by Hamilton Little, Trevor Jones and Sean Green 
@@ -28,6 +29,7 @@
 
 #include "rs232int.h"                       // Include header for serial port class
 #include "pot_driver.h"                            // Include header for the A/D class
+#include "event_log.h"                     // Capture log, when built with EVENT_CAPTURE
 
 //-------------------------------------------------------------------------------------
 /** \brief This constructor sets up a pot_driver. 
@@ -70,6 +72,8 @@ uint16_t pot_driver::get_value (uint8_t ch)
 	// dummy watchDog variable forces return in case of hanging conversion
 	for(uint16_t watchDog = 0; watchDog < 65535 && ADCSRA & (1<<ADSC); watchDog++) ;
 	
+	EVENT_LOG_ADC(ch, ADC);
+	
 	return((uint16_t)ADC);		// return conversion result (10 bit res, right justified)
 }
 
@@ -0,0 +1,265 @@
+//*************************************************************************************
+/** \file route_planner.cpp
+ *    This file contains a planner which picks the spokes to be adjusted before the
+ *    wheel is measured again and the order to visit them in. See \c route_planner.h
+ *    for how they're picked and ordered.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, several spokes adjusted between measurements
+ *    \li 10-18-26 Tolerances in micrometres, which can be bigger than a byte
+ *    \li 10-18-26 A spoke at the sensor comes first whichever way the rest are visited
+ *    \li 10-18-26 Spoke sets for wheels of up to MAX_SPOKES spokes
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include "route_planner.h"
+
+
+/// This macro finds the size of an offset
+#define PLAN_SIZE(x) ((x) < 0 ? (-(x)) : (x))
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This constructor makes an empty plan.
+ */
+
+route_planner::route_planner (void)
+{
+	count = 0;
+	planned = 0;
+	travel = 0;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method plans which spokes to adjust before the wheel is measured again
+ *  and the order in which to go to them.
+ *  @param offsets Each spoke's offset from the average
+ *  @param spokes How many spokes the wheel has
+ *  @param from The spoke at the sensor now
+ *  @param tolerance A spoke whose offset is less than this needn't be adjusted
+ *  @param first A bit for each spoke to be picked before any others if it's out of
+ *               tolerance, such as one to be tried again (default: none)
+ *  @return How many spokes are to be adjusted; none if the wheel is true
+ */
+
+uint8_t route_planner::plan (const int16_t offsets[], uint8_t spokes, uint8_t from,
+							 uint16_t tolerance, spoke_set first)
+{
+	pick (offsets, spokes, tolerance, first);
+	order (spokes, from);
+
+	return (count);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method picks the spokes to be adjusted.
+ *  \details Spokes are picked one at a time, the one with the biggest offset of those
+ *  which may be picked each time, until \c PLAN_MAX_STOPS have been picked or none
+ *  is left which may be.
+ *  @param offsets Each spoke's offset from the average
+ *  @param spokes How many spokes the wheel has
+ *  @param tolerance A spoke whose offset is less than this needn't be adjusted
+ *  @param first A bit for each spoke to be picked before any others
+ */
+
+void route_planner::pick (const int16_t offsets[], uint8_t spokes, uint16_t tolerance,
+						  spoke_set first)
+{
+	int32_t threshold = 0;                  // The least offset worth adjusting now
+
+	for (uint8_t spoke = 0; spoke < spokes; spoke++)
+	{
+		if (PLAN_SIZE (offsets[spoke]) > threshold)
+		{
+			threshold = PLAN_SIZE (offsets[spoke]);
+		}
+	}
+	threshold >>= PLAN_SHARE_SHIFT;
+	if (threshold < (int32_t)tolerance)
+	{
+		threshold = tolerance;
+	}
+
+	count = 0;
+	planned = 0;
+	while (count < PLAN_MAX_STOPS)
+	{
+		int32_t best_key = -1;
+		uint8_t best = 0;
+
+		for (uint8_t spoke = 0; spoke < spokes; spoke++)
+		{
+			int32_t size = PLAN_SIZE ((int32_t)offsets[spoke]);
+			bool is_first = (first & SPOKE_BIT (spoke)) != 0;
+
+			if (size < (is_first ? (int32_t)tolerance : threshold))
+			{
+				continue;
+			}
+
+			// Spokes too near one already picked are left for next time
+			bool too_near = false;
+			for (uint8_t index = 0; index < count && !too_near; index++)
+			{
+				uint8_t apart = (spoke > stops[index]) ? spoke - stops[index]
+													   : stops[index] - spoke;
+				if (apart > spokes - apart)
+				{
+					apart = spokes - apart;
+				}
+				too_near = (apart < PLAN_SPACING);
+			}
+			if (too_near)
+			{
+				continue;
+			}
+
+			// Spokes to be picked first come before any others, however small
+			int32_t key = is_first ? size + 0x10000 : size;
+			if (key > best_key)
+			{
+				best_key = key;
+				best = spoke;
+			}
+		}
+
+		if (best_key < 0)
+		{
+			break;
+		}
+		stops[count++] = best;
+		planned |= SPOKE_BIT (best);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method puts the picked spokes in the order which takes the least
+ *  turning of the wheel.
+ *  \details The spokes are sorted by how far forward of the start they are. Going
+ *  forward to the k'th of them and back to the rest costs twice the first leg plus
+ *  the second; going back first costs the first leg plus twice the second. Each k,
+ *  both ways, is tried, and the cheapest is kept. A spoke at the sensor already is
+ *  always visited first.
+ *  @param spokes How many spokes the wheel has
+ *  @param from The spoke at the sensor now
+ */
+
+void route_planner::order (uint8_t spokes, uint8_t from)
+{
+	uint8_t ahead[PLAN_MAX_STOPS];          // How far forward of the start each is
+	uint8_t sorted[PLAN_MAX_STOPS];
+
+	// Sort the spokes by how far forward they are, by insertion as there are few
+	for (uint8_t index = 0; index < count; index++)
+	{
+		uint8_t distance = (stops[index] + spokes - from) % spokes;
+		uint8_t place = index;
+
+		while (place > 0 && ahead[place - 1] > distance)
+		{
+			ahead[place] = ahead[place - 1];
+			sorted[place] = sorted[place - 1];
+			place--;
+		}
+		ahead[place] = distance;
+		sorted[place] = stops[index];
+	}
+
+	// Try each split; k spokes are visited going forward, the rest going back
+	uint16_t best_cost = 0xFFFF;
+	uint8_t best_split = count;
+	bool forward_first = true;
+
+	// A spoke at the sensor already is taken out of the search and visited first
+	uint8_t here = (count > 0 && ahead[0] == 0) ? 1 : 0;
+	for (uint8_t split = here; split <= count; split++)
+	{
+		uint16_t forward = (split > 0) ? ahead[split - 1] : 0;
+		uint16_t back = (split < count) ? spokes - ahead[split] : 0;
+
+		if (2 * forward + back < best_cost)
+		{
+			best_cost = 2 * forward + back;
+			best_split = split;
+			forward_first = true;
+		}
+		if (forward + 2 * back < best_cost)
+		{
+			best_cost = forward + 2 * back;
+			best_split = split;
+			forward_first = false;
+		}
+	}
+
+	// Going forward, the spokes are visited nearest first; going back, the ones
+	// furthest forward are the nearest
+	uint8_t stop = 0;
+	if (here)
+	{
+		stops[stop++] = sorted[0];
+	}
+	if (!forward_first)
+	{
+		for (uint8_t index = count; index > best_split; index--)
+		{
+			stops[stop++] = sorted[index - 1];
+		}
+	}
+	for (uint8_t index = here; index < best_split; index++)
+	{
+		stops[stop++] = sorted[index];
+	}
+	if (forward_first)
+	{
+		for (uint8_t index = count; index > best_split; index--)
+		{
+			stops[stop++] = sorted[index - 1];
+		}
+	}
+
+	travel = (count > 0) ? (uint8_t)best_cost : 0;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method finds the worst spoke which isn't in the plan.
+ *  \details It's the best guess at the spoke which will need adjusting first once
+ *  the plan has been carried out and the wheel measured again.
+ *  @param offsets Each spoke's offset from the average
+ *  @param spokes How many spokes the wheel has
+ *  @return The spoke, or the last one in the plan if every spoke is in it
+ */
+
+uint8_t route_planner::next_worst (const int16_t offsets[], uint8_t spokes)
+{
+	int16_t worst_size = -1;
+	uint8_t worst = (count > 0) ? stops[count - 1] : 0;
+
+	for (uint8_t spoke = 0; spoke < spokes; spoke++)
+	{
+		if (!(planned & SPOKE_BIT (spoke))
+			&& PLAN_SIZE (offsets[spoke]) > worst_size)
+		{
+			worst_size = PLAN_SIZE (offsets[spoke]);
+			worst = spoke;
+		}
+	}
+
+	return (worst);
+}
@@ -0,0 +1,115 @@
+//*************************************************************************************
+/** \file route_planner.h
+ *    This file contains a planner which picks the spokes to be adjusted before the
+ *    wheel is measured again, and the order to visit them in so that the wheel turns
+ *    as little as it can going from one to the next.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, several spokes adjusted between measurements
+ *    \li 10-18-26 Tolerances in micrometres, which can be bigger than a byte
+ *    \li 10-18-26 Spoke sets for wheels of up to MAX_SPOKES spokes
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+// This define prevents this .h file from being included multiple times in a .cpp file
+#ifndef _ROUTE_PLANNER_H_
+#define _ROUTE_PLANNER_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "wheel_limits.h"                   // The most spokes a wheel can have
+
+
+/// The most spokes adjusted before the wheel is measured again
+#define PLAN_MAX_STOPS		6
+
+/** A spoke is only adjusted before the wheel is measured again if its offset is at
+ *  least 1 / 2^PLAN_SHARE_SHIFT of the worst. Adjusting the big ones moves the
+ *  small ones, so there's no point working on those until they've been measured
+ *  again; and whatever is left is at most that share of the worst offset.
+ */
+#define PLAN_SHARE_SHIFT	1
+
+/** Spokes fewer than this many spokes apart aren't both adjusted before the wheel is
+ *  measured again, as turning either one moves the other's offset, so its offset
+ *  would be out of date.
+ */
+#define PLAN_SPACING		2
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This class plans which spokes to adjust before the wheel is measured again,
+ *  and in what order.
+ *  \details The spokes are picked worst first, as long as they're out of tolerance,
+ *  have at least their share of the worst offset and aren't next to one already
+ *  picked. Spokes which went the wrong way last time, and are to be tried again, are
+ *  picked before any others.
+ *
+ *  The picked spokes are then put in the order which takes the least turning of the
+ *  wheel, starting from where it is. On a ring, the shortest route round a set of
+ *  spokes goes one way to some spoke, then turns back and goes the other way past
+ *  the start to the rest, or the same the other way round; going all the way one
+ *  way is the case in which there are no spokes on the way back. Every such split
+ *  is tried, which with a handful of spokes takes no time at all.
+ */
+
+class route_planner
+{
+	protected:
+		/// The spokes to be adjusted, in the order they're to be visited
+		uint8_t stops[PLAN_MAX_STOPS];
+
+		/// How many spokes are to be adjusted
+		uint8_t count;
+
+		/// A bit for each spoke which is in the plan
+		spoke_set planned;
+
+		/// How many spokes the wheel turns by, following the plan from the start
+		uint8_t travel;
+
+		// Pick the spokes to be adjusted
+		void pick (const int16_t offsets[], uint8_t spokes, uint16_t tolerance,
+				   spoke_set first);
+
+		// Put the picked spokes in the order which takes the least turning
+		void order (uint8_t spokes, uint8_t from);
+
+	public:
+		// The constructor makes an empty plan
+		route_planner (void);
+
+		// Plan which spokes to adjust and the order in which to go to them
+		uint8_t plan (const int16_t offsets[], uint8_t spokes, uint8_t from,
+					  uint16_t tolerance, spoke_set first = 0);
+
+		// Find the worst spoke which isn't in the plan
+		uint8_t next_worst (const int16_t offsets[], uint8_t spokes);
+
+		/// Get how many spokes are to be adjusted
+		uint8_t get_count (void) { return (count); }
+
+		/** This method gets a spoke in the plan.
+		 *  @param index Where the spoke is in the order, from 0 to \c get_count() - 1
+		 *  @return The spoke
+		 */
+		uint8_t get_stop (uint8_t index) { return (stops[index]); }
+
+		/// Get how many spokes the wheel turns by to follow the plan
+		uint8_t get_travel (void) { return (travel); }
+};
+
+#endif // _ROUTE_PLANNER_H_
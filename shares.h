@@ -5,6 +5,20 @@
  *
  *  Revisions:
  *    \li 03-13-13 HL, TJ, & SG all shared queues and variables included
+ *    \li 10-18-26 added session_finished flag for end of session reports
+ *    \li 10-18-26 added UI_NUM_MESSAGES, the size of the user interface's catalogue
+ *    \li 10-18-26 messages to the user interface carry their numbers in a ui_queue
+ *    \li 10-18-26 commands from the user interface; tolerance, gains and abort flag
+ *    \li 10-18-26 added the live gauge switch
+ *    \li 10-18-26 added the radial truing switch
+ *    \li 10-18-26 added the tension mapping switch
+ *    \li 10-18-26 tolerance in micrometres; pot calibration commands
+ *    \li 10-18-26 counts of spoke sensor edges filtered out and corrected; whether
+ *        a spoke is at the sensor
+ *    \li 10-18-26 added the number of the wheel on the stand
+ *    \li 10-18-26 took out ACK, which answered questions that are no longer asked
+ *    \li 10-18-26 the number of spokes is limited by MAX_SPOKES
+ *    \li 10-18-26 added wheel_measured, until which the number of spokes can change
  *
  *  License:
  *    This file is copyright 2013 by Hamilton Little, Trevor Jones and Sean Green 
@@ -28,6 +42,8 @@
 
 #include "frt_text_queue.h"
 #include "frt_queue.h"
+#include "ui_queue.h"
+#include "wheel_limits.h"
 
 //-------------------------------------------------------------------------------------
 // Externs:  In this section, we declare variables and functions that are used in all
@@ -35,22 +51,32 @@
 // will also be declared exactly once, without the keyword 'extern', in one .cpp file
 // as well as being declared extern here. 
 
-/** These are the messages which can be passed from the truing algorithm task
- *	to the user interface task */
-typedef enum ui_messages { HELLO, GOODBYE, TIGHTEN, LOOSEN, TRY_AGAIN, MEASURING, DONE, 
-							PRINT_SPOKE, GO_BACK, DONE_MEASURING, WAIT, STOP_WAITING, 
-							ENTER_SPOKES, FIRST_SPOKE, ECHO} ui_messages;
-
 /** These are the messages which the user interface task can send back to the truing
- * algorithm task, which originate from user input */
-typedef enum messages_from_ui { DID_THAT, ACK } messages_from_ui;
+ * algorithm task, which originate from user input. DID_THAT, SKIP, REMEASURE and
+ * ABORT answer a prompt to turn a spoke; START begins a new session once the last one
+ * is over. The CAL_ messages calibrate a pot between sessions, using cal_channel
+ * and cal_microns */
+typedef enum messages_from_ui { DID_THAT, START, SKIP, REMEASURE, ABORT,
+								CAL_BEGIN, CAL_POINT, CAL_SAVE, CAL_CLEAR
+							  } messages_from_ui;
 
-/** This is the index of the spoke which most recently passed the spoke_counter */
+/** This is the index of the spoke at the spoke sensor or, if there's a gap at the
+ *  sensor, the one before the gap */
 extern volatile int8_t spoke_count;
 
-/** This is the number of spokes on the wheel */
+/** This is true while a spoke is at the spoke sensor, and false while a gap is */
+extern volatile bool spoke_at_sensor;
+
+/** This is the number of spokes on the wheel, from 2 to \c MAX_SPOKES */
 extern uint8_t max_spokes;
 
+/** These count the spoke sensor's edges which weren't spokes, the spokes taken back
+ *  off the count as the wheel turned back in the beam, and the times the index mark
+ *  showed the count had drifted and it was put right */
+extern volatile uint16_t spoke_glitches;
+extern volatile uint16_t spoke_reversals;
+extern volatile uint16_t spoke_corrections;
+
 /** This is true if the wheel is spinning cw, false if spinning ccw, when viewed from
  *  the quick release lever side of the wheel */
 extern volatile bool wheel_direction;
@@ -62,13 +88,55 @@ extern volatile int8_t desired_spoke;
  * later on whether to tell them to loosen or tighten a given spoke */
 extern bool left_or_right;
 
+/** set by the mastermind task when the wheel is true and the session is over, so
+ * tasks which only report at the end of a session know when to do so */
+extern volatile bool session_finished;
+
+/** set by the mastermind task once the session has measured the wheel; until then,
+ * the user can still change the number of spokes, and the measuring starts again */
+extern volatile bool wheel_measured;
+
+/** set by the user interface to make the mastermind task give up on the session it's
+ * running; the mastermind clears it once it has */
+extern volatile bool abort_session;
+
+/** the wheel is true once every spoke's offset from the average is less than this
+ * many micrometres */
+extern volatile uint16_t true_tolerance;
+
+/** the A/D channel of the pot being calibrated, and the position in micrometres of
+ * the calibration point the user has just set it at */
+extern volatile uint8_t cal_channel;
+extern volatile int16_t cal_microns;
+
+/** set by the user to watch the spoke being adjusted on a live gauge, which answers
+ * the prompt by itself once the spoke is within tolerance */
+extern volatile bool live_gauge;
+
+/** set by the user, on a stand with a second pot reading the rim's radial position,
+ * to true the rim radially and sideways together */
+extern volatile bool radial_truing;
+
+/** set by the user, on a stand with a tensiometer, to read each spoke's tension as
+ * the wheel is measured and keep truing from making the tensions more uneven */
+extern volatile bool tension_mapping;
+
+/** set by the user to the number of the wheel on the stand, so it's homed and its
+ * history kept, or 0 for a wheel which isn't to be remembered */
+extern volatile uint8_t wheel_number;
+
+/** the position controller's proportional and integral gains, which the user can
+ * change while the stand is running */
+extern volatile uint8_t pos_gain_kp;
+extern volatile uint8_t pos_gain_ki;
+
 /** This queue allows allows us to print stuff from anywhere in the code to the
   terminal console through the serial usb port. */
 extern frt_text_queue* print_ser_queue;
 
 /** This queue is used to send messages to the user interface, so it knows what to 
  * print out or prompt the user for */
-extern frt_queue<ui_messages> *to_ui;
+extern ui_queue *to_ui;
 
 /** This queue is used by the user interface to send responses it gets from the user
  * back to the mastermind task. */
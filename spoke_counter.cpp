@@ -7,6 +7,13 @@
  *
  *  Revisions:
  *    \li 03-13-13 HL, TJ, & SG spoke_counter is up and running
+ *    \li 10-18-26 spoke sensor edges go into the capture log
+ *    \li 10-18-26 the count can be renumbered by whole turns of the wheel
+ *    \li 10-18-26 both edges interrupt, so the count is the spoke at the sensor;
+ *        spokes turned back on are put right from the encoder, false edges are
+ *        filtered out by the learned spoke spacing and the index mark corrects drift
+ *    \li 10-18-26 spokes can be numbered from the index mark
+ *    \li 10-18-26 the last spoke coming back in where it went out is let through
  *
  *  License:
  *    This file is copyright 2013 by Hamilton Little, Trevor Jones and Sean Green 
@@ -24,12 +31,13 @@
 *    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 //*************************************************************************************
 
-#include <stdlib.h>                         // Include standard library header files
+#include <stdlib.h>
 #include <avr/io.h>
 
 #include "rs232int.h"                       // Include header for serial port class
 #include "shares.h"
 #include "spoke_counter.h"                 // Include header for the spoke_counter class
+#include "event_log.h"                     // Capture log, when built with EVENT_CAPTURE
 
 
 		
@@ -47,6 +55,48 @@ static wheel_encoder *wheel;
  * by frequently updating the shared variable spoke_count */
 static volatile int8_t count;
 
+// These are the shared counts of edges which weren't spokes, spokes put right as they
+// went out of the beam because the wheel turned back, and corrections made from the
+// index mark
+volatile uint16_t spoke_glitches;
+volatile uint16_t spoke_reversals;
+volatile uint16_t spoke_corrections;
+
+// This is true while a spoke is in the beam. It's shared, so the position controller
+// can put the spoke right at the sensor
+volatile bool spoke_at_sensor;
+
+// which way the spoke in the beam came in, what was added to the count then, and
+// where the encoder was
+static bool entered_forward;
+static int8_t entered;
+static int8_t entry_position;
+
+// this is true while the spoke in the beam is the last one come back in where it
+// went out, which counts only if it goes back out the side it first came in
+static bool came_back;
+
+// where the encoder was as the last spoke to go right through the beam came in and
+// went out, which way it went, and whether there's been one yet
+static int8_t last_in;
+static int8_t last_out;
+static int8_t last_passed;
+static bool have_last;
+
+// the spacing of the spokes in half encoder edges, or 0 until it's been learned, and
+// the last spacing seen while it's being learned
+static uint8_t pitch;
+static uint8_t pitch_candidate;
+
+// the gap the index mark is in, or -1 until it's been learned; the gap it was last
+// seen in while being learned; and the error it was last seen with
+static int8_t index_gap = -1;
+static int8_t index_candidate = -1;
+static int8_t index_error;
+
+// the number of spokes the index mark was learned for
+static uint8_t index_spokes;
+
 //-------------------------------------------------------------------------------------
 /** \brief Sets up the spoke counter (implemented by the laser/phottransistor sensor).
 *  \details We detect, using an external interrupt, when the laser beam has been
@@ -68,10 +118,17 @@ spoke_counter::spoke_counter(emstream* p_serial_port,
 	count = 0;
 	spoke_count = 0;
 	max_spokes = num_spokes;
-	
+	spoke_glitches = 0;
+	spoke_reversals = 0;
+	spoke_corrections = 0;
+	spoke_at_sensor = false;
+	have_last = false;
+	pitch = 0;
+	pitch_candidate = 0;
 	
 	// Set up external interrupts on PE4 (the phototransistor is hooked up to this chan)
-	EICRB |=  (1 << ISC40) | (1 << ISC41);		// interrupt rising edge
+	EICRB |=  (1 << ISC40);						// interrupt on any edge
+	EICRB &= ~(1 << ISC41);
 	DDRE &= ~(1 << PE4);						// set PE4 as input	
 	EIMSK |= (1 << INT4);						// enable bit in mask
 	
@@ -90,19 +147,271 @@ void spoke_counter::update() {
 	sei();
 }
 
+//-------------------------------------------------------------------------------------
+/** \brief Renumbers the spokes.
+*  \details The count only goes up and down as spokes go by, so a wheel which keeps
+* 	turning the same way would soon run it past the end of an int8_t. Taking a whole
+* 	number of turns off keeps it small while every spoke keeps its place. The desired
+* 	spoke is moved too, all at once, so the position controller never sees one moved
+* 	without the other.
+*  @param spokes the number to take off the count; a multiple of max_spokes
+*/
+void spoke_counter_shift (int8_t spokes) {
+	portENTER_CRITICAL();
+	count -= spokes;
+	spoke_count = count;
+	desired_spoke -= spokes;
+	portEXIT_CRITICAL();
+}
+
+//-------------------------------------------------------------------------------------
+/** \brief Forgets the spoke spacing and where the index mark is.
+*  \details A new wheel's spokes may be spaced differently and its valve hole is
+* 	somewhere else, so they're learned again in the first turns of the next session.
+* 	The last spoke seen is forgotten too, as the wheel may have been turned round
+* 	since, and the spacing to the next one would be nonsense.
+*/
+void spoke_counter_new_wheel (void) {
+	portENTER_CRITICAL();
+	pitch = 0;
+	pitch_candidate = 0;
+	have_last = false;
+	index_gap = -1;
+	index_candidate = -1;
+	index_error = 0;
+	portEXIT_CRITICAL();
+}
+
+//-------------------------------------------------------------------------------------
+/** \brief Numbers the spokes from the index mark.
+*  \details Spoke 0 becomes the first spoke after the mark going forward, so the mark
+* 	is in the gap after the last spoke. The count and the desired spoke are moved
+* 	together, as they are by spoke_counter_shift(). Until the mark has been learned
+* 	for this wheel, nothing is changed.
+*  @return true if the spokes are now numbered from the mark, false if it hasn't
+* 	been learned yet
+*/
+bool spoke_counter_home (void) {
+	bool homed;
+	
+	portENTER_CRITICAL();
+	homed = index_gap >= 0 && index_spokes == max_spokes;
+	if (homed) {
+		int8_t shift = index_gap - (int8_t)(max_spokes - 1);
+		count -= shift;
+		spoke_count = count;
+		desired_spoke -= shift;
+		index_gap = max_spokes - 1;
+		index_candidate = -1;
+		index_error = 0;
+	}
+	portEXIT_CRITICAL();
+	
+	return homed;
+}
+
+//-------------------------------------------------------------------------------------
+/** \brief Learns the spoke spacing from two spokes passed the same way in a row.
+*  \details Until it's known, it's taken as known once two spacings in a row agree to
+* 	within a quarter. After that, spacings which don't agree that well, as when a
+* 	spoke was missed, are ignored and the rest move it a little.
+*  @param spacing how far apart the middles of the spokes were, in half encoder edges
+*/
+static void learn_pitch (int16_t spacing) {
+	if (spacing < 0) {
+		spacing = -spacing;
+	}
+	if (spacing > 0xFF) {
+		return;
+	}
+	
+	uint8_t reference = pitch ? pitch : pitch_candidate;
+	int16_t difference = spacing - reference;
+	bool agrees = reference != 0 && ABS(difference) <= reference / 4;
+	
+	if (pitch) {
+		if (agrees) {
+			pitch += difference / 4;
+		}
+	} else if (agrees) {
+		pitch = (spacing + reference) / 2;
+	} else {
+		pitch_candidate = spacing;
+	}
+}
+
+//-------------------------------------------------------------------------------------
+/** \brief Deals with the index mark going through the beam.
+*  \details In a gap, the count is the spoke before it, so the mark is in the gap
+* 	after spoke \c count. The first gap the mark is seen in twice running is learned.
+* 	After that, it should always be seen there; if it's seen twice running the same
+* 	small number of spokes away, the count has drifted by that much and is put back.
+* 	It's called from the ISR, so it needn't guard the count.
+*/
+static void index_seen (void) {
+	if (max_spokes == 0) {
+		return;
+	}
+	if (index_spokes != max_spokes) {
+		index_spokes = max_spokes;
+		index_gap = -1;
+		index_candidate = -1;
+		index_error = 0;
+	}
+	
+	int8_t gap = count % (int8_t)max_spokes;
+	if (gap < 0) {
+		gap += max_spokes;
+	}
+	
+	// until it's been seen in the same gap twice running, it's still being learned
+	if (index_gap < 0) {
+		if (gap == index_candidate) {
+			index_gap = gap;
+		}
+		index_candidate = gap;
+		return;
+	}
+	
+	// the error the shortest way round the wheel
+	int8_t error = gap - index_gap;
+	if (error > (int8_t)(max_spokes / 2)) {
+		error -= max_spokes;
+	} else if (error < -(int8_t)(max_spokes / 2)) {
+		error += max_spokes;
+	}
+	
+	if (error == 0 || error > SPOKE_INDEX_MAX_ERROR || error < -SPOKE_INDEX_MAX_ERROR) {
+		index_error = 0;
+	} else if (error == index_error) {
+		count -= error;
+		spoke_corrections++;
+		index_error = 0;
+	} else {
+		index_error = error;
+	}
+}
+
+//-------------------------------------------------------------------------------------
+/** \brief Deals with something coming into the beam.
+*  \details The next spoke can't come in until the wheel has turned nearly a whole
+* 	spacing away from the middle of the last one, so anything sooner than the window
+* 	isn't a spoke. The encoder says how far the wheel has turned, which is how far
+* 	its speed would predict, without the wheel having to keep to one speed, which it
+* 	seldom does on the stand. Turning back toward the last spoke, whatever comes in
+* 	is that spoke again, so it's let through. So is anything which comes in just
+* 	where the last spoke went out, though the direction says the wheel is going on:
+* 	that is the spoke, either the wheel having turned back so lately that the
+* 	direction hasn't caught up, or the beam having flickered while it went by.
+*  @param forward which way the wheel is turning
+*/
+static void rising_edge (bool forward) {
+	int8_t position = wheel->get_position();
+	
+	if (have_last && pitch) {
+		// how far the wheel is from the middle of the last spoke, in half edges,
+		// counting positive as it goes away from it
+		int16_t away = (int8_t)(position - last_in) + (int8_t)(position - last_out);
+		if (position == last_out && forward == (last_passed > 0)) {
+			spoke_at_sensor = true;
+			came_back = true;
+			entered_forward = !forward;
+			entered = 0;
+			entry_position = position;
+			return;
+		}
+		if (!forward) {
+			away = -away;
+		}
+		if (away > 0 && away * 8 < pitch * SPOKE_WINDOW_EIGHTHS) {
+			if (away * 8 >= pitch * SPOKE_INDEX_EIGHTHS) {
+				index_seen ();
+			} else {
+				spoke_glitches++;
+			}
+			return;
+		}
+	}
+	
+	// going forward, a spoke counts as soon as it's at the sensor; going back, not
+	// until it's gone by, so the count is always the spoke at the sensor or, in a
+	// gap, the one before it
+	spoke_at_sensor = true;
+	came_back = false;
+	entered_forward = forward;
+	entered = forward ? 1 : 0;
+	entry_position = position;
+	count += entered;
+}
+
+//-------------------------------------------------------------------------------------
+/** \brief Deals with something going out of the beam.
+*  \details The encoder must make at least one edge while a spoke goes right through
+* 	the beam, so how far it moved says which way the spoke went, or that it didn't
+* 	go through at all but went out the way it came in. The direction when it came in
+* 	may have been stale, if the wheel turned back just before, so the count is made
+* 	right for which way it really went. A spoke which went right through becomes the
+* 	one the window is measured from, and if the last one went through the same way,
+* 	their spacing is learned.
+*/
+static void falling_edge (void) {
+	
+	// the end of something which wasn't counted
+	if (!spoke_at_sensor) {
+		return;
+	}
+	spoke_at_sensor = false;
+	
+	int8_t position = wheel->get_position();
+	int8_t moved = position - entry_position;
+	int8_t passed = (moved > 0) ? 1 : ((moved < 0) ? -1 : 0);
+	
+	// the last spoke back in where it went out has been counted unless it went back
+	if (came_back) {
+		if (passed == last_passed) {
+			last_out = position;
+		} else if (passed) {
+			count += passed;
+			spoke_reversals++;
+			last_in = entry_position;
+			last_out = position;
+			last_passed = passed;
+		}
+		return;
+	}
+	
+	count += passed - entered;
+	if (passed != (entered_forward ? 1 : -1)) {
+		spoke_reversals++;
+	}
+	
+	if (passed) {
+		if (have_last && passed == last_passed) {
+			learn_pitch ((int8_t)(entry_position - last_in)
+						 + (int8_t)(position - last_out));
+		}
+		last_in = entry_position;
+		last_out = position;
+		last_passed = passed;
+		have_last = true;
+	}
+}
+
 //-------------------------------------------------------------------------------------
 /** \cond NOT_ENABLED ISR for external interrupt on pin 4 (PortE pin 4). This has been
- * 	set up to trigger only on rising edge. This is where count is incremented or
+ * 	set up to trigger on both edges. This is where count is incremented or
  *  decremented, accordingly.
 */
 ISR(INT4_vect) {
+	bool high = (PINE & (1 << PE4)) != 0;
+	
+	EVENT_LOG_EDGE(EVENT_INT4, high);
 	
-	// if wheel direction is true, increment. Else Decrement
-	if (wheel->get_direction()){
-		count++;
-	}else{
-		count--;	
-	}	
+	if (high) {
+		rising_edge (wheel->get_direction());
+	} else {
+		falling_edge ();
+	}
 }
 
 /** \endcond end of undocumented code */
@@ -7,6 +7,9 @@
  *
  *  Revisions:
  *    \li 03-13-13 HL, TJ, & SG spoke_counter is up and running
+ *    \li 10-18-26 the count can be renumbered by whole turns of the wheel
+ *    \li 10-18-26 false edges are filtered out and the index mark corrects drift
+ *    \li 10-18-26 spokes can be numbered from the index mark
  *
  *  License:
  *    This file is copyright 2013 by Hamilton Little, Trevor Jones and Sean Green 
@@ -36,6 +39,20 @@
 #include "wheel_encoder.h"
 
 
+/** A rising edge which comes before the wheel has turned this many eighths of the
+ *  spoke spacing on from the middle of the last spoke isn't a spoke; it's a valve
+ *  hole, a sticker or dirt going through the beam.
+ */
+#define SPOKE_WINDOW_EIGHTHS	5
+
+/// One of those which comes at least this many eighths of the spacing on is in the
+/// middle of a gap, where the once a turn index mark is looked for
+#define SPOKE_INDEX_EIGHTHS		3
+
+/// The most spokes the count is corrected by when the index mark is seen where it
+/// shouldn't be; a bigger error is more likely a mark which isn't the index
+#define SPOKE_INDEX_MAX_ERROR	2
+
 
 //-------------------------------------------------------------------------------------
 /** \brief Counts the spokes as they pass the laser/phototransistor sensor.
@@ -43,6 +60,22 @@
 *   laser/phototransistor sensor set up on the bicycle wheel stand. It uses the an
 * 	encoder fixed to the wheel to determine the wheel's true direction of spin, and
 * 	increments or decrements the count accordingly.
+*
+* 	Both edges of the sensor interrupt. Going forward, a spoke is counted as it comes
+* 	into the beam, and going back, as it goes out, so the count is the spoke at the
+* 	sensor or, in a gap, the one before it. As a spoke goes out, how far the encoder
+* 	moved says which way it really went; if the wheel turned back in the beam, the
+* 	count is put right, so a spoke seen twice on a change of direction isn't counted
+* 	twice.
+*
+* 	The spokes' spacing, in encoder edges, is learned as they go by. Anything coming
+* 	into the beam before the wheel has turned most of a spacing from the last spoke
+* 	is thrown away. One in the middle of a gap is taken as the index mark, such as
+* 	the valve hole: the first gap it's seen in twice running is learned, and after
+* 	that, if it's seen twice running a spoke or two away from there, the count is put
+* 	right. Once the mark has been learned, the spokes can be numbered from it, so
+* 	that spoke 0 is the first after it going forward whichever way round the wheel
+* 	was put on the stand.
 */
 class spoke_counter
 {
@@ -60,6 +93,15 @@ class spoke_counter
 		void update();
 }; // end of class spoke_counter
 
+// renumber the spokes, moving the count and the desired spoke by the same amount
+void spoke_counter_shift (int8_t spokes);
+
+// forget the spoke spacing and index mark, as a new wheel has been put on the stand
+void spoke_counter_new_wheel (void);
+
+// number the spokes from the index mark, once it's been learned
+bool spoke_counter_home (void);
+
 // This operator prints out information about the encoder_driver object. It's not 
 // a part of class encoder_driver, but it operates on objects of class encoder_driver
 emstream& operator << (emstream&, spoke_counter&);
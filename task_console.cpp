@@ -0,0 +1,303 @@
+//*************************************************************************************
+/** \file task_console.cpp
+ *    This file contains the source for a task which takes everything the other tasks
+ *    print out of the print queue and sends it to the serial port.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, console output through a single writer task
+ *    \li 10-18-26 Characters are taken out of the queue in runs; print queue benchmark
+ *    \li 10-18-26 Check and time the division-free number conversion at startup
+ *    \li 10-18-26 Benchmarks are timed in microseconds, by the PC's clock on a PC
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include <stdlib.h>                         // Library number conversions
+#include <string.h>                         // Functions for C string handling
+
+#include "task_console.h"                   // Header for this file
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This constructor creates a task which copies the print queue to a serial
+ *  port.
+ *  @param a_name A character string which will be the name of this task
+ *  @param a_priority The priority at which this task will initially run (default: 0)
+ *  @param a_stack_size The size of this task's stack in bytes
+ *                      (default: configMINIMAL_STACK_SIZE)
+ *  @param p_ser_dev Pointer to the serial port to which the characters are sent
+ *  @param p_print_queue Pointer to the queue into which the other tasks print
+ *  @param p_stack_buffer Pointer to a statically allocated array to be used as the
+ *                   task's stack, or NULL to take it from the heap (default: NULL)
+ */
+
+task_console::task_console (const char* a_name,
+							unsigned portBASE_TYPE a_priority,
+							size_t a_stack_size,
+							emstream* p_ser_dev,
+							frt_text_queue* p_print_queue,
+							portSTACK_TYPE* p_stack_buffer
+						   )
+	: frt_task (a_name, a_priority, a_stack_size, p_ser_dev, p_stack_buffer)
+{
+	p_queue = p_print_queue;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method copies characters from the print queue to the serial port.
+ *  \details The task blocks on the queue, so it uses no processor time while there's
+ *  nothing to print. Once a character turns up, whatever else is waiting is taken
+ *  with it, up to \c CONSOLE_BUFFER_SIZE characters, and they're all written to the
+ *  port at once. The first character is taken through the queue's handle rather than
+ *  with \c getchar(), as a wait which times out can't be told apart from a character
+ *  0xFF that way, and telemetry records are full of those. When the serial port's
+ *  transmitter buffer hasn't room for them the task sleeps a tick at a time rather
+ *  than letting the port spin, so that it can run above the other tasks without ever
+ *  holding them up.
+ */
+
+void task_console::run (void)
+{
+	xQueueHandle queue_handle = p_queue->get_handle ();
+	char buffer[CONSOLE_BUFFER_SIZE];
+	uint16_t count;
+
+	#ifdef QUEUE_BENCHMARK
+		benchmark ();
+		benchmark_format ();
+	#endif
+
+	for (;;)
+	{
+		if (xQueueReceive (queue_handle, buffer, portMAX_DELAY) != pdTRUE)
+		{
+			continue;
+		}
+		count = 1 + p_queue->read (buffer + 1, CONSOLE_BUFFER_SIZE - 1);
+		send (buffer, count);
+
+		runs++;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method sends characters to the serial port once there's room for them.
+ *  @param p_data A pointer to the characters
+ *  @param count The number of characters, no more than the port's buffer holds
+ */
+
+void task_console::send (const char* p_data, uint16_t count)
+{
+	while (p_serial->tx_space () < count)
+	{
+		vTaskDelay (1);
+	}
+	p_serial->write (p_data, count);
+}
+
+
+#ifdef QUEUE_BENCHMARK
+
+//-------------------------------------------------------------------------------------
+/** \brief This method times the print queue a character at a time and in runs.
+ *  \details Each round, the queue is filled with runs of \c CONSOLE_BUFFER_SIZE
+ *  characters using \c putchar() and emptied a character at a time, as the tasks
+ *  and this one used to do, then filled using \c write() and emptied using
+ *  \c read(). The times are summed over \c QUEUE_BENCH_ROUNDS rounds so that the
+ *  one tick resolution of the AVR's clock doesn't matter, and printed straight to
+ *  the serial port, in microseconds. Whatever the other tasks printed while they
+ *  were being created is sent first, so that the queue starts out empty.
+ */
+
+void task_console::benchmark (void)
+{
+	xQueueHandle queue_handle = p_queue->get_handle ();
+	char text[CONSOLE_BUFFER_SIZE];
+	char buffer[CONSOLE_BUFFER_SIZE];
+	uint16_t runs_per_round = p_queue->get_size () / CONSOLE_BUFFER_SIZE;
+	uint32_t char_put_us = 0, char_get_us = 0;
+	uint32_t run_put_us = 0, run_get_us = 0;
+	uint32_t start;
+
+	memset (text, '.', CONSOLE_BUFFER_SIZE);
+
+	uint16_t count;
+	while ((count = p_queue->read (buffer, CONSOLE_BUFFER_SIZE)) > 0)
+	{
+		send (buffer, count);
+	}
+
+	for (uint16_t round = 0; round < QUEUE_BENCH_ROUNDS; round++)
+	{
+		start = BENCH_MICROSECONDS ();
+		for (uint16_t run = 0; run < runs_per_round; run++)
+		{
+			for (uint8_t index = 0; index < CONSOLE_BUFFER_SIZE; index++)
+			{
+				p_queue->putchar (text[index]);
+			}
+		}
+		char_put_us += BENCH_MICROSECONDS () - start;
+
+		start = BENCH_MICROSECONDS ();
+		for (uint16_t index = 0; index < runs_per_round * CONSOLE_BUFFER_SIZE; index++)
+		{
+			xQueueReceive (queue_handle, buffer, 0);
+		}
+		char_get_us += BENCH_MICROSECONDS () - start;
+
+		start = BENCH_MICROSECONDS ();
+		for (uint16_t run = 0; run < runs_per_round; run++)
+		{
+			p_queue->write (text, CONSOLE_BUFFER_SIZE);
+		}
+		run_put_us += BENCH_MICROSECONDS () - start;
+
+		start = BENCH_MICROSECONDS ();
+		for (uint16_t run = 0; run < runs_per_round; run++)
+		{
+			p_queue->read (buffer, CONSOLE_BUFFER_SIZE);
+		}
+		run_get_us += BENCH_MICROSECONDS () - start;
+	}
+
+	*p_serial << PMS ("Print queue benchmark, ")
+			  << (uint32_t)QUEUE_BENCH_ROUNDS * runs_per_round * CONSOLE_BUFFER_SIZE
+			  << PMS (" characters each way, us") << endl
+			  << PMS ("In:  putchar ") << char_put_us
+			  << PMS (", write ") << run_put_us << endl
+			  << PMS ("Out: one at a time ") << char_get_us
+			  << PMS (", read ") << run_get_us << endl;
+}
+
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method checks and times the conversion of numbers to decimal text.
+ *  \details Every 16-bit number, unsigned and signed, is converted both by the
+ *  library's functions and by \c ems_u16_to_dec(), and the two results compared;
+ *  so are the 32-bit numbers \c FORMAT_CHECK_STEP apart, the numbers on either side
+ *  of each power of ten, and the largest and smallest. Then every 16-bit number and
+ *  the same spread of 32-bit ones is converted by each function with nothing else
+ *  going on, to time them. The results are printed straight to the serial port.
+ */
+
+void task_console::benchmark_format (void)
+{
+	char library[12];
+	char fast[12];
+	uint32_t checked = 0, wrong = 0;
+	uint32_t lib_16_us, fast_16_us, lib_32_us, fast_32_us;
+	uint32_t start;
+
+	uint16_t num16 = 0;
+	do
+	{
+		utoa (num16, library, 10);
+		ems_u16_to_dec (num16, fast);
+		wrong += (strcmp (library, fast) != 0);
+
+		// The signed number is printed the way the int16_t inserter does it
+		int16_t signed16 = (int16_t)num16;
+		itoa (signed16, library, 10);
+		fast[0] = '-';
+		ems_u16_to_dec ((signed16 < 0) ? 0 - num16 : num16, fast + (signed16 < 0));
+		wrong += (strcmp (library, fast) != 0);
+
+		checked += 2;
+	}
+	while (++num16 != 0);
+
+	uint32_t num32 = 0;
+	uint32_t power = 1;
+	for (;;)
+	{
+		for (int8_t offset = -1; offset <= 1; offset++)
+		{
+			uint32_t number = num32 + offset;
+			ultoa (number, library, 10);
+			ems_u32_to_dec (number, fast);
+			wrong += (strcmp (library, fast) != 0);
+
+			int32_t signed32 = (int32_t)number;
+			ltoa (signed32, library, 10);
+			fast[0] = '-';
+			ems_u32_to_dec ((signed32 < 0) ? 0 - number : number,
+							fast + (signed32 < 0));
+			wrong += (strcmp (library, fast) != 0);
+
+			checked += 2;
+		}
+
+		// Go on to whichever comes next, a step or a power of ten
+		if (power <= 0xFFFFFFFFUL / 10 && power * 10 < num32 + FORMAT_CHECK_STEP)
+		{
+			power *= 10;
+			num32 = power;
+		}
+		else if (num32 <= 0xFFFFFFFFUL - FORMAT_CHECK_STEP)
+		{
+			num32 = (num32 / FORMAT_CHECK_STEP + 1) * FORMAT_CHECK_STEP;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	start = BENCH_MICROSECONDS ();
+	num16 = 0;
+	do
+	{
+		utoa (num16, library, 10);
+	}
+	while (++num16 != 0);
+	lib_16_us = BENCH_MICROSECONDS () - start;
+
+	start = BENCH_MICROSECONDS ();
+	do
+	{
+		ems_u16_to_dec (num16, fast);
+	}
+	while (++num16 != 0);
+	fast_16_us = BENCH_MICROSECONDS () - start;
+
+	start = BENCH_MICROSECONDS ();
+	for (num32 = 0; num32 <= 0xFFFFFFFFUL - FORMAT_CHECK_STEP;
+		 num32 += FORMAT_CHECK_STEP)
+	{
+		ultoa (num32, library, 10);
+	}
+	lib_32_us = BENCH_MICROSECONDS () - start;
+
+	start = BENCH_MICROSECONDS ();
+	for (num32 = 0; num32 <= 0xFFFFFFFFUL - FORMAT_CHECK_STEP;
+		 num32 += FORMAT_CHECK_STEP)
+	{
+		ems_u32_to_dec (num32, fast);
+	}
+	fast_32_us = BENCH_MICROSECONDS () - start;
+
+	*p_serial << PMS ("Number format check, ") << checked << PMS (" numbers, ")
+			  << wrong << PMS (" wrong") << endl
+			  << PMS ("16 bit: utoa ") << lib_16_us
+			  << PMS (" us, pairs ") << fast_16_us << PMS (" us") << endl
+			  << PMS ("32 bit: ultoa ") << lib_32_us
+			  << PMS (" us, pairs ") << fast_32_us << PMS (" us") << endl;
+}
+
+#endif // QUEUE_BENCHMARK
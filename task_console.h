@@ -0,0 +1,120 @@
+//*************************************************************************************
+/** \file task_console.h
+ *    This file contains the header for a task which takes everything the other tasks
+ *    print out of the print queue and sends it to the serial port, so that only one
+ *    task ever writes to the port.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, console output through a single writer task
+ *    \li 10-18-26 Characters are taken out of the queue in runs; print queue benchmark
+ *    \li 10-18-26 Check and time the division-free number conversion at startup
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+// This define prevents this .h file from being included multiple times in a .cpp file
+#ifndef _TASK_CONSOLE_H_
+#define _TASK_CONSOLE_H_
+
+#include <stdlib.h>                         // Prototype declarations for I/O functions
+
+#include "FreeRTOS.h"                       // Primary header for FreeRTOS
+#include "task.h"                           // Header for FreeRTOS task functions
+
+#include "frt_task.h"                       // ME405/507 base task class
+#include "frt_text_queue.h"                 // Header for a "<<" queue class
+#include "rs232int.h"                       // ME405/507 library for serial comm.
+
+
+/// The most characters the task takes out of the print queue at once
+#define CONSOLE_BUFFER_SIZE		32
+
+/** This is the number of times the print queue benchmark (built with
+ *  \c -DQUEUE_BENCHMARK) fills and empties the queue each way. 
+ */
+#define QUEUE_BENCH_ROUNDS		100
+
+/** This is the spacing of the 32-bit numbers whose conversion to text is checked by
+ *  the benchmark. Every 8 and 16-bit number is checked; there are too many 32-bit
+ *  ones, so a spread of them is taken, more finely on a PC, which is much faster. 
+ */
+#ifdef GCC_POSIX_HOST
+	#define FORMAT_CHECK_STEP	4093UL
+#else
+	#define FORMAT_CHECK_STEP	65521UL
+#endif
+
+/** This gives the time in microseconds by which the benchmarks are timed. The AVR's
+ *  RTOS tick will do, but the host build only takes a tick once every task waits,
+ *  which none does while the benchmark runs, so there it's read from the PC's clock.
+ */
+#ifdef GCC_POSIX_HOST
+	#include "host_hardware.h"
+	#define BENCH_MICROSECONDS()	host_microseconds ()
+#else
+	#define BENCH_MICROSECONDS()	((uint32_t)xTaskGetTickCount () * portTICK_RATE_MS \
+									 * 1000UL)
+#endif
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This task sends the contents of the print queue out of the serial port.
+ *  \details Every other task prints into \c print_ser_queue, which only takes as long
+ *  as copying the characters; none of them waits for the serial port. This task
+ *  sleeps until something is put in the queue, then moves characters from the queue
+ *  to the port until the queue is empty. As this is the only task which writes to the
+ *  port, lines from different tasks don't get mixed together, and anything which was
+ *  written to the queue in one piece comes out in one piece. If the queue fills up,
+ *  what doesn't fit is thrown away and counted rather than making the printing task
+ *  wait; see \c frt_text_queue::get_dropped().
+ *
+ *  When built with \c -DQUEUE_BENCHMARK, the task first times filling and emptying
+ *  the print queue a character at a time and in runs, and prints how long each took.
+ *  It runs before any other task gets going, so nothing else is timed with it, but
+ *  the queue's high water mark afterwards includes the benchmark's. Then it checks
+ *  that \c ems_u16_to_dec() and \c ems_u32_to_dec() give the same text as \c utoa(),
+ *  \c itoa(), \c ltoa() and \c ultoa(), and times them against one another. 
+ */
+class task_console : public frt_task
+{
+private:
+	// No private variables or methods for this class
+
+protected:
+	/// The queue out of which characters are taken
+	frt_text_queue* p_queue;
+
+	// Send characters to the serial port once there's room for them
+	void send (const char* p_data, uint16_t count);
+
+	#ifdef QUEUE_BENCHMARK
+		// Time the print queue a character at a time and in runs
+		void benchmark (void);
+
+		// Check and time the conversion of numbers to decimal text
+		void benchmark_format (void);
+	#endif
+
+public:
+	// This constructor creates a task which copies the print queue to a serial port
+	task_console (const char*, unsigned portBASE_TYPE, size_t, emstream*,
+				  frt_text_queue*, portSTACK_TYPE* = NULL);
+
+	/** This method is called by the RTOS once to run the task loop for ever and ever.
+	 */
+	void run (void);
+};
+
+#endif // _TASK_CONSOLE_H_
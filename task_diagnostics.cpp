@@ -0,0 +1,223 @@
+//*************************************************************************************
+/** \file task_diagnostics.cpp
+ *    This file contains the source for a task which keeps an eye on how much stack
+ *    each task and how much heap the program actually uses, so that the stack sizes
+ *    given to the tasks in main() can be set from measurements rather than guesses.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, stack and heap profiling task
+ *    \li 10-18-26 Report how full the print queue got and what it threw away
+ *    \li 10-18-26 Report how many user interface progress updates were merged
+ *    \li 10-18-26 A report is printed at the end of every session, not just the first
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include <string.h>                         // Functions for C string handling
+
+#include "task_diagnostics.h"               // Header for this file
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This constructor creates a stack and heap profiling task.
+ *  \details The recorded minima start out as large as they can be, so the first
+ *  sample of each one is always a new low and gets printed.
+ *  @param a_name A character string which will be the name of this task
+ *  @param a_priority The priority at which this task will initially run (default: 0)
+ *  @param a_stack_size The size of this task's stack in bytes
+ *                      (default: configMINIMAL_STACK_SIZE)
+ *  @param p_ser_dev Pointer to a serial device (port, radio, SD card, etc.) which can
+ *                   be used by this task to communicate (default: NULL)
+ *  @param p_stack_buffer Pointer to a statically allocated array to be used as the
+ *                   task's stack, or NULL to take it from the heap (default: NULL)
+ */
+
+task_diagnostics::task_diagnostics (const char* a_name,
+									unsigned portBASE_TYPE a_priority,
+									size_t a_stack_size,
+									emstream* p_ser_dev,
+									portSTACK_TYPE* p_stack_buffer
+								   )
+	: frt_task (a_name, a_priority, a_stack_size, p_ser_dev, p_stack_buffer)
+{
+	for (uint8_t index = 0; index < DIAG_MAX_TASKS; index++)
+	{
+		min_stack_free[index] = (size_t)(-1);
+		task_names[index] = NULL;
+	}
+	min_idle_free = (size_t)(-1);
+	min_heap_free = (size_t)(-1);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method samples every task's stack high water mark and the free heap.
+ *  \details The tasks are found by walking the list kept by \c frt_task, beginning
+ *  with the most recently created one, so a task's index into the arrays is its
+ *  position in that list. A line is printed each time something reaches a new low.
+ */
+
+void task_diagnostics::sample (void)
+{
+	size_t free_now;
+	uint8_t index = 0;
+
+	for (frt_task* p_task = last_created_task_pointer;
+		 p_task != NULL && index < DIAG_MAX_TASKS;
+		 p_task = p_task->get_previous_task (), index++)
+	{
+		// A task whose run() method has exited has a zero handle, and FreeRTOS would
+		// answer questions about a zero handle with the calling task's numbers, so
+		// such a task just keeps the figures it had the last time it was running
+		if (!*p_task)
+		{
+			continue;
+		}
+
+		// The name lives in the task's control block, which is never freed, so it
+		// can still be printed after the task has stopped
+		if (task_names[index] == NULL)
+		{
+			task_names[index] = p_task->get_name ();
+		}
+
+		free_now = p_task->stack_left ();
+		if (free_now < min_stack_free[index])
+		{
+			min_stack_free[index] = free_now;
+			*p_serial << PMS ("Stack low: ") << task_names[index] << PMS (" ")
+					  << (uint16_t)free_now << PMS ("/")
+					  << (uint16_t)(p_task->get_total_stack ()) << endl;
+		}
+	}
+
+	free_now = uxTaskGetStackHighWaterMark (xTaskGetIdleTaskHandle ());
+	if (free_now < min_idle_free)
+	{
+		min_idle_free = free_now;
+		*p_serial << PMS ("Stack low: IDLE ") << (uint16_t)free_now << PMS ("/")
+				  << (uint16_t)configMINIMAL_STACK_SIZE << endl;
+	}
+
+	free_now = heap_left ();
+	if (free_now < min_heap_free)
+	{
+		min_heap_free = free_now;
+		*p_serial << PMS ("Heap low: ") << (uint16_t)free_now << PMS ("/")
+				  << (uint16_t)configTOTAL_HEAP_SIZE << endl;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method works out a recommended stack size for a task.
+ *  \details The margin is added to the most stack the task has been seen to use and
+ *  the result is rounded up to a multiple of 16 bytes, which keeps the numbers in
+ *  \c main() tidy without wasting much.
+ *  @param used The largest number of bytes the task has been seen to use
+ *  @return The recommended stack size in bytes
+ */
+
+size_t task_diagnostics::recommend (size_t used)
+{
+	return (((used + DIAG_STACK_MARGIN + 15) / 16) * 16);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method prints the table of used and recommended stack sizes.
+ *  \details The idle task's stack size is \c configMINIMAL_STACK_SIZE, which is set
+ *  in \c FreeRTOSConfig.h rather than in \c main(), so its recommendation belongs
+ *  there. The heap line shows how much of \c configTOTAL_HEAP_SIZE was ever needed.
+ *  The print queue line shows the most characters that were ever waiting in it and
+ *  how many were thrown away because it was full; if any were, it should be larger.
+ */
+
+void task_diagnostics::print_report (void)
+{
+	size_t used;
+	uint8_t index = 0;
+
+	*p_serial << endl << PMS ("Stack use this session") << endl
+			  << PMS ("Name\t\tUsed/Total\tRecommended") << endl
+			  << PMS ("----\t\t----------\t-----------") << endl;
+
+	for (frt_task* p_task = last_created_task_pointer;
+		 p_task != NULL && index < DIAG_MAX_TASKS;
+		 p_task = p_task->get_previous_task (), index++)
+	{
+		if (task_names[index] == NULL)
+		{
+			continue;
+		}
+
+		used = p_task->get_total_stack () - min_stack_free[index];
+		*p_serial << task_names[index] << PMS ("\t");
+		if (strlen (task_names[index]) < 8)
+		{
+			*p_serial << PMS ("\t");
+		}
+		*p_serial << (uint16_t)used << PMS ("/") << (uint16_t)(p_task->get_total_stack ())
+				  << PMS ("\t\t") << (uint16_t)recommend (used) << endl;
+	}
+
+	used = configMINIMAL_STACK_SIZE - min_idle_free;
+	*p_serial << PMS ("IDLE\t\t") << (uint16_t)used << PMS ("/")
+			  << (uint16_t)configMINIMAL_STACK_SIZE << PMS ("\t\t")
+			  << (uint16_t)recommend (used) << endl;
+
+	*p_serial << PMS ("Heap used: ") << (uint16_t)(configTOTAL_HEAP_SIZE - min_heap_free)
+			  << PMS ("/") << (uint16_t)configTOTAL_HEAP_SIZE << endl;
+
+	*p_serial << PMS ("Print queue used: ") << print_ser_queue->get_high_water ()
+			  << PMS ("/") << print_ser_queue->get_size () << PMS (", dropped: ")
+			  << print_ser_queue->get_dropped () << endl;
+
+	*p_serial << PMS ("UI progress updates merged: ") << to_ui->get_coalesced ()
+			  << endl;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method samples the stacks and heap until the session is over.
+ *  \details Once the mastermind task says the wheel is true, one last sample is
+ *  taken and the report is printed, once for each session. Sampling then carries on
+ *  quietly in case the stand is left running, but only new lows are printed until
+ *  the next session is over.
+ */
+
+void task_diagnostics::run (void)
+{
+	portTickType previous_ticks = get_tick_count ();
+	bool reported = false;
+
+	for (;;)
+	{
+		sample ();
+
+		if (session_finished && !reported)
+		{
+			print_report ();
+			reported = true;
+		}
+		else if (!session_finished)
+		{
+			reported = false;
+		}
+
+		runs++;
+		delay_from_to_ms (previous_ticks, DIAG_SAMPLE_MS);
+	}
+}
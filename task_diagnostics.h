@@ -0,0 +1,99 @@
+//*************************************************************************************
+/** \file task_diagnostics.h
+ *    This file contains the header for a task which keeps an eye on how much stack
+ *    each task and how much heap the program actually uses, so that the stack sizes
+ *    given to the tasks in main() can be set from measurements rather than guesses.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, stack and heap profiling task
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+// This define prevents this .h file from being included multiple times in a .cpp file
+#ifndef _TASK_DIAGNOSTICS_H_
+#define _TASK_DIAGNOSTICS_H_
+
+#include <stdlib.h>                         // Prototype declarations for I/O functions
+
+#include "FreeRTOS.h"                       // Primary header for FreeRTOS
+#include "task.h"                           // Header for FreeRTOS task functions
+
+#include "frt_task.h"                       // ME405/507 base task class
+#include "rs232int.h"                       // ME405/507 library for serial comm.
+
+#include "shares.h"                         // Global ('extern') queue declarations
+
+
+/// This is the most tasks, not counting the idle task, whose stacks can be watched
+#define DIAG_MAX_TASKS		8
+
+/// This is how often, in milliseconds, the stacks and heap are sampled
+#define DIAG_SAMPLE_MS		250
+
+/** This is how many bytes are added to the most stack a task has ever been seen to
+ *  use when a stack size is recommended. Interrupts are serviced on whichever task's
+ *  stack happens to be running, so the margin has to cover the deepest ISR as well.
+ */
+#define DIAG_STACK_MARGIN	40
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This task measures stack and heap usage and recommends stack sizes.
+ *  \details Every \c DIAG_SAMPLE_MS milliseconds the task walks the list of tasks
+ *  kept by \c frt_task, reads each task's stack high water mark and the amount of
+ *  free heap, and prints a line whenever a new low is seen. When the truing session
+ *  is over (\c session_finished is set by the mastermind task), it prints a table of
+ *  the stack each task used and a recommended size for it which can be copied into
+ *  the task constructor calls in \c main().
+ */
+class task_diagnostics : public frt_task
+{
+private:
+	// No private variables or methods for this class
+
+protected:
+	/// The fewest bytes ever seen free in each task's stack, in task list order
+	size_t min_stack_free[DIAG_MAX_TASKS];
+
+	/// The name of each task, saved so it can be printed after the task has stopped
+	const char* task_names[DIAG_MAX_TASKS];
+
+	/// The fewest bytes ever seen free in the idle task's stack
+	size_t min_idle_free;
+
+	/// The fewest bytes ever seen free in the FreeRTOS heap
+	size_t min_heap_free;
+
+	// Sample all the stacks and the heap, printing any new lows
+	void sample (void);
+
+	// Print the table of used and recommended stack sizes
+	void print_report (void);
+
+	// Work out a recommended stack size from the number of bytes used
+	size_t recommend (size_t used);
+
+public:
+	// This constructor creates a stack and heap profiling task
+	task_diagnostics (const char*, unsigned portBASE_TYPE, size_t, emstream*,
+	                  portSTACK_TYPE* = NULL);
+
+	/** This method is called by the RTOS once to run the task loop for ever and ever.
+	 */
+	void run (void);
+};
+
+#endif // _TASK_DIAGNOSTICS_H_
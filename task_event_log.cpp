@@ -0,0 +1,158 @@
+//*************************************************************************************
+/** \file task_event_log.cpp
+ *    This file contains the source for a task which streams the capture log of
+ *    sensor events out of the serial port, so that it can be saved on a PC and
+ *    played back later.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, capture of sensor events for replay
+ *    \li 10-18-26 Wait for room for the whole line, as it now goes into a queue
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include "task_event_log.h"                 // Header for this file
+
+
+// The task is only any use when there's a capture log for it to send
+#ifdef EVENT_CAPTURE
+
+/// The characters used to print numbers in hexadecimal
+static const char hex_digits[] = "0123456789ABCDEF";
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This constructor creates a task which streams out the capture log.
+ *  @param a_name A character string which will be the name of this task
+ *  @param a_priority The priority at which this task will initially run (default: 0)
+ *  @param a_stack_size The size of this task's stack in bytes
+ *                      (default: configMINIMAL_STACK_SIZE)
+ *  @param p_ser_dev Pointer to a serial device (port, radio, SD card, etc.) which can
+ *                   be used by this task to communicate (default: NULL)
+ *  @param p_stack_buffer Pointer to a statically allocated array to be used as the
+ *                   task's stack, or NULL to take it from the heap (default: NULL)
+ */
+
+task_event_log::task_event_log (const char* a_name,
+								unsigned portBASE_TYPE a_priority,
+								size_t a_stack_size,
+								emstream* p_ser_dev,
+								portSTACK_TYPE* p_stack_buffer
+							   )
+	: frt_task (a_name, a_priority, a_stack_size, p_ser_dev, p_stack_buffer)
+{
+	line_number = 0;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method prints one line of records.
+ *  \details The line is "@E", the line number, the records and a checksum, each in
+ *  hexadecimal and separated by spaces. The checksum is the low byte of the sum of
+ *  the line number and every byte of the records. The line is built in a buffer
+ *  first so that the scheduler is only suspended while it's actually being sent.
+ *  The print queue throws away what doesn't fit rather than waiting, so the task
+ *  waits here until there's room for the whole line; a line cut short would only be
+ *  thrown away on the PC for having the wrong checksum.
+ *  @param p_records A pointer to the records to be printed
+ *  @param count The number of records, from 1 to \c EVENT_LOG_LINE_WORDS
+ */
+
+void task_event_log::print_line (uint16_t* p_records, uint8_t count)
+{
+	char line[3 + 3 + 5 * EVENT_LOG_LINE_WORDS + 3 + 1];
+	char* p_char = line;
+	uint8_t checksum = line_number;
+
+	*p_char++ = '@';
+	*p_char++ = 'E';
+	*p_char++ = ' ';
+	*p_char++ = hex_digits[line_number >> 4];
+	*p_char++ = hex_digits[line_number & 0x0F];
+
+	for (uint8_t index = 0; index < count; index++)
+	{
+		uint16_t record = p_records[index];
+
+		checksum += (uint8_t)(record >> 8) + (uint8_t)record;
+		*p_char++ = ' ';
+		for (int8_t shift = 12; shift >= 0; shift -= 4)
+		{
+			*p_char++ = hex_digits[(record >> shift) & 0x0F];
+		}
+	}
+
+	*p_char++ = ' ';
+	*p_char++ = hex_digits[checksum >> 4];
+	*p_char++ = hex_digits[checksum & 0x0F];
+	*p_char = '\0';
+
+	// Leave room for the line endings, which may be two characters each
+	uint16_t length = (p_char - line) + 4;
+	for (;;)
+	{
+		vTaskSuspendAll ();
+		if (p_serial->tx_space () >= length)
+		{
+			break;
+		}
+		xTaskResumeAll ();
+		vTaskDelay (1);
+	}
+
+	*p_serial << endl << line << endl;
+	xTaskResumeAll ();
+
+	line_number++;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method empties the ring buffer every \c EVENT_LOG_PERIOD_MS.
+ *  \details Records are taken out of the ring buffer a line's worth at a time with
+ *  interrupts off, which takes a few microseconds, then printed with them back on.
+ */
+
+void task_event_log::run (void)
+{
+	portTickType previous_ticks = get_tick_count ();
+	uint16_t records[EVENT_LOG_LINE_WORDS];
+	uint8_t count;
+
+	for (;;)
+	{
+		do
+		{
+			count = 0;
+			portENTER_CRITICAL ();
+			while (count < EVENT_LOG_LINE_WORDS && event_log_get (&records[count]))
+			{
+				count++;
+			}
+			portEXIT_CRITICAL ();
+
+			if (count > 0)
+			{
+				print_line (records, count);
+			}
+		}
+		while (count == EVENT_LOG_LINE_WORDS);
+
+		runs++;
+		delay_from_to_ms (previous_ticks, EVENT_LOG_PERIOD_MS);
+	}
+}
+
+#endif // EVENT_CAPTURE
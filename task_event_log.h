@@ -0,0 +1,69 @@
+//*************************************************************************************
+/** \file task_event_log.h
+ *    This file contains the header for a task which streams the capture log of
+ *    sensor events out of the serial port, so that it can be saved on a PC and
+ *    played back later.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, capture of sensor events for replay
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+// This define prevents this .h file from being included multiple times in a .cpp file
+#ifndef _TASK_EVENT_LOG_H_
+#define _TASK_EVENT_LOG_H_
+
+#include <stdlib.h>                         // Prototype declarations for I/O functions
+
+#include "FreeRTOS.h"                       // Primary header for FreeRTOS
+#include "task.h"                           // Header for FreeRTOS task functions
+
+#include "frt_task.h"                       // ME405/507 base task class
+#include "rs232int.h"                       // ME405/507 library for serial comm.
+
+#include "event_log.h"                      // The capture log's ring buffer
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This task empties the capture log's ring buffer out of the serial port.
+ *  \details Every \c EVENT_LOG_PERIOD_MS milliseconds the task takes records out of
+ *  the ring buffer and prints them as lines of hexadecimal text, in the format given
+ *  in \c event_log.h. The scheduler is suspended while each line is printed so that
+ *  other tasks' printouts can't get into the middle of it.
+ */
+class task_event_log : public frt_task
+{
+private:
+	// No private variables or methods for this class
+
+protected:
+	/// The number of the next line to be printed, so lost lines can be spotted
+	uint8_t line_number;
+
+	// Print one line of records
+	void print_line (uint16_t* p_records, uint8_t count);
+
+public:
+	// This constructor creates a task which streams out the capture log
+	task_event_log (const char*, unsigned portBASE_TYPE, size_t, emstream*,
+					portSTACK_TYPE* = NULL);
+
+	/** This method is called by the RTOS once to run the task loop for ever and ever.
+	 */
+	void run (void);
+};
+
+#endif // _TASK_EVENT_LOG_H_
@@ -4,6 +4,22 @@
  * 
  *  Revisions:
  *    \li 03-13-13 HL, TJ, & SG mastermind runs the truing algorithm, v0.1
+ *    \li 10-18-26 sets session_finished when the wheel is true
+ *    \li 10-18-26 sends measurements, offsets, phases and timings as binary telemetry
+ *    \li 10-18-26 user commands: skip, re-measure, abort, tolerance, next session
+ *    \li 10-18-26 sleeps waiting for answers, which can come from the acknowledge button
+ *    \li 10-18-26 plans the next spoke while the user works; no pause after measuring
+ *    \li 10-18-26 live gauge which answers the prompt once the spoke is in tolerance
+ *    \li 10-18-26 asks for a number of quarter turns, learning each spoke's gain
+ *    \li 10-18-26 says to try again after a wrong-way adjustment; flange model
+ *    \li 10-18-26 adjusts several spokes between measurings, in the shortest order
+ *    \li 10-18-26 trues the rim radially and sideways together if the user asks
+ *    \li 10-18-26 maps spoke tensions and keeps them from getting more uneven
+ *    \li 10-18-26 works in micrometres; pots are calibrated between sessions
+ *    \li 10-18-26 the spoke counter relearns spoke spacing and index mark per wheel
+ *    \li 10-18-26 a named wheel is homed, and starts from what was learned last time
+ *    \li 10-18-26 room for wheels of up to MAX_SPOKES spokes
+ *    \li 10-18-26 the number of spokes can be changed until the wheel is measured
  *
  *  License:
  *    This file is copyright 2013 by Hamilton Little, Trevor Jones and Sean Green 
@@ -24,8 +40,47 @@
 #include "frt_text_queue.h"                 // Header for text queue class
 #include "shares.h"                         // Shared inter-task communications
 #include "mastermind.h"
+#include "spoke_counter.h"                  // Counts spokes; knows the index mark
+#include "flange_model.h"                   // Which flange each spoke goes to
+#include "gain_model.h"                     // How far a quarter turn moves the rim
+#include "route_planner.h"                  // Which spokes to adjust, in what order
+#include "combined_optimiser.h"             // Sideways and radial truing together
+#include "tension_map.h"                    // Spoke tensions read as the wheel turns
+#include "telemetry.h"                      // Binary telemetry records
+#include "wheel_history.h"                  // What's known about wheels seen before
 #include "task_mastermind.h"
 
+
+/** This flag is set once the wheel is within tolerance and the session is over */
+volatile bool session_finished = false;
+
+/** This flag is set once the session has measured the wheel with the number of spokes
+ *  it has now, after which the user can't change the number */
+volatile bool wheel_measured = false;
+
+/** This flag is set by the user interface to give up on the session being run */
+volatile bool abort_session = false;
+
+/** A wheel is true once every spoke's offset is less than this many micrometres; the
+ *  user can change it */
+volatile uint16_t true_tolerance = TRUE_TOLERANCE_DEFAULT;
+
+// set by the user interface to say which pot to calibrate, and where it's been set
+volatile uint8_t cal_channel = RIM_CHANNEL;
+volatile int16_t cal_microns = 0;
+
+// set by the user to have the spoke being adjusted shown on a live gauge
+volatile bool live_gauge = false;
+
+// set by the user to true the rim radially as well, on a stand with the second pot
+volatile bool radial_truing = false;
+
+// set by the user to read spoke tensions as the wheel is measured, with a tensiometer
+volatile bool tension_mapping = false;
+
+// set by the user to the number of the wheel on the stand, or 0 if it's not named
+volatile uint8_t wheel_number = 0;
+
 //-------------------------------------------------------------------------------------
 /** \brief Runs the truing algorithm developed for the project.
  *  @param a_name A character string which will be the name of this task
@@ -34,14 +89,17 @@
  *                      (default: configMINIMAL_STACK_SIZE)
  *  @param p_ser_dev Pointer to a serial device (port, radio, SD card, etc.) which can
  *                   be used by this task to communicate (default: NULL)
+ *  @param p_stack_buffer Pointer to a statically allocated array to be used as the
+ *                   task's stack, or NULL to take it from the heap (default: NULL)
  */
 
 task_mastermind::task_mastermind (const char* a_name, 
 								 unsigned portBASE_TYPE a_priority, 
 								 size_t a_stack_size,
-								 emstream* p_ser_dev
+								 emstream* p_ser_dev,
+								 portSTACK_TYPE* p_stack_buffer
 								)
-	: frt_task (a_name, a_priority, a_stack_size, p_ser_dev)
+	: frt_task (a_name, a_priority, a_stack_size, p_ser_dev, p_stack_buffer)
 {
 	// Nothing is done in the body of this constructor. All the work is done in the
 	// call to the frt_task constructor on the line just above this one
@@ -50,111 +108,476 @@ task_mastermind::task_mastermind (const char* a_name,
 
 //-------------------------------------------------------------------------------------
 /** \brief This contains the truing algorithm logic for the stand. 
- *  \details It is the main driver for the project.
+ *  \details It is the main driver for the project. Each session measures the wheel,
+ * 	then plans which spokes to adjust before measuring it again and goes round them,
+ * 	having the user adjust each, over and over, until every spoke is within 
+ * 	\c true_tolerance. The spokes in a plan are the worst ones, visited in the order
+ * 	which turns the wheel least (see \c route_planner.h). The next measuring goes
+ * 	on to the worst spoke which wasn't in the plan, so that the wheel is usually
+ * 	near the first spoke of the next plan once the measuring is done.
+ * 
+ * 	The user is told which way to turn the spoke and by how many quarter turns. How
+ * 	far a quarter turn moves the rim is learned from each adjustment, by comparing
+ * 	the spoke's offset before with its offset once the wheel has been measured again.
+ * 	Which way to turn a spoke the first time comes from the flange it goes to, so
+ * 	if the offset moves the wrong way, the user is told to try again, and the spoke
+ * 	is put first in the next plan. If the same spoke goes the wrong way twice
+ * 	running, it must be on the other flange, and the flange model is corrected.
+ * 
+ * 	With the live gauge on, the spoke is read over and over while the user adjusts
+ * 	it, and its offset is shown as it changes. Once it has stayed within tolerance
+ * 	for \c GAUGE_SETTLE_READINGS readings, the prompt is answered for the user; as
+ * 	nobody knows how far the spoke was turned, nothing is learned from it. At a
+ * 	prompt the user can instead skip the spoke, which goes on to the next one in the
+ * 	plan, or have the wheel measured again straight away. The user can abort a
+ * 	session at any time. Once a session is over, the next one starts when the user
+ * 	says so.
+ * 
+ * 	With radial truing on, the second pot's readings are taken as well, and how far
+ * 	a quarter turn moves the rim in is learned the same way. Spokes are then planned
+ * 	and turned by the combined optimiser, which weighs the sideways and radial
+ * 	errors together (see \c combined_optimiser.h), and the wheel is true once both
+ * 	are within tolerance at every spoke.
+ * 
+ * 	With tension mapping on, the tensiometer is read at each spoke as well. A spoke
+ * 	which is too tight isn't tightened, nor one too loose loosened; a neighbour on
+ * 	the other flange is turned the other way instead (see \c tension_map.h).
+ * 
+ * 	The pots' readings are turned into micrometres by their calibrations (see
+ * 	\c pot_calibration.h), so offsets, tolerances and what's sent to the recorder
+ * 	are all in micrometres. Between sessions, the user can calibrate either pot.
+ * 
+ * 	A wheel the user has named is homed at the start of the session: it's turned
+ * 	until the index mark has been found, and the spokes are numbered from it, so
+ * 	they're the same spokes every time it's on the stand. If it's been trued before,
+ * 	the flange and gain models start from what was learned then (see
+ * 	\c wheel_history.h), and the user is told which spoke has moved most since.
+ * 	When the wheel is true, what's been learned is saved for next time.
  */
 void task_mastermind::run (void)
 {		
-	int16_t spokes[32]; // the array of measurements of the wheel
+	// the measurements of the wheel, one for each spoke; like the arrays below, it's
+	// kept out of the stack, as a wheel can have up to MAX_SPOKES spokes
+	static int16_t spokes[MAX_SPOKES];
+	// the radial measurements, and the combined errors the planner goes by, which
+	// are only needed with radial truing on
+	static int16_t radial[MAX_SPOKES];
+	static int16_t combined[MAX_SPOKES];
+	int16_t radial_avg;	// the average of the radial readings
+	bool radial_now;	// true if the wheel was measured radially this time
+	bool radial_planned;	// true if the plan being carried out is a combined one
+	const int16_t* p_errors;	// the errors the planner goes by
+	static int16_t tension[MAX_SPOKES];	// the tensiometer's reading at each spoke
+	bool tension_now;	// true if the tensions were read this time
+	int16_t avg_tension;	// the average of the tensiometer's readings
 	int16_t avg; // the average value of the measurement readings
-	bool finished = false; // set to true when the wheel is within alignment
-	uint8_t ndx;
-	uint8_t worst_spoke;	// the spoke with the largest absolute offset
-	int16_t worst_spoke_val;	// the worst spokes offset
-	uint8_t worst_spoke_prev;	// the previously worst spoke
-	uint8_t prev_spoke;	// the last spoke information was printed to user about
+	uint8_t spoke;	// the spoke being adjusted
+	int16_t spoke_val;	// its offset when the wheel was measured
+	uint16_t iteration;	// how many spokes have been adjusted so far
+	portTickType phase_start;	// when the phase now going on started
+	messages_from_ui answer;	// what the user said to do at a prompt
+	uint8_t next_spoke;	// the spoke the next measuring is to stop at
+	uint8_t stop;	// which of the plan's spokes is being adjusted
+	bool gauge_running;	// true once the live gauge has started at this prompt
+	bool answered_by_gauge;	// true if the live gauge answered the prompt
+	uint8_t settled;	// live gauge readings in a row within tolerance
+	int16_t offset;	// the live gauge's offset of the spoke being adjusted
+	// quarter turns each spoke in the plan was tightened by as asked; negative if it
+	// was loosened, zero if it wasn't turned or nobody knows by how much
+	int8_t turns[PLAN_MAX_STOPS];
+	uint8_t turned[PLAN_MAX_STOPS];	// the spoke turned at each stop in the plan
+	int16_t before[PLAN_MAX_STOPS];	// the offset of each spoke before it was turned
+	int16_t before_radial[PLAN_MAX_STOPS];	// and its radial offset, if it was planned
+	int16_t change;	// how much a spoke's offset changed when it was turned
+	spoke_set retry;	// a bit for each spoke the user was told to try again
+	uint8_t wheel;	// the named wheel on the stand, or 0 if it isn't to be remembered
+	bool returning;	// true until a wheel seen before is first measured
+	uint8_t counted;	// the number of spokes the wheel was being measured with
 	
 	
 	
 	// disable the watchdog timer, as we have been warned it can cause problems
 	wdt_disable();
 	
-	// greet the user, tell them we're going to measure the wheel
-	to_ui->put(HELLO);
-	to_ui->put(MEASURING);
-	
-	// create mastermind and get the first set of readings on the wheel
-	mastermind *master = new mastermind(p_serial, new pot_driver(p_serial));	
-	avg = master->find_avg(master->measure_all(spokes));
-	vTaskDelay (configMS_TO_TICKS (1000)); // pause for 1 second (looks cool)
-	
-	// tell us about all the information we just found (for debugging)
-	*p_serial << "Measurements are: ";
-	for(ndx = 0; ndx < max_spokes; ndx++) {
-		*p_serial << spokes[ndx] << " ";
+	// the spoke counter task sets up the number of spokes, and spokes are numbered
+	// round the wheel by it, so wait for that before doing anything
+	while(max_spokes == 0) {
+		vTaskDelay (1);
 	}
-	*p_serial << endl;
-	*p_serial << "Average is; " << avg << endl;
 	
-	// Convert raw measuremnts offset values based on average value
-	master->con_to_offs(spokes, avg);
+	// create mastermind and the telemetry sender
+	// (all are static so they live in fixed RAM rather than on the heap)
+	static pot_driver pot (p_serial);
+	static pot_calibration rim_cal (RIM_CHANNEL);
+	static pot_calibration hop_cal (HOP_CHANNEL);
+	static mastermind master (p_serial, &pot, &rim_cal, &hop_cal);
+	static telemetry telem (p_serial);
+	static flange_model flanges;
+	static gain_model gains (&flanges);
+	static gain_model radial_gains (NULL, HOP_OUT_READS_HIGHER ? -1 : 1);
+	static combined_optimiser optimiser (&gains, &radial_gains);
+	static route_planner planner;
+	static tension_map tensions;
+	static wheel_history history;
 	
-	// tell us what the offsets are (for debugging)
-	*p_serial << "Offsets are: ";
-	for(ndx = 0; ndx < max_spokes; ndx++) {
-		*p_serial << spokes[ndx] << " ";
-	}
-	*p_serial << endl;
+	// greet the user
+	to_ui->put(HELLO);
 	
-	worst_spoke = master->find_worst(spokes);
-	worst_spoke_val = spokes[worst_spoke];
-	worst_spoke_prev = -128;
-	prev_spoke = -128;
-
-	while(!finished) {
+	for (;;) {
+		iteration = 0;
+		abort_session = false;
+		wheel_measured = false;
+		session_finished = false;
 		
-		// tell the user where we're going, and go to it
-		*p_serial << "and the worst spoke is " << worst_spoke << " with offset of " 
-				  << worst_spoke_val << endl;
-		desired_spoke = worst_spoke;
+		// throw away answers left over from the last session, such as an abort
+		while(!from_ui->is_empty()) {
+			from_ui->get();
+		}
 		
-		// print out where we are as we go to the worst spoke
-		while(spoke_count != worst_spoke) {
-			if(prev_spoke != spoke_count) {
-				*p_serial << "going to " << worst_spoke << " at " << spoke_count << endl;
-				prev_spoke = spoke_count;
-			}
+		// it may be a new wheel, so its spokes' flanges and gains must be learned
+		// afresh, starting from the side the user said the first spoke is on
+		flanges.set_first(left_or_right);
+		spoke_counter_new_wheel();
+		gains.reset();
+		radial_gains.reset();
+		radial_planned = false;
+		retry = 0;
+		for(stop = 0; stop < PLAN_MAX_STOPS; stop++) {
+			turns[stop] = 0;
 		}
 		
-		// logic missing here to tell the us		worst_spoke_prev = worst_spoke;er whether to tighten or loosen the spoke
-		to_ui->put(TIGHTEN);
-		while(from_ui->is_empty() || from_ui->get() != DID_THAT)	// wait for response
-			;
+		// a named wheel is homed, so its spokes are numbered from its index mark;
+		// if there isn't one, spoke 0 is wherever the wheel is, and it can't be
+		// remembered. If it's been here before, it starts from what was learned then
+		wheel = wheel_number;
+		returning = false;
+		if(wheel != 0) {
+			to_ui->put(HOMING);
+			if(!master.home()) {
+				wheel = 0;
+				if(!abort_session) {
+					to_ui->put(NOT_HOMED);
+				}
+			}
+			else {
+				to_ui->put(HOMED);
+				returning = history.load(wheel, max_spokes);
+			}
+		}
+		if(returning) {
+			flanges.load(history.get_flanges());
+			gains.load(history.get_gains());
+			to_ui->put(WELCOME_BACK, wheel, 0, history.get_sessions());
+		}
 		
-		// get new measurements after fixing a spoke
-		to_ui->put(MEASURING);
-		master->measure_all(spokes);
-		avg = master->find_avg(spokes);
-		vTaskDelay (configMS_TO_TICKS (1000)); // pause for 1 second (it looks cool)
+		// the first measuring stops where the wheel already is
+		next_spoke = master.spoke_index(spoke_count);
 		
-		// tell us about all the information we just found (for debugging)
-		*p_serial << "Measurements are: ";
-		for(ndx = 0; ndx < max_spokes; ndx++) {
-			*p_serial << spokes[ndx] << " ";
+		// keep going until we're within tolerance or the user gives up
+		for (;;) {
+			// tell the user we're going to measure the wheel, and get the readings
+			to_ui->put(MEASURING);
+			telem.state(TELEM_PHASE_MEASURE, iteration);
+			phase_start = xTaskGetTickCount();
+			radial_now = radial_truing;
+			tension_now = tension_mapping;
+			counted = max_spokes;
+			master.measure_all(spokes, next_spoke, radial_now ? radial : NULL,
+							   tension_now ? tension : NULL);
+			
+			// the user can say how many spokes there are until the wheel has been
+			// measured; if they did while it was being measured, it's measured again
+			portENTER_CRITICAL();
+			wheel_measured = (max_spokes == counted) || abort_session;
+			portEXIT_CRITICAL();
+			if(!wheel_measured) {
+				next_spoke = master.spoke_index(spoke_count);
+				continue;
+			}
+			avg = master.find_avg(spokes);
+			telem.timing(TELEM_PHASE_MEASURE, 
+						 (xTaskGetTickCount() - phase_start) * portTICK_RATE_MS);
+			
+			// send all the information we just found to whoever is recording
+			telem.measurements(spokes, max_spokes, avg);
+			
+			// Convert raw measuremnts offset values based on average value
+			master.con_to_offs(spokes, avg);
+			telem.offsets(spokes, max_spokes);
+			if(returning && !abort_session) {
+				spoke = history.most_changed(spokes, &change);
+				to_ui->put(MOVED_MOST, spoke, 0, change);
+				returning = false;
+			}
+			if(radial_now) {
+				radial_avg = master.find_avg(radial);
+				master.con_to_offs(radial, radial_avg);
+				telem.offsets(radial, max_spokes, TELEM_RADIAL_OFFSETS);
+			}
+			if(tension_now) {
+				avg_tension = master.find_avg(tension);
+				telem.measurements(tension, max_spokes, avg_tension, TELEM_TENSIONS);
+				tensions.set(tension, avg_tension, max_spokes);
+			}
+			else {
+				tensions.clear();
+			}
+			
+			// learn from how far each spoke turned since the last measuring moved,
+			// unless it went the wrong way; then either the user turned it the
+			// wrong way, and is told to try again, or it's on the other flange, if
+			// it was the second time running
+			for(stop = 0; stop < planner.get_count(); stop++) {
+				if(turns[stop] == 0) {
+					continue;
+				}
+				spoke = turned[stop];
+				change = spokes[spoke] - before[stop];
+				if(ABS(change) < WRONG_WAY_MICRONS) {
+					gains.learn(spoke, turns[stop], change);
+				}
+				else if((change > 0) == (turns[stop] * gains.get_gain(spoke) > 0)) {
+					flanges.confirm(spoke);
+					gains.learn(spoke, turns[stop], change);
+					retry &= ~SPOKE_BIT(spoke);
+				}
+				else if(retry & SPOKE_BIT(spoke)) {
+					flanges.correct(spoke);
+					gains.forget(spoke);
+					gains.learn(spoke, turns[stop], change);
+					retry &= ~SPOKE_BIT(spoke);
+				}
+				else {
+					to_ui->put(TRY_AGAIN);
+					retry |= SPOKE_BIT(spoke);
+					turns[stop] = 0;
+					continue;
+				}
+				
+				// the radial change is learned from too, as long as the spoke was
+				// turned the way it was asked to be
+				if(radial_planned && radial_now) {
+					change = radial[spoke] - before_radial[stop];
+					radial_gains.learn(spoke, turns[stop], change);
+				}
+				turns[stop] = 0;
+			}
+			
+			// plan which spokes to adjust before measuring again, by their combined
+			// errors if the rim is being trued radially too; if there are none, the
+			// wheel is true
+			p_errors = spokes;
+			if(radial_now) {
+				optimiser.errors(spokes, radial, combined, max_spokes, true_tolerance);
+				p_errors = combined;
+			}
+			radial_planned = radial_now;
+			if(abort_session || planner.plan(p_errors, max_spokes,
+											 master.spoke_index(spoke_count),
+											 true_tolerance, retry) == 0) {
+				break;
+			}
+			next_spoke = planner.next_worst(p_errors, max_spokes);
+			
+			for(stop = 0; stop < planner.get_count(); stop++) {
+				spoke = planner.get_stop(stop);
+				spoke_val = spokes[spoke];
+				if(radial_planned) {
+					turns[stop] = optimiser.prescribe(spoke, spoke_val, radial[spoke]);
+				}
+				else {
+					turns[stop] = gains.prescribe(spoke, spoke_val);
+				}
+				
+				// if that would make the tensions more uneven, a neighbour is turned
+				// instead, and what's learned is how its own offset changes
+				if(!tensions.allows(spoke, turns[stop])) {
+					spoke = tensions.substitute(spoke, spoke_val, &flanges, &gains,
+												&turns[stop]);
+					spoke_val = spokes[spoke];
+				}
+				turned[stop] = spoke;
+				
+				// tell the recorder where we're going, and go to it; if the 
+				// measuring stopped at this spoke, we're there already
+				telem.worst(spoke, spoke_val);
+				telem.state(TELEM_PHASE_MOVE, iteration);
+				phase_start = xTaskGetTickCount();
+				master.go_to(spoke);
+				telem.timing(TELEM_PHASE_MOVE, 
+							 (xTaskGetTickCount() - phase_start) * portTICK_RATE_MS);
+				if(abort_session) {
+					break;
+				}
+				
+				telem.state(TELEM_PHASE_ADJUST, iteration);
+				phase_start = xTaskGetTickCount();
+				
+				// answers which came in before the prompt, such as from a bumped
+				// button, aren't answers to it
+				while(!from_ui->is_empty()) {
+					from_ui->get();
+				}
+				to_ui->put((turns[stop] > 0) ? TIGHTEN : LOOSEN, spoke, spoke, 
+						   ABS(turns[stop]));
+				
+				// sleep until the answer comes, keeping the live gauge up to date if
+				// it's on
+				gauge_running = false;
+				settled = 0;
+				answered_by_gauge = false;
+				while(!abort_session && !get_answer(&answer)) {
+					if(!live_gauge) {
+						gauge_running = false;
+						continue;
+					}
+					if(!gauge_running) {
+						master.gauge_start();
+						gauge_running = true;
+						settled = 0;
+					}
+					offset = master.gauge_read() - avg;
+					to_ui->put(GAUGE, spoke, spoke, offset);
+					settled = (ABS(offset) < true_tolerance) ? settled + 1 : 0;
+					if(settled >= GAUGE_SETTLE_READINGS) {
+						to_ui->put(DONE);
+						answer = DID_THAT;
+						answered_by_gauge = true;
+						break;
+					}
+				}
+				if(abort_session) {
+					answer = ABORT;
+				}
+				telem.timing(TELEM_PHASE_ADJUST, 
+							 (xTaskGetTickCount() - phase_start) * portTICK_RATE_MS);
+				
+				// only a spoke turned as asked is learned from; a skipped spoke is
+				// left alone and the next one in the plan is gone on to
+				if(answer == DID_THAT) {
+					iteration++;
+					before[stop] = spoke_val;
+					before_radial[stop] = radial[spoke];
+					if(answered_by_gauge) {
+						turns[stop] = 0;
+					}
+				}
+				else {
+					turns[stop] = 0;
+					if(answer != SKIP) {
+						// nothing was adjusted, so this spoke is likely to stay worst
+						next_spoke = spoke;
+						break;
+					}
+				}
+			}
+			if(abort_session) {
+				break;
+			}
 		}
-		*p_serial << endl;
-		*p_serial << "Average is; " << avg << endl;
 		
-		// Convert raw measuremnts offset values based on average value
-		master->con_to_offs(spokes, avg);
-		
-		// tell us what the offsets are (for debugging)
-		*p_serial << "Offsets are: ";
-		for(ndx = 0; ndx < max_spokes; ndx++) {
-			*p_serial << spokes[ndx] << " ";
+		// a named wheel which has been trued is remembered; one given up on isn't, as
+		// its last measuring may not have been finished
+		telem.state(TELEM_PHASE_DONE, iteration);
+		if(wheel != 0 && !abort_session) {
+			history.save(wheel, max_spokes, spokes, &flanges, &gains);
 		}
-		*p_serial << endl;
 		
-		// find the worst spoke again, and remember which one is was previously
-		worst_spoke_prev = worst_spoke;
-		worst_spoke = master->find_worst(spokes);	
-		worst_spoke_val = spokes[worst_spoke];
+		// let anyone waiting for the end of the session know, and tell the user nice
+		// job (or not, if they gave up)
+		session_finished = true;
+		if(abort_session) {
+			abort_session = false;
+			to_ui->put(ABORTED);
+		}
+		else {
+			if(wheel != 0) {
+				to_ui->put(WHEEL_SAVED, wheel, 0, history.get_sessions());
+			}
+			to_ui->put(GOODBYE);
+		}
+		to_ui->put(READY);
 		
-		// check if we're within tolerance
-		if(ABS(worst_spoke_val) < 10) {
-			finished = true;
+		// wait for the user to start the next session, by typing start or pressing
+		// the button; a pot can be calibrated in the meantime
+		for(;;) {
+			if(!get_answer(&answer)) {
+				continue;
+			}
+			if(answer == START || answer == DID_THAT) {
+				break;
+			}
+			calibrate(answer, &pot, (cal_channel == HOP_CHANNEL) ? &hop_cal : &rim_cal);
 		}
 	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method waits a little while for an answer from the user.
+ *  \details The task sleeps until an answer comes in, from the keyboard or the
+ *  acknowledge button, or \c ANSWER_WAIT_MS go by.
+ *  @param p_answer Where to put the answer
+ *  @return True if an answer came in, false if the time ran out first
+ */
+bool task_mastermind::get_answer (messages_from_ui* p_answer)
+{
+	return (xQueueReceive (from_ui->get_handle (), p_answer, 
+						   configMS_TO_TICKS (ANSWER_WAIT_MS)) == pdTRUE);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method carries out a command from the user to calibrate a pot.
+ *  \details A point is taken at the average of \c CAL_READINGS readings, one a tick,
+ *  so the pot's noise doesn't end up in the table. The user is told how each command
+ *  went. Anything else, such as an answer to a prompt that's gone, is ignored.
+ *  @param command What the user said to do
+ *  @param p_pot The pots
+ *  @param p_cal The calibration of the pot the user is calibrating
+ */
+void task_mastermind::calibrate (messages_from_ui command, pot_driver* p_pot,
+								 pot_calibration* p_cal)
+{
+	int32_t sum = 0;	// the readings taken for a point, added up
+	uint8_t points;	// how many points a new table has
 	
-	// tell the user nice job
-	to_ui->put(GOODBYE);
-}			
\ No newline at end of file
+	switch(command) {
+		case CAL_BEGIN:
+			p_cal->begin();
+			to_ui->put(CAL_STARTED, p_cal->get_channel());
+			break;
+			
+		case CAL_POINT:
+			for(uint8_t count = 0; count < CAL_READINGS; count++) {
+				sum += p_pot->get_value(p_cal->get_channel());
+				vTaskDelay(1);
+			}
+			sum = (sum + CAL_READINGS / 2) / CAL_READINGS;
+			if(p_cal->add_point((int16_t)sum, cal_microns)) {
+				to_ui->put(CAL_POINT_TAKEN, p_cal->get_pending(), 0, (int16_t)sum);
+			}
+			else {
+				to_ui->put(CAL_FAILED);
+			}
+			break;
+			
+		case CAL_SAVE:
+			points = p_cal->get_pending();
+			if(p_cal->save()) {
+				to_ui->put(CAL_SAVED, points);
+			}
+			else {
+				to_ui->put(CAL_FAILED);
+			}
+			break;
+			
+		case CAL_CLEAR:
+			p_cal->clear();
+			to_ui->put(CAL_CLEARED);
+			break;
+			
+		default:
+			break;
+	}
+}
@@ -4,6 +4,11 @@
  *
  *  Revisions:
  *    \li 03-13-13 HL, TJ, & SG mastermind runs the truing algorithm, v0.1
+ *    \li 10-18-26 the tolerance for a true wheel can be changed by the user
+ *    \li 10-18-26 the task sleeps while waiting for an answer from the user
+ *    \li 10-18-26 live gauge of the spoke being adjusted
+ *    \li 10-18-26 adjustments which went the wrong way are noticed and tried again
+ *    \li 10-18-26 tolerances are in micrometres
  *
  *  License:
  *    This file is copyright 2013 by Hamilton Little, Trevor Jones and Sean Green 
@@ -38,6 +43,31 @@
 #include "frt_shared_data.h"                // Header for thread-safe shared data
 
 #include "rs232int.h"                       // ME405/507 library for serial comm.
+#include "pot_driver.h"                     // The pots and tensiometer
+#include "pot_calibration.h"                // Pot readings to micrometres
+
+
+/** This is the tolerance the stand starts out with: the wheel is true once every
+ *  spoke's offset from the average is less than this many micrometres. 
+ */
+#define TRUE_TOLERANCE_DEFAULT	500
+
+/** This is the longest time, in milliseconds, the task sleeps waiting for an answer
+ *  before it looks to see if the session has been aborted. 
+ */
+#define ANSWER_WAIT_MS			50
+
+/** This is how many live gauge readings in a row, one every \c ANSWER_WAIT_MS, must be
+ *  within tolerance before the gauge answers the prompt by itself. A spoke passes
+ *  through the right tension while it's being turned, so one reading isn't enough. 
+ */
+#define GAUGE_SETTLE_READINGS	6
+
+/** An adjusted spoke's offset must change by at least this many micrometres the
+ *  wrong way before the adjustment is taken to have gone the wrong way; anything
+ *  less could be the pot's noise. 
+ */
+#define WRONG_WAY_MICRONS		300
 
 
 //-------------------------------------------------------------------------------------
@@ -52,11 +82,17 @@ private:
 	// No private variables or methods for this class
 
 protected:
-	// No protected variables or methods for this class
+	// Wait a little while for an answer from the user
+	bool get_answer (messages_from_ui* p_answer);
+
+	// Carry out a command from the user to calibrate a pot
+	void calibrate (messages_from_ui command, pot_driver* p_pot,
+					pot_calibration* p_cal);
 
 public:
 	// This constructor creates a generic task of which many copies can be made
-	task_mastermind (const char*, unsigned portBASE_TYPE, size_t, emstream*);
+	task_mastermind (const char*, unsigned portBASE_TYPE, size_t, emstream*,
+	                 portSTACK_TYPE* = NULL);
 
 	// This method is called by the RTOS once to run the task loop for ever and ever.
 	void run (void);
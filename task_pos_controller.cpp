@@ -4,6 +4,7 @@
  * 
  *  Revisions:
  *    \li 03-13-13 HL, TJ, & SG controls the wheel's position really well
+ *    \li 10-18-26 the controller's gains come from shared variables the user can set
  *
  *  License:
  *    This file is copyright 2013 by Hamilton Little, Trevor Jones and Sean Green 
@@ -28,6 +29,13 @@
 #include "task_pos_controller.h"
 
 
+/** This is the position controller's proportional gain, which the user can change */
+volatile uint8_t pos_gain_kp = POS_KP_DEFAULT;
+
+/** This is the position controller's integral gain, which the user can change */
+volatile uint8_t pos_gain_ki = POS_KI_DEFAULT;
+
+
 //-------------------------------------------------------------------------------------
 /** \brief Runs the PID controller used to actuate the motor which spins the wheel.
  *  @param a_name A character string which will be the name of this task
@@ -36,14 +44,17 @@
  *                      (default: configMINIMAL_STACK_SIZE)
  *  @param p_ser_dev Pointer to a serial device (port, radio, SD card, etc.) which can
  *                   be used by this task to communicate (default: NULL)
+ *  @param p_stack_buffer Pointer to a statically allocated array to be used as the
+ *                   task's stack, or NULL to take it from the heap (default: NULL)
  */
 
 task_pos_controller::task_pos_controller (const char* a_name, 
 								 unsigned portBASE_TYPE a_priority, 
 								 size_t a_stack_size,
-								 emstream* p_ser_dev
+								 emstream* p_ser_dev,
+								 portSTACK_TYPE* p_stack_buffer
 								)
-	: frt_task (a_name, a_priority, a_stack_size, p_ser_dev)
+	: frt_task (a_name, a_priority, a_stack_size, p_ser_dev, p_stack_buffer)
 {
 	// Nothing is done in the body of this constructor. All the work is done in the
 	// call to the frt_task constructor on the line just above this one
@@ -61,16 +72,19 @@ void task_pos_controller::run (void)
 	// disable the watchdog timer, as we have been warned it can cause problems
 	wdt_disable();
 
-	// the motor we use to spin the wheel to different positions
-	motordriver *ptr_to_md = new motordriver(p_serial, 2);
+	// the motor we use to spin the wheel to different positions. Like the controller
+	// below, it's static so it lives in fixed RAM rather than on the heap
+	static motordriver md (p_serial, 2);
 	
 	// the pos_controller will spin the wheel to whichever position we desire
-	pos_controller *controller = new pos_controller(p_serial, ptr_to_md, 200, 25, 3, 16);
+	static pos_controller controller (p_serial, &md, pos_gain_kp, pos_gain_ki, 3, 16);
 
 	
 	for(;;)
 	{
-		controller->update();
+		// pick up any new gains the user has set, then update the motor
+		controller.set_gains(pos_gain_kp, pos_gain_ki);
+		controller.update();
 			
 		vTaskDelay (configMS_TO_TICKS (1));
 	}
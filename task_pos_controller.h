@@ -54,7 +54,8 @@ protected:
 
 public:
 	// This constructor creates a generic task of which many copies can be made
-	task_pos_controller (const char*, unsigned portBASE_TYPE, size_t, emstream*);
+	task_pos_controller (const char*, unsigned portBASE_TYPE, size_t, emstream*,
+	                     portSTACK_TYPE* = NULL);
 
 	// This method is called by the RTOS once to run the task loop for ever and ever.
 	void run (void);
@@ -5,6 +5,8 @@
  *
  *  Revisions:
  *    \li 03-13-13 HL, TJ, & SG spoke counter don't miss a thang
+ *    \li 10-18-26 the count is passed on once a tick rather than nonstop
+ *    \li 10-18-26 the wheel starts with DEFAULT_SPOKES spokes until the user says
  *
  *  License:
  *    This file is copyright 2013 by Hamilton Little, Trevor Jones and Sean Green 
@@ -35,14 +37,17 @@
  *                      (default: configMINIMAL_STACK_SIZE)
  *  @param p_ser_dev Pointer to a serial device (port, radio, SD card, etc.) which can
  *                   be used by this task to communicate (default: NULL)
+ *  @param p_stack_buffer Pointer to a statically allocated array to be used as the
+ *                   task's stack, or NULL to take it from the heap (default: NULL)
  */
 
 task_spoke_count::task_spoke_count (const char* a_name, 
 								 unsigned portBASE_TYPE a_priority, 
 								 size_t a_stack_size,
-								 emstream* p_ser_dev
+								 emstream* p_ser_dev,
+								 portSTACK_TYPE* p_stack_buffer
 								)
-	: frt_task (a_name, a_priority, a_stack_size, p_ser_dev)
+	: frt_task (a_name, a_priority, a_stack_size, p_ser_dev, p_stack_buffer)
 {
 	// Nothing is done in the body of this constructor. All the work is done in the
 	// call to the frt_task constructor on the line just above this one
@@ -52,21 +57,25 @@ task_spoke_count::task_spoke_count (const char* a_name,
 //-------------------------------------------------------------------------------------
 /** \brief This method is called once by the RTOS scheduler. 
  *  \details It runs as an infinite loop, updating the shared variable spoke_count by
- * 	calling spoke_counter's update() function.
+ * 	calling spoke_counter's update() function once a tick. The counting itself is
+ * 	done by the sensor's interrupts, and the tasks which read spoke_count look at it
+ * 	no more often than that, so there's no point in spinning.
  */
 void task_spoke_count::run (void)
 {		
 	// disable the watchdog timer, as we have been warned it can cause problems
 	wdt_disable();
 	
-	// set up the motor's encoder to pass on to the pos_controller
-	wheel_encoder *wheel = new wheel_encoder(p_serial);
+	// set up the motor's encoder to pass on to the pos_controller. It's static so it
+	// lives in fixed RAM rather than on the heap, and is built once when we get here
+	static wheel_encoder wheel (p_serial);
 	
-	// create a new spoke_counter to count spokes as they go by
-	spoke_counter *spoker = new spoke_counter(p_serial, wheel, 32);
+	// create a spoke_counter to count spokes as they go by
+	static spoke_counter spoker (p_serial, &wheel, DEFAULT_SPOKES);
 
 	for(;;)
 	{
-		spoker->update();
+		spoker.update();
+		vTaskDelay (1);
 	}
 }
\ No newline at end of file
@@ -4,6 +4,25 @@
  *
  *  Revisions:
  *    \li 03-13-13 HL, TJ, & SG spoke counter don't miss a thang
+ *    \li 10-18-26 Wait for the goodbye to be sent before the session is over
+ *    \li 10-18-26 Keys are read from the serial port; printing goes to the print queue
+ *    \li 10-18-26 Messages are printed from a catalogue kept in program memory
+ *    \li 10-18-26 Spoke numbers are printed as they were when the message was sent
+ *    \li 10-18-26 Line-buffered command interpreter; the task sleeps on its queue
+ *    \li 10-18-26 A prompt may be answered with the acknowledge button instead
+ *    \li 10-18-26 Live gauge of the spoke being adjusted, printed over one line
+ *    \li 10-18-26 Prompts say how many quarter turns to tighten or loosen the spoke
+ *    \li 10-18-26 Radial truing can be switched on and off
+ *    \li 10-18-26 Tension mapping can be switched on and off
+ *    \li 10-18-26 Tolerance in micrometres; pots calibrated with the cal command
+ *    \li 10-18-26 Stats say how many spoke sensor edges were filtered and corrected
+ *    \li 10-18-26 The wheel on the stand can be named, so it's homed and remembered
+ *    \li 10-18-26 The spoke count and first spoke questions taken out, as the spokes
+ *                 command sets both
+ *    \li 10-18-26 The spokes command takes up to MAX_SPOKES spokes
+ *    \li 10-18-26 The cal command names the pot by its A/D channel's name
+ *    \li 10-18-26 The cal command's words must be typed whole
+ *    \li 10-18-26 The spokes command works until a session has measured the wheel
  *
  *  License:
  *    This file is copyright 2013 by Hamilton Little, Trevor Jones and Sean Green 
@@ -28,6 +47,15 @@
 #include "shared_data_receiver.h"
 #include "task_user_interface.h"                      // Header for this file
 #include "shares.h"
+#include "pos_controller.h"
+#include "task_mastermind.h"
+#include "mastermind.h"                       // Which A/D channel each pot is on
+#include "wheel_history.h"                  // How many wheels can be remembered
+
+
+/** This is true if the first spoke is on the left of the wheel and false if it's on
+ *  the right. The user sets it with the \c side command. */
+bool left_or_right = true;
 
 
 /** This constant sets how many RTOS ticks the task delays if there's nothing to do.
@@ -36,6 +64,42 @@
 const portTickType ticks_to_delay = ((configTICK_RATE_HZ / 1000) * 5);
 
 
+/** This is the text of each message the user interface can print, in the order of the
+ *  \c ui_messages. It's kept in program memory, so it takes no RAM. Each \c % is
+ *  filled in with a number when the message is printed. 
+ */
+static const char ui_catalogue[UI_NUM_MESSAGES][UI_MESSAGE_SIZE] PROGMEM =
+{
+	"Wake up Neo...",                                       // HELLO
+	"Follow the rabbit, Neo",                               // GOODBYE
+	"Tighten the spoke % quarter turns\r\nPress n to continue",   // TIGHTEN
+	"Loosen the spoke % quarter turns\r\nPress n to continue",    // LOOSEN
+	"You did that the wrong way. Let's try again",          // TRY_AGAIN
+	"Measuring the Wheel. This could take a moment.",       // MEASURING
+	"Done with that, on to the next",                       // DONE
+	"At Spoke %, going to %",                               // PRINT_SPOKE
+	"Go to %, you are at %",                                // GO_BACK
+	"Done Measuring. Calculating...",                       // DONE_MEASURING
+	"",                                                     // WAIT
+	"",                                                     // STOP_WAITING
+	"%",                                                    // ECHO
+	"Session aborted",                                      // ABORTED
+	"Type start or press the button to go again",           // READY
+	"Spoke % off by % um, aim for under % um   ",          // GAUGE
+	"Calibrating pot %; type cal <um> at each position",    // CAL_STARTED
+	"Point % taken, reading %",                             // CAL_POINT_TAKEN
+	"Calibration saved, % points",                          // CAL_SAVED
+	"Calibration not saved; the points don't make sense",   // CAL_FAILED
+	"Calibration cleared",                                  // CAL_CLEARED
+	"Turning the wheel to find its index mark",             // HOMING
+	"Spokes numbered from the index mark",                  // HOMED
+	"No index mark found; this wheel won't be remembered",  // NOT_HOMED
+	"Wheel % is back; sessions before this one: %",         // WELCOME_BACK
+	"Since last time, spoke % has moved most, by % um",     // MOVED_MOST
+	"Wheel % remembered; sessions so far: %"                // WHEEL_SAVED
+};
+
+
 //-------------------------------------------------------------------------------------
 /** This constructor creates a new data acquisition task. Its main job is to call the
  *  parent class's constructor which does most of the work.
@@ -45,135 +109,595 @@ const portTickType ticks_to_delay = ((configTICK_RATE_HZ / 1000) * 5);
  *                      (default: configMINIMAL_STACK_SIZE)
  *  @param p_ser_dev Pointer to a serial device (port, radio, SD card, etc.) which can
  *                   be used by this task to communicate (default: NULL)
+ *  @param p_input_dev Pointer to the serial device from which the user's keypresses
+ *                   are read; with the console task, this is the serial port itself
+ *                   while \c p_ser_dev is the print queue
+ *  @param p_stack_buffer Pointer to a statically allocated array to be used as the
+ *                   task's stack, or NULL to take it from the heap (default: NULL)
  */
 
 task_user_interface::task_user_interface (const char* a_name, 
 					  unsigned portBASE_TYPE a_priority, 
 					  size_t a_stack_size,
-					  emstream* p_ser_dev)
-	: frt_task (a_name, a_priority, a_stack_size, p_ser_dev)
+					  emstream* p_ser_dev,
+					  emstream* p_input_dev,
+					  portSTACK_TYPE* p_stack_buffer)
+	: frt_task (a_name, a_priority, a_stack_size, p_ser_dev, p_stack_buffer)
 {
-	// Nothing is done in the body of this constructor. All the work is done in the
-	// call to the frt_task constructor on the line just above this one
+	p_keyboard = p_input_dev;
+	line_length = 0;
+	prompt_pending = false;
+	waiting = false;
+	gauge_shown = false;
 }
 
 
 //-------------------------------------------------------------------------------------
+/** This method prints a message from the catalogue, followed by an end of line. The
+ *  text is copied out of program memory a piece at a time as it's printed.
+ *  @param message Which message to print
+ *  @param p_params The numbers to fill in to the message, one for each \c % in it,
+ *                  or \c NULL if it has none (default: \c NULL)
+ */
+
+void task_user_interface::say (ui_messages message, const int16_t* p_params)
+{
+	p_serial->puts_P (ui_catalogue[message], p_params);
+	*p_serial << endl;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method waits until there's room in the print queue for a line of output. It's
+ *  used when printing several lines at once, so that none of them is thrown away.
+ */
+
+void task_user_interface::wait_for_room (void)
+{
+	while (p_serial->tx_space () < UI_PRINT_ROOM)
+	{
+		vTaskDelay (1);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method is called by the RTOS once to run the task loop for ever and ever. The
+ *  task sleeps on its message queue, waking when a message comes in or every
+ *  \c UI_KEY_POLL_MS to look for keypresses, so it uses next to no processor time
+ *  while nothing is going on. A message is only taken once there's room to print it,
+ *  as the print queue throws away what doesn't fit; then prompts are never lost, and
+ *  the user interface can't get further ahead of the serial port than the queue's
+ *  size.
+ */
+
 void task_user_interface::run (void)
 {
+	ui_message message;                     // The message being printed
+
 	for (;;)
 	{
-		if(!to_ui->is_empty()) {
-			switch(to_ui->get()) {
-				case HELLO:
-					*p_serial << "Wake up Neo..." << endl;
-					break;
-					
-				case GOODBYE:
-					*p_serial << "Follow the rabbit, Neo" << endl;
-					break;
-					
-				case TIGHTEN:
-					*p_serial << "Tighten the spoke" << endl;
-					*p_serial << "Press n to continue" << endl;
-					while(!p_serial->check_for_char() || p_serial->getchar() != 'n')
-						;
-					from_ui->put(DID_THAT);
-					break;
-					
-				case LOOSEN:
-					*p_serial << "Loosen the spoke" << endl;
-					*p_serial << "Press n to continue" << endl;
-					while(!p_serial->check_for_char() || p_serial->getchar() != 'n')
-						;
-					from_ui->put(DID_THAT);
-					break;
-					
-				case TRY_AGAIN:
-					*p_serial << "You did that the wrong way. Let's try again" << endl;
-					break;
-					
-				case MEASURING:
-					*p_serial << "Measuring the Wheel. This could take a moment." 
-								<< endl;
-					break;
-					
-				case DONE_MEASURING:
-					*p_serial << "Done Measuring. Calculating..." << endl;
-					break;
-					
-				case PRINT_SPOKE:
-					*p_serial << "At Spoke " << spoke_count << ", going to " 
-								<< desired_spoke << endl;
-					break;
-					
-				case GO_BACK:
-					*p_serial << "Go to " << desired_spoke << ", you are at " 
-								<< spoke_count << endl;
-					break;
-					
-				case DONE:
-					*p_serial << "Done with that, on to the next" << endl;
-					break;
-				
-				// this is to be implemented, we just didn't have time to finish it
-				/*
-				case ENTER_SPOKES:
-					*p_serial << "Enter the number of spokes on the bicycle wheel" 
-								<< endl;
-
-					while(!p_serial->check_for_char() && !finished){
-						val = p_serial->getchar();
-						if (val >= '0' || val <= '9'){
- 							array[ndex++] = val;
-							to_ui->put(ECHO);
-							max_spokes = (uint8_t) val;
-							
-							
-						
-						} else if (val == 10 || val == 13 || val == 3 || val == 4)  {
- 							array[ndex] = '\0';
-							finished = 1;
-							
- 							spoke_count = atoi(array);
-							
-						}
-					}
-					break;
-					
-				case FIRST_SPOKE:
-					*p_serial << "Is the first spoke on the left or right (L/R)?" << endl;
-					
-					while(!p_serial->check_for_char() || p_serial->getchar() != 'l' || p_serial->getchar() != 'r'){
-						if(p_serial->getchar() == 'l'){
-							left_or_right = 1;
-						} else if (p_serial->getchar() == 'r'){
-							left_or_right = 0;
-						}else{
-						
-						}
-					
-						
-					from_ui->put(DID_THAT);
-					}
-					break;
-					*/
-				
-				case WAIT:
-					while(to_ui->is_empty() || to_ui->get() != STOP_WAITING)
-						;
-					break;
-				
-				// this is to be implemented, we just didn't have time to do it
-				/*
- 				case ECHO:
- 					*p_serial<<max_spokes<<endl;
- 					break;
-				*/
-				default:
-					break;
+		read_keys ();
+
+		if (p_serial->tx_space () < UI_PRINT_ROOM)
+		{
+			vTaskDelay (1);
+		}
+		else if (to_ui->get (&message, configMS_TO_TICKS (UI_KEY_POLL_MS)))
+		{
+			show (message);
+		}
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method prints a message which another task has sent, and, for a prompt or a
+ *  notes that an answer is wanted. Answers come in through \c read_keys(),
+ *  so the task carries on printing and taking commands while it waits for them.
+ *  @param message The message
+ */
+
+void task_user_interface::show (const ui_message& message)
+{
+	int16_t params[3];                      // Numbers to be filled in to the message
+
+	// Everything up to STOP_WAITING is skipped while waiting
+	if (waiting) {
+		waiting = (message.type != STOP_WAITING);
+		return;
+	}
+
+	// Live gauge readings come while a prompt waits; any other message means the
+	// last prompt has been answered, maybe with the button, and ends the gauge's line
+	if (message.type != GAUGE) {
+		prompt_pending = false;
+		if (gauge_shown) {
+			*p_serial << endl;
+			gauge_shown = false;
+		}
+	}
+
+	switch(message.type) {
+		case HELLO:
+		case TRY_AGAIN:
+		case MEASURING:
+		case DONE_MEASURING:
+		case DONE:
+		case ABORTED:
+		case READY:
+		case CAL_FAILED:
+		case CAL_CLEARED:
+		case HOMING:
+		case HOMED:
+		case NOT_HOMED:
+			say (message.type);
+			break;
+			
+		case CAL_STARTED:
+		case CAL_SAVED:
+			params[0] = message.spoke;
+			say (message.type, params);
+			break;
+			
+		case CAL_POINT_TAKEN:
+		case WELCOME_BACK:
+		case MOVED_MOST:
+		case WHEEL_SAVED:
+			params[0] = message.spoke;
+			params[1] = message.value;
+			say (message.type, params);
+			break;
+			
+		case GOODBYE:
+			say (message.type);
+			p_serial->transmit_now ();
+			break;
+			
+		case TIGHTEN:
+		case LOOSEN:
+			// a prompt sent just before the session was aborted needn't be answered
+			if (session_finished || abort_session) {
+				break;
+			}
+			params[0] = message.value;
+			say (message.type, params);
+			prompt_pending = true;
+			break;
+			
+		case PRINT_SPOKE:
+			params[0] = message.spoke;
+			params[1] = message.target;
+			say (message.type, params);
+			break;
+			
+		case GO_BACK:
+			params[0] = message.target;
+			params[1] = message.spoke;
+			say (message.type, params);
+			break;
+			
+		// The gauge is printed over itself, so the numbers change in place
+		case GAUGE:
+			params[0] = message.spoke;
+			params[1] = message.value;
+			params[2] = true_tolerance;
+			*p_serial << '\r';
+			p_serial->puts_P (ui_catalogue[GAUGE], params);
+			gauge_shown = true;
+			break;
+			
+		case ECHO:
+			params[0] = max_spokes;
+			say (message.type, params);
+			break;
+		
+		case WAIT:
+			waiting = true;
+			break;
+		
+		default:
+			break;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method takes whatever the user has typed and adds it to the line being typed,
+ *  echoing it so the user can see it. Backspace takes back the last character. When
+ *  the line is finished with Enter, it's carried out as a command. At a prompt to turn
+ *  a spoke, \c n on its own answers at once without needing Enter, as it always has.
+ */
+
+void task_user_interface::read_keys (void)
+{
+	char ch;                                // The character typed
+
+	while (p_keyboard->check_for_char ()) {
+		ch = p_keyboard->getchar ();
+
+		if (ch == '\r' || ch == '\n') {
+			if (line_length > 0) {
+				*p_serial << endl;
+				line[line_length] = '\0';
+				line_length = 0;
+				do_command ();
+			}
+		}
+		else if (ch == '\b' || ch == 127) {
+			if (line_length > 0) {
+				line_length--;
+				*p_serial << PMS ("\b \b");
+			}
+		}
+		else if (ch == 'n' && line_length == 0 && prompt_pending) {
+			*p_serial << ch << endl;
+			answer_prompt (DID_THAT);
+		}
+		else if (ch >= ' ' && line_length < UI_LINE_SIZE - 1) {
+			line[line_length++] = ch;
+			*p_serial << ch;
+		}
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method answers the prompt to turn a spoke which the mastermind task is
+ *  waiting on.
+ *  @param answer What the user wants done: \c DID_THAT, \c SKIP, \c REMEASURE or
+ *                \c ABORT
+ */
+
+void task_user_interface::answer_prompt (messages_from_ui answer)
+{
+	prompt_pending = false;
+	from_ui->put (answer);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method reads the number which follows a command word in the line typed.
+ *  @param p_text Where to start looking; on return it points just past the number
+ *  @param p_number Where to put the number
+ *  @return True if there was a number from 0 to 255, false if not
+ */
+
+bool task_user_interface::get_number (const char*& p_text, uint8_t* p_number)
+{
+	uint16_t number = 0;
+	uint8_t digits = 0;
+
+	while (*p_text == ' ') {
+		p_text++;
+	}
+	while (*p_text >= '0' && *p_text <= '9' && digits < 4) {
+		number = number * 10 + (*p_text++ - '0');
+		digits++;
+	}
+
+	*p_number = (uint8_t)number;
+	return (digits > 0 && digits < 4 && number <= 255);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method reads a number which may have a minus sign in front of it, such as a
+ *  position in micrometres, from the line typed.
+ *  @param p_text Where to start looking; on return it points just past the number
+ *  @param p_number Where to put the number
+ *  @return True if there was a number from -32767 to 32767, false if not
+ */
+
+bool task_user_interface::get_signed (const char*& p_text, int16_t* p_number)
+{
+	uint32_t number = 0;
+	uint8_t digits = 0;
+	bool negative = false;
+
+	while (*p_text == ' ') {
+		p_text++;
+	}
+	if (*p_text == '-') {
+		negative = true;
+		p_text++;
+	}
+	while (*p_text >= '0' && *p_text <= '9' && digits < 6) {
+		number = number * 10 + (*p_text++ - '0');
+		digits++;
+	}
+
+	*p_number = negative ? -(int16_t)number : (int16_t)number;
+	return (digits > 0 && digits < 6 && number <= 32767);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method carries out the command in the line the user has typed. The command
+ *  is the first word of the line; the numbers it needs follow it. The commands are
+ *  listed by \c help. Spoke count can only be changed between sessions, as the
+ *  mastermind task's readings depend on it.
+ */
+
+void task_user_interface::do_command (void)
+{
+	const char* p_args = line;              // What follows the command word
+	uint8_t first, second;                  // Numbers which follow the command
+	int16_t signed_number;                  // A number which may be negative
+
+	// Split the command word from the rest of the line
+	while (*p_args != ' ' && *p_args != '\0') {
+		p_args++;
+	}
+	if (*p_args == ' ') {
+		line[p_args - line] = '\0';
+		p_args++;
+	}
+
+	if (strcmp_P (line, PSTR ("help")) == 0 || strcmp_P (line, PSTR ("?")) == 0) {
+		print_help ();
+	}
+	else if (strcmp_P (line, PSTR ("stats")) == 0) {
+		print_stats ();
+	}
+	else if (strcmp_P (line, PSTR ("n")) == 0 || strcmp_P (line, PSTR ("skip")) == 0
+			 || strcmp_P (line, PSTR ("measure")) == 0) {
+		if (!prompt_pending) {
+			*p_serial << PMS ("There's no spoke waiting to be turned") << endl;
+		}
+		else if (line[0] == 'n') {
+			answer_prompt (DID_THAT);
+		}
+		else if (line[0] == 's') {
+			answer_prompt (SKIP);
+		}
+		else {
+			answer_prompt (REMEASURE);
+		}
+	}
+	else if (strcmp_P (line, PSTR ("abort")) == 0) {
+		if (session_finished) {
+			*p_serial << PMS ("No session is running") << endl;
+		}
+		else {
+			abort_session = true;
+			if (prompt_pending) {
+				answer_prompt (ABORT);
 			}
 		}
 	}
+	else if (strcmp_P (line, PSTR ("start")) == 0) {
+		if (!session_finished) {
+			*p_serial << PMS ("A session is already running") << endl;
+		}
+		else {
+			from_ui->put (START);
+		}
+	}
+	else if (strcmp_P (line, PSTR ("spokes")) == 0) {
+		if (!get_number (p_args, &first) || first < 2 || first > MAX_SPOKES) {
+			*p_serial << PMS ("Usage: spokes <2 to ") << (uint8_t)MAX_SPOKES
+					  << '>' << endl;
+		}
+		else {
+			// it's checked and set together, so the mastermind can't have finished
+			// measuring with the old number in between
+			portENTER_CRITICAL ();
+			bool allowed = session_finished || !wheel_measured;
+			if (allowed) {
+				max_spokes = first;
+			}
+			portEXIT_CRITICAL ();
+			if (!allowed) {
+				*p_serial << PMS ("Abort the session first") << endl;
+			}
+		}
+	}
+	else if (strcmp_P (line, PSTR ("side")) == 0) {
+		while (*p_args == ' ') {
+			p_args++;
+		}
+		if (*p_args == 'l' || *p_args == 'r') {
+			left_or_right = (*p_args == 'l');
+		}
+		else {
+			*p_serial << PMS ("Usage: side <l or r>") << endl;
+		}
+	}
+	else if (strcmp_P (line, PSTR ("tol")) == 0) {
+		if (get_signed (p_args, &signed_number) && signed_number > 0) {
+			true_tolerance = signed_number;
+		}
+		else {
+			*p_serial << PMS ("Usage: tol <micrometres, 1 to 32767>") << endl;
+		}
+	}
+	else if (strcmp_P (line, PSTR ("live")) == 0) {
+		if (strcmp_P (p_args, PSTR ("on")) == 0 || strcmp_P (p_args, PSTR ("off")) == 0) {
+			live_gauge = (p_args[1] == 'n');
+		}
+		else {
+			*p_serial << PMS ("Usage: live <on or off>") << endl;
+		}
+	}
+	else if (strcmp_P (line, PSTR ("radial")) == 0) {
+		if (strcmp_P (p_args, PSTR ("on")) == 0 || strcmp_P (p_args, PSTR ("off")) == 0) {
+			radial_truing = (p_args[1] == 'n');
+		}
+		else {
+			*p_serial << PMS ("Usage: radial <on or off>") << endl;
+		}
+	}
+	else if (strcmp_P (line, PSTR ("tension")) == 0) {
+		if (strcmp_P (p_args, PSTR ("on")) == 0 || strcmp_P (p_args, PSTR ("off")) == 0) {
+			tension_mapping = (p_args[1] == 'n');
+		}
+		else {
+			*p_serial << PMS ("Usage: tension <on or off>") << endl;
+		}
+	}
+	else if (strcmp_P (line, PSTR ("wheel")) == 0) {
+		if (get_number (p_args, &first) && first <= HISTORY_WHEELS) {
+			wheel_number = first;
+		}
+		else {
+			*p_serial << PMS ("Usage: wheel <1 to ") << (uint8_t)HISTORY_WHEELS
+					  << PMS (", or 0 for one not to be remembered>") << endl;
+		}
+	}
+	else if (strcmp_P (line, PSTR ("cal")) == 0) {
+		do_calibration (p_args);
+	}
+	else if (strcmp_P (line, PSTR ("gains")) == 0) {
+		if (get_number (p_args, &first) && get_number (p_args, &second)) {
+			pos_gain_kp = first;
+			pos_gain_ki = second;
+		}
+		else {
+			*p_serial << PMS ("Usage: gains <KP> <KI>, each 0 to 255") << endl;
+		}
+	}
+	else {
+		*p_serial << PMS ("Unknown command; type help for a list") << endl;
+	}
 }
 
+
+//-------------------------------------------------------------------------------------
+/** This method carries out a command to calibrate a pot. \c cal \c start begins a new
+ *  calibration of the rim's pot, or of the second pot with \c hop after it; then
+ *  \c cal followed by a number of micrometres, once the pot is set at each known
+ *  position, takes a point there; \c cal \c save checks and keeps the points.
+ *  \c cal \c clear goes back to the uncalibrated scale. The mastermind task does the
+ *  work, so it can only be done between sessions.
+ *  @param p_args What follows the command word
+ */
+
+void task_user_interface::do_calibration (const char* p_args)
+{
+	int16_t microns;
+
+	if (!session_finished) {
+		*p_serial << PMS ("Calibrate between sessions") << endl;
+	}
+	else if (strcmp_P (p_args, PSTR ("start")) == 0
+			 || strcmp_P (p_args, PSTR ("start hop")) == 0) {
+		cal_channel = (p_args[5] == ' ') ? HOP_CHANNEL : RIM_CHANNEL;
+		from_ui->put (CAL_BEGIN);
+	}
+	else if (strcmp_P (p_args, PSTR ("clear")) == 0
+			 || strcmp_P (p_args, PSTR ("clear hop")) == 0) {
+		cal_channel = (p_args[5] == ' ') ? HOP_CHANNEL : RIM_CHANNEL;
+		from_ui->put (CAL_CLEAR);
+	}
+	else if (strcmp_P (p_args, PSTR ("save")) == 0) {
+		from_ui->put (CAL_SAVE);
+	}
+	else if (get_signed (p_args, &microns)) {
+		cal_microns = microns;
+		from_ui->put (CAL_POINT);
+	}
+	else {
+		*p_serial << PMS ("Usage: cal <start [hop], micrometres, save or clear [hop]>")
+				  << endl;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method prints the list of commands.
+ */
+
+void task_user_interface::print_help (void)
+{
+	wait_for_room ();
+	*p_serial << PMS ("n          Done turning the spoke") << endl
+			  << PMS ("skip       Leave this spoke, go to the next") << endl;
+	wait_for_room ();
+	*p_serial << PMS ("measure    Measure the wheel again") << endl
+			  << PMS ("abort      Give up on this session") << endl;
+	wait_for_room ();
+	*p_serial << PMS ("start      Start a new session") << endl
+			  << PMS ("spokes N   Set the number of spokes") << endl;
+	wait_for_room ();
+	*p_serial << PMS ("side L/R   Which side the first spoke is on") << endl
+			  << PMS ("tol N      Set the tolerance for a true wheel, um") << endl;
+	wait_for_room ();
+	*p_serial << PMS ("gains P I  Set the position controller's gains") << endl
+			  << PMS ("live on/off Show the spoke being adjusted as it changes") << endl;
+	wait_for_room ();
+	*p_serial << PMS ("radial on/off True the rim radially too") << endl
+			  << PMS ("tension on/off Keep spoke tensions even") << endl;
+	wait_for_room ();
+	*p_serial << PMS ("cal start [hop] Calibrate the rim pot, or the hop pot") << endl
+			  << PMS ("cal N      The pot is at N um; then cal save, or cal clear")
+			  << endl;
+	wait_for_room ();
+	*p_serial << PMS ("wheel N    Which wheel is on, to home and remember it") << endl
+			  << PMS ("stats      Show settings and how things are going") << endl;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method prints the settings and some figures about how things are going.
+ */
+
+void task_user_interface::print_stats (void)
+{
+	wait_for_room ();
+	*p_serial << PMS ("Spokes: ") << max_spokes << PMS (", first on the ");
+	if (left_or_right) {
+		*p_serial << PMS ("left");
+	}
+	else {
+		*p_serial << PMS ("right");
+	}
+	*p_serial << PMS (", tolerance: ") << true_tolerance << PMS (" um, live gauge ");
+	if (live_gauge) {
+		*p_serial << PMS ("on");
+	}
+	else {
+		*p_serial << PMS ("off");
+	}
+	*p_serial << PMS (", radial truing ");
+	if (radial_truing) {
+		*p_serial << PMS ("on") << endl;
+	}
+	else {
+		*p_serial << PMS ("off") << endl;
+	}
+	wait_for_room ();
+	*p_serial << PMS ("Gains: KP ") << pos_gain_kp << PMS (", KI ") << pos_gain_ki
+			  << PMS (", tension mapping ");
+	if (tension_mapping) {
+		*p_serial << PMS ("on");
+	}
+	else {
+		*p_serial << PMS ("off");
+	}
+	if (wheel_number != 0) {
+		*p_serial << PMS (", wheel ") << wheel_number << endl;
+	}
+	else {
+		*p_serial << PMS (", wheel not named") << endl;
+	}
+	wait_for_room ();
+	if (session_finished) {
+		*p_serial << PMS ("No session running") << endl;
+	}
+	else {
+		*p_serial << PMS ("Session running, at spoke ") << spoke_count
+				  << PMS (", going to ") << desired_spoke << endl;
+	}
+	wait_for_room ();
+	*p_serial << PMS ("Print queue used: ") << print_ser_queue->get_high_water ()
+			  << PMS ("/") << print_ser_queue->get_size () << PMS (", dropped: ")
+			  << print_ser_queue->get_dropped () << endl;
+	wait_for_room ();
+	*p_serial << PMS ("UI progress updates merged: ") << to_ui->get_coalesced ()
+			  << endl;
+	wait_for_room ();
+	*p_serial << PMS ("Spoke sensor: ") << spoke_glitches << PMS (" glitches, ")
+			  << spoke_reversals << PMS (" turned back, ") << spoke_corrections
+			  << PMS (" index corrections") << endl;
+}
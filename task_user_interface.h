@@ -4,6 +4,14 @@
  *
  *  Revisions:
  *    \li 03-13-13 HL, TJ, & SG spoke counter don't miss a thang
+ *    \li 10-18-26 Keys are read from the serial port; printing goes to the print queue
+ *    \li 10-18-26 Messages are printed from a catalogue kept in program memory
+ *    \li 10-18-26 Line-buffered command interpreter; the task sleeps on its queue
+ *    \li 10-18-26 Live gauge of the spoke being adjusted
+ *    \li 10-18-26 Room in the catalogue for prompts with a number of quarter turns
+ *    \li 10-18-26 Signed numbers, for tolerances and calibration points in micrometres
+ *    \li 10-18-26 No more answers to questions; the mastermind task never asks any
+ *    \li 10-18-26 The spokes command takes up to MAX_SPOKES spokes
  *
  *  License:
  *    This file is copyright 2013 by Hamilton Little, Trevor Jones and Sean Green 
@@ -44,11 +52,38 @@
 /// This macro defines a string that identifies the name and version of this program. 
 #define PROGRAM_VERSION		PMS ("ME405 base radio program V0.4 ")
 
+/** This is the room, in characters, there must be in the print queue before the user
+ *  interface prints what it's been asked to. It's enough for the longest message. 
+ */
+#define UI_PRINT_ROOM		64
+
+/** This is the room for each message in the user interface's catalogue, including the
+ *  null character at the end. It's enough for the longest message. 
+ */
+#define UI_MESSAGE_SIZE		56
+
+/** This is the room for a line typed by the user, including the null character at the
+ *  end. Characters typed beyond it are ignored. 
+ */
+#define UI_LINE_SIZE		24
+
+/** This is the longest time, in milliseconds, the user interface sleeps waiting for a
+ *  message before it looks to see if any keys have been pressed. 
+ */
+#define UI_KEY_POLL_MS		20
+
 
 //-------------------------------------------------------------------------------------
 /** \brief The user interface for the project.
  *  \details This class is used to interface with the mechanic while they are truing
- * 	a wheel on the system we developed for this project.
+ * 	a wheel on the system we developed for this project. The text of its messages is
+ * 	kept in a catalogue in program memory, one entry for each of the \c ui_messages,
+ * 	so that none of it takes up RAM on the AVR. A \c % in an entry is filled in with
+ * 	a number when the message is printed. 
+ * 
+ * 	The user types commands a line at a time; \c help lists them. Typing doesn't hold
+ * 	up printing, as the task never waits for a key: it sleeps on its message queue
+ * 	and looks for keys whenever it wakes. 
  */
 class task_user_interface : public frt_task
 {
@@ -56,10 +91,59 @@ private:
 	// No private variables or methods for this class
 
 protected:
+	/// The serial device from which the user's keypresses are read
+	emstream* p_keyboard;
+
+	/// The line being typed by the user
+	char line[UI_LINE_SIZE];
+
+	/// The number of characters in the line so far
+	uint8_t line_length;
+
+	/// True when the mastermind task is waiting for a spoke to be turned
+	bool prompt_pending;
+
+	/// True while messages are being skipped, from \c WAIT until \c STOP_WAITING
+	bool waiting;
+
+	/// True when the live gauge's line is on the screen and hasn't been ended yet
+	bool gauge_shown;
+
+	// Print a message from the catalogue, filling in any parameters
+	void say (ui_messages message, const int16_t* p_params = NULL);
+
+	// Print a message which another task has sent
+	void show (const ui_message& message);
+
+	// Take in keys which have been pressed, carrying out a line when it's finished
+	void read_keys (void);
+
+	// Carry out the command in the line which has been typed
+	void do_command (void);
+
+	// Answer the prompt to turn a spoke
+	void answer_prompt (messages_from_ui answer);
+
+	// Read a number from 0 to 255 from the line which has been typed
+	bool get_number (const char*& p_text, uint8_t* p_number);
+
+	// Read a signed 16 bit number from the line which has been typed
+	bool get_signed (const char*& p_text, int16_t* p_number);
+
+	// Carry out a command to calibrate a pot
+	void do_calibration (const char* p_args);
+
+	// Print the list of commands, and the settings and statistics
+	void print_help (void);
+	void print_stats (void);
+
+	// Wait until there's room in the print queue for a line
+	void wait_for_room (void);
 
 public:
 	// This constructor creates a user interface task object
-	task_user_interface (const char*, unsigned portBASE_TYPE, size_t, emstream*);
+	task_user_interface (const char*, unsigned portBASE_TYPE, size_t, emstream*,
+	                     emstream*, portSTACK_TYPE* = NULL);
 
 	/** This method is called by the RTOS once to run the task loop for ever and ever.
 	 */
@@ -0,0 +1,251 @@
+//*************************************************************************************
+/** \file telemetry.cpp
+ *    This file contains the sender of binary telemetry records. See \c telemetry.h
+ *    for how it's used and \c telemetry_frame.h for the records' format.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, binary telemetry
+ *    \li 10-18-26 Radial offsets, for a stand which trues the rim radially too
+ *    \li 10-18-26 Spoke tensions, for a stand with a tensiometer
+ *    \li 10-18-26 Records carry up to MAX_SPOKES spokes
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include "FreeRTOS.h"                       // Primary header for FreeRTOS
+#include "task.h"                           // For the tick count and suspending tasks
+
+#include "shares.h"                         // For the spoke count and desired spoke
+#include "telemetry.h"                      // Header for this file
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This constructor saves the serial device through which records are sent.
+ *  @param p_ser_dev Pointer to the serial device
+ */
+
+telemetry::telemetry (emstream* p_ser_dev)
+{
+	p_serial = p_ser_dev;
+	length = 0;
+	sequence = 0;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method starts building a record of the given type.
+ *  \details The header is put into the record: the type, the sequence number and the
+ *  time in milliseconds since the scheduler started.
+ *  @param type The type of record, such as \c TELEM_MEASUREMENTS
+ */
+
+void telemetry::begin (uint8_t type)
+{
+	length = 0;
+	put_uint8 (type);
+	put_uint8 (sequence);
+	put_uint32 ((uint32_t)xTaskGetTickCount () * portTICK_RATE_MS);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method adds a byte to the record being built.
+ *  \details Anything which won't fit in the record is dropped; the records are all
+ *  sized so that this can't happen.
+ *  @param value The byte to be added
+ */
+
+void telemetry::put_uint8 (uint8_t value)
+{
+	if (length < TELEM_MAX_RECORD - TELEM_CRC_SIZE)
+	{
+		record[length++] = value;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method adds a 16 bit number to the record, low byte first.
+ *  @param value The number to be added
+ */
+
+void telemetry::put_int16 (int16_t value)
+{
+	put_uint8 ((uint8_t)value);
+	put_uint8 ((uint8_t)((uint16_t)value >> 8));
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method adds a 32 bit number to the record, low byte first.
+ *  @param value The number to be added
+ */
+
+void telemetry::put_uint32 (uint32_t value)
+{
+	for (uint8_t count = 0; count < 4; count++)
+	{
+		put_uint8 ((uint8_t)value);
+		value >>= 8;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method adds the CRC to the record and sends it.
+ *  \details The record is COBS encoded as it's sent rather than in a second buffer.
+ *  With the delimiters, what's sent is two bytes longer than the encoded record, which
+ *  is one byte longer than the record.
+ */
+
+void telemetry::send (void)
+{
+	uint16_t crc = telem_crc16 (record, length);
+	record[length++] = (uint8_t)crc;
+	record[length++] = (uint8_t)(crc >> 8);
+
+	for (;;)
+	{
+		vTaskSuspendAll ();
+		if (p_serial->tx_space () >= (uint16_t)length + 3)
+		{
+			break;
+		}
+		xTaskResumeAll ();
+		vTaskDelay (1);
+	}
+
+	p_serial->putchar (TELEM_DELIMITER);
+
+	uint8_t block_start = 0;
+	for (uint8_t index = 0; index <= length; index++)
+	{
+		if (index == length || record[index] == 0)
+		{
+			p_serial->putchar ((char)(index - block_start + 1));
+			while (block_start < index)
+			{
+				p_serial->putchar ((char)record[block_start++]);
+			}
+			block_start = index + 1;
+		}
+	}
+
+	p_serial->putchar (TELEM_DELIMITER);
+	xTaskResumeAll ();
+
+	sequence++;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method sends the readings taken at each spoke and their average.
+ *  @param p_readings A pointer to the array of readings
+ *  @param count The number of spokes; any past \c MAX_SPOKES aren't sent
+ *  @param average The average of the readings
+ *  @param type \c TELEM_MEASUREMENTS for the rim pot's readings (the default) or
+ *              \c TELEM_TENSIONS for the tensiometer's
+ */
+
+void telemetry::measurements (const int16_t* p_readings, uint8_t count, int16_t average,
+							  uint8_t type)
+{
+	if (count > MAX_SPOKES)
+	{
+		count = MAX_SPOKES;
+	}
+
+	begin (type);
+	put_uint8 (count);
+	for (uint8_t index = 0; index < count; index++)
+	{
+		put_int16 (p_readings[index]);
+	}
+	put_int16 (average);
+	send ();
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method sends each spoke's offset from the average.
+ *  @param p_offsets A pointer to the array of offsets
+ *  @param count The number of spokes; any past \c MAX_SPOKES aren't sent
+ *  @param type \c TELEM_OFFSETS for sideways offsets (the default) or
+ *              \c TELEM_RADIAL_OFFSETS for radial ones
+ */
+
+void telemetry::offsets (const int16_t* p_offsets, uint8_t count, uint8_t type)
+{
+	if (count > MAX_SPOKES)
+	{
+		count = MAX_SPOKES;
+	}
+
+	begin (type);
+	put_uint8 (count);
+	for (uint8_t index = 0; index < count; index++)
+	{
+		put_int16 (p_offsets[index]);
+	}
+	send ();
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method sends the spoke which is furthest out of true.
+ *  @param spoke The number of the spoke
+ *  @param offset How far the rim is off at that spoke
+ */
+
+void telemetry::worst (uint8_t spoke, int16_t offset)
+{
+	begin (TELEM_WORST);
+	put_uint8 (spoke);
+	put_int16 (offset);
+	send ();
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method sends the phase which the truing algorithm has just started.
+ *  \details The spoke at the sensor and the spoke being gone to are sent as well.
+ *  @param phase The phase, such as \c TELEM_PHASE_MEASURE
+ *  @param iteration How many spokes have been adjusted so far this session
+ */
+
+void telemetry::state (uint8_t phase, uint16_t iteration)
+{
+	begin (TELEM_STATE);
+	put_uint8 (phase);
+	put_int16 ((int16_t)iteration);
+	put_uint8 ((uint8_t)spoke_count);
+	put_uint8 ((uint8_t)desired_spoke);
+	send ();
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method sends a phase which has just finished and how long it took.
+ *  @param phase The phase, such as \c TELEM_PHASE_MEASURE
+ *  @param duration_ms How long the phase took, in milliseconds
+ */
+
+void telemetry::timing (uint8_t phase, uint32_t duration_ms)
+{
+	begin (TELEM_TIMING);
+	put_uint8 (phase);
+	put_uint32 (duration_ms);
+	send ();
+}
@@ -0,0 +1,99 @@
+//*************************************************************************************
+/** \file telemetry.h
+ *    This file contains the interface to the sender of binary telemetry records. The
+ *    truing algorithm uses it to send its measurements, offsets, choice of spoke,
+ *    phases and timings in a compact form which a PC can record reliably, instead of
+ *    printing them as text. See \c telemetry_frame.h for the records' format.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, binary telemetry
+ *    \li 10-18-26 Radial offsets, for a stand which trues the rim radially too
+ *    \li 10-18-26 Spoke tensions, for a stand with a tensiometer
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+// This define prevents this .h file from being included multiple times in a .cpp file
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+#include <stdint.h>
+#include "emstream.h"                       // Header for serial ports and devices
+#include "telemetry_frame.h"                // The format of the records
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This class sends binary telemetry records through a serial device.
+ *  \details Each record is built in a buffer, then sent in one piece with the
+ *  scheduler suspended so that no other task's text can get into the middle of it.
+ *  Before suspending the scheduler, the sender waits, a tick at a time, until the
+ *  serial device has room for the whole record, so that sending never has to wait
+ *  for the port and the other tasks are only held up for as long as it takes to copy
+ *  the record into the transmitter buffer. Only one task should use each object.
+ */
+
+class telemetry
+{
+	protected:
+		/// The serial device through which records are sent
+		emstream* p_serial;
+
+		/// The record being built
+		uint8_t record[TELEM_MAX_RECORD];
+
+		/// How many bytes of the record have been built
+		uint8_t length;
+
+		/// The sequence number of the next record sent
+		uint8_t sequence;
+
+		// Start building a record of the given type
+		void begin (uint8_t type);
+
+		// Add a byte to the record being built
+		void put_uint8 (uint8_t value);
+
+		// Add a 16 bit number to the record being built
+		void put_int16 (int16_t value);
+
+		// Add a 32 bit number to the record being built
+		void put_uint32 (uint32_t value);
+
+		// Add the CRC to the record and send it
+		void send (void);
+
+	public:
+		// The constructor saves the serial device through which records are sent
+		telemetry (emstream* p_ser_dev);
+
+		// Send the readings taken at each spoke and their average
+		void measurements (const int16_t* p_readings, uint8_t count, int16_t average,
+						   uint8_t type = TELEM_MEASUREMENTS);
+
+		// Send each spoke's offset from the average
+		void offsets (const int16_t* p_offsets, uint8_t count,
+					  uint8_t type = TELEM_OFFSETS);
+
+		// Send the spoke which is furthest out of true
+		void worst (uint8_t spoke, int16_t offset);
+
+		// Send the phase which the truing algorithm has just started
+		void state (uint8_t phase, uint16_t iteration);
+
+		// Send a phase which has just finished and how long it took
+		void timing (uint8_t phase, uint32_t duration_ms);
+};
+
+#endif // _TELEMETRY_H_
@@ -0,0 +1,133 @@
+//*************************************************************************************
+/** \file telemetry_frame.cpp
+ *    This file contains the functions which frame telemetry records. See
+ *    \c telemetry_frame.h for the format of the records.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, binary telemetry
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include "telemetry_frame.h"                // Header for this file
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function finds the CRC-16-CCITT of some bytes.
+ *  \details It works a bit at a time rather than from a table, which is slower but
+ *  saves 512 bytes of flash; records are short and sent at 9600 baud, so the time
+ *  doesn't matter.
+ *  @param p_data A pointer to the bytes
+ *  @param length How many bytes there are
+ *  @return The CRC
+ */
+
+uint16_t telem_crc16 (const uint8_t* p_data, uint8_t length)
+{
+	uint16_t crc = 0xFFFF;
+
+	while (length--)
+	{
+		crc ^= (uint16_t)(*p_data++) << 8;
+		for (uint8_t bit = 0; bit < 8; bit++)
+		{
+			if (crc & 0x8000)
+			{
+				crc = (uint16_t)(crc << 1) ^ 0x1021;
+			}
+			else
+			{
+				crc = (uint16_t)(crc << 1);
+			}
+		}
+	}
+
+	return (crc);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function COBS encodes a record.
+ *  \details Each zero byte is replaced by the distance to the next one, and one more
+ *  byte at the start gives the distance to the first. Records are much shorter than
+ *  254 bytes, so the encoded record is always exactly one byte longer.
+ *  @param p_in A pointer to the record
+ *  @param length The number of bytes in the record, at most 253
+ *  @param p_out A pointer to where the encoded record is to be put, which must have
+ *               room for one more byte than the record
+ *  @return The number of bytes in the encoded record
+ */
+
+uint8_t telem_cobs_encode (const uint8_t* p_in, uint8_t length, uint8_t* p_out)
+{
+	uint8_t code_index = 0;
+	uint8_t out_index = 1;
+
+	for (uint8_t in_index = 0; in_index < length; in_index++)
+	{
+		if (p_in[in_index] == 0)
+		{
+			p_out[code_index] = out_index - code_index;
+			code_index = out_index++;
+		}
+		else
+		{
+			p_out[out_index++] = p_in[in_index];
+		}
+	}
+	p_out[code_index] = out_index - code_index;
+
+	return (out_index);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This function decodes a COBS encoded record.
+ *  \details The record must have come from \c telem_cobs_encode(), so no block of it
+ *  can be 255 bytes long.
+ *  @param p_in A pointer to the encoded record, without its delimiters
+ *  @param length The number of bytes in the encoded record
+ *  @param p_out A pointer to where the record is to be put, which must have room for
+ *               as many bytes as the encoded record has
+ *  @return The number of bytes in the record, or zero if the encoding was damaged
+ */
+
+uint8_t telem_cobs_decode (const uint8_t* p_in, uint8_t length, uint8_t* p_out)
+{
+	uint8_t in_index = 0;
+	uint8_t out_index = 0;
+
+	while (in_index < length)
+	{
+		uint8_t code = p_in[in_index++];
+		if (code == 0 || in_index + code - 1 > length)
+		{
+			return (0);
+		}
+
+		for (uint8_t count = 1; count < code; count++)
+		{
+			p_out[out_index++] = p_in[in_index++];
+		}
+
+		// Every block but the last one was followed by a zero in the record
+		if (in_index < length)
+		{
+			p_out[out_index++] = 0;
+		}
+	}
+
+	return (out_index);
+}
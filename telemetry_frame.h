@@ -0,0 +1,124 @@
+//*************************************************************************************
+/** \file telemetry_frame.h
+ *    This file contains the format of the binary telemetry which the truing stand
+ *    sends out of its serial port alongside the text meant for people, and the
+ *    functions which frame it. It doesn't use the RTOS or the serial port classes, so
+ *    that programs on a PC which read the telemetry can be built with it too.
+ *
+ *    Each record is a few bytes of header, a body which depends on the record's type,
+ *    and a CRC. The header is the record type, a sequence number which goes up by one
+ *    for every record sent, so that missing records can be noticed, and the time in
+ *    milliseconds since the scheduler started. Numbers longer than a byte are sent
+ *    least significant byte first. The CRC is CRC-16-CCITT (polynomial 0x1021, start
+ *    value 0xFFFF) of everything before it. Positions and offsets of the rim are in
+ *    micrometres; the tensiometer's readings are A/D counts. The bodies are:
+ *    \li \c TELEM_MEASUREMENTS  The number of spokes, then the reading at each spoke
+ *        and the average of the readings, all 16 bit signed
+ *    \li \c TELEM_OFFSETS  The number of spokes, then each spoke's offset from the
+ *        average, 16 bit signed
+ *    \li \c TELEM_RADIAL_OFFSETS  The same as \c TELEM_OFFSETS for the rim's radial
+ *        position, sent only when the stand is truing radially too
+ *    \li \c TELEM_TENSIONS  The same as \c TELEM_MEASUREMENTS for the tensiometer's
+ *        readings, sent only when the stand is mapping tensions
+ *    \li \c TELEM_WORST  The worst spoke's number and its 16 bit signed offset
+ *    \li \c TELEM_STATE  The phase the truing algorithm has just started, the 16 bit
+ *        number of the iteration it's on, the spoke at the sensor and the spoke the
+ *        position controller is going to
+ *    \li \c TELEM_TIMING  A phase which has just finished and how long it took, in
+ *        32 bit milliseconds
+ *
+ *    On the wire each record is COBS (Consistent Overhead Byte Stuffing) encoded,
+ *    which takes every zero byte out of it, and sent between two zero bytes. Text
+ *    never has zero bytes in it, so a receiver can tell where each record starts and
+ *    ends however the text and records are mixed together.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, binary telemetry
+ *    \li 10-18-26 Radial offsets, for a stand which trues the rim radially too
+ *    \li 10-18-26 Spoke tensions, for a stand with a tensiometer
+ *    \li 10-18-26 Rim positions are in micrometres
+ *    \li 10-18-26 Records carry up to MAX_SPOKES spokes
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+// This define prevents this .h file from being included multiple times in a .cpp file
+#ifndef _TELEMETRY_FRAME_H_
+#define _TELEMETRY_FRAME_H_
+
+#include <stdint.h>
+#include "wheel_limits.h"                   // The most spokes a wheel can have
+
+
+/// The byte which is sent before and after every record
+#define TELEM_DELIMITER			0x00
+
+/// The number of bytes of header at the start of every record
+#define TELEM_HEADER_SIZE		6
+
+/// The number of bytes of CRC at the end of every record
+#define TELEM_CRC_SIZE			2
+
+/// The longest record, which is a measurement record for the most spokes
+#define TELEM_MAX_RECORD		(TELEM_HEADER_SIZE + 1 + 2 * MAX_SPOKES + 2 \
+								 + TELEM_CRC_SIZE)
+
+/// The longest a record can be once it's been COBS encoded, not counting delimiters
+#define TELEM_MAX_ENCODED		(TELEM_MAX_RECORD + 1)
+
+/// Record type: the readings taken at each spoke, and their average
+#define TELEM_MEASUREMENTS		1
+
+/// Record type: each spoke's offset from the average
+#define TELEM_OFFSETS			2
+
+/// Record type: the spoke which is furthest out of true
+#define TELEM_WORST				3
+
+/// Record type: the truing algorithm has started a phase
+#define TELEM_STATE				4
+
+/// Record type: the truing algorithm has finished a phase
+#define TELEM_TIMING			5
+
+/// Record type: each spoke's radial offset from the average
+#define TELEM_RADIAL_OFFSETS	6
+
+/// Record type: the tension read at each spoke, and their average
+#define TELEM_TENSIONS			7
+
+/// Phase: turning the wheel past every spoke to measure the rim
+#define TELEM_PHASE_MEASURE		1
+
+/// Phase: turning the wheel to bring the worst spoke to the sensor
+#define TELEM_PHASE_MOVE		2
+
+/// Phase: waiting for the operator to adjust a spoke
+#define TELEM_PHASE_ADJUST		3
+
+/// Phase: the wheel is true and the session is over
+#define TELEM_PHASE_DONE		4
+
+
+// Find the CRC-16-CCITT of some bytes
+uint16_t telem_crc16 (const uint8_t* p_data, uint8_t length);
+
+// COBS encode a record
+uint8_t telem_cobs_encode (const uint8_t* p_in, uint8_t length, uint8_t* p_out);
+
+// Decode a COBS encoded record
+uint8_t telem_cobs_decode (const uint8_t* p_in, uint8_t length, uint8_t* p_out);
+
+#endif // _TELEMETRY_FRAME_H_
@@ -0,0 +1,127 @@
+//*************************************************************************************
+/** \file tension_map.cpp
+ *    This file contains a map of the spokes' tensions. See \c tension_map.h for the
+ *    rule it keeps to.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, tension read in the measuring sweep
+ *    \li 10-18-26 Room for MAX_SPOKES spokes
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include "tension_map.h"
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This constructor makes a map which knows no tensions, so allows any turn.
+ */
+
+tension_map::tension_map (void)
+{
+	spokes = 0;
+	valid = false;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method takes in the tensions read as the wheel was measured.
+ *  @param readings The tensiometer's reading at each spoke
+ *  @param average The average of the readings
+ *  @param num_spokes How many spokes the wheel has
+ */
+
+void tension_map::set (const int16_t readings[], int16_t average, uint8_t num_spokes)
+{
+	spokes = (num_spokes > MAX_SPOKES) ? MAX_SPOKES : num_spokes;
+	for (uint8_t spoke = 0; spoke < spokes; spoke++)
+	{
+		offsets[spoke] = readings[spoke] - average;
+	}
+	valid = true;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method finds out whether turning a spoke would take its tension
+ *  further outside the band.
+ *  @param spoke The spoke
+ *  @param turns How many quarter turns it would be tightened by; negative to loosen
+ *  @return True if the turn is allowed
+ */
+
+bool tension_map::allows (uint8_t spoke, int8_t turns)
+{
+	if (!valid || spoke >= spokes)
+	{
+		return (true);
+	}
+	if (turns > 0)
+	{
+		return (offsets[spoke] <= TENSION_BAND);
+	}
+	return (offsets[spoke] >= -TENSION_BAND);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method finds the spoke to turn in place of one which may not be.
+ *  \details Each neighbour on the other flange is asked for the turns which would
+ *  move the rim by the spoke's offset. Of those allowed, the one which leaves the
+ *  neighbour's tension nearest the average is picked.
+ *  @param spoke The spoke the planner picked
+ *  @param offset Its offset
+ *  @param p_flanges Which flange each spoke goes to
+ *  @param p_gains How far a quarter turn of each spoke moves the rim
+ *  @param p_turns The turns asked of the spoke; if a neighbour is picked, the turns
+ *                 asked of it are put here instead
+ *  @return The spoke to turn, which is the one picked if no neighbour will do
+ */
+
+uint8_t tension_map::substitute (uint8_t spoke, int16_t offset,
+								 flange_model* p_flanges, gain_model* p_gains,
+								 int8_t* p_turns)
+{
+	uint8_t best = spoke;
+	int16_t best_score = 0x7FFF;
+
+	for (int8_t step = -1; step <= 1; step += 2)
+	{
+		uint8_t neighbour = (spoke + spokes + step) % spokes;
+		if (p_flanges->is_left (neighbour) == p_flanges->is_left (spoke))
+		{
+			continue;
+		}
+
+		int8_t turns = p_gains->prescribe (neighbour, offset);
+		if (!allows (neighbour, turns))
+		{
+			continue;
+		}
+
+		// Tightening a spoke with a low tension brings it toward the middle, so the
+		// lower the tension the better, and the other way round for loosening
+		int16_t score = (turns > 0) ? offsets[neighbour] : -offsets[neighbour];
+		if (score < best_score)
+		{
+			best_score = score;
+			best = neighbour;
+			*p_turns = turns;
+		}
+	}
+
+	return (best);
+}
+
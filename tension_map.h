@@ -0,0 +1,88 @@
+//*************************************************************************************
+/** \file tension_map.h
+ *    This file contains a map of the spokes' tensions, read by a tensiometer on the
+ *    stand as the wheel is measured, and the rule which keeps truing from making the
+ *    tensions any more uneven than they are.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, tension read in the measuring sweep
+ *    \li 10-18-26 Room for MAX_SPOKES spokes
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+
+// This define prevents this .h file from being included multiple times in a .cpp file
+#ifndef _TENSION_MAP_H_
+#define _TENSION_MAP_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "flange_model.h"                   // Which flange each spoke goes to
+#include "gain_model.h"                     // How far a quarter turn moves the rim
+
+
+/** A spoke whose tensiometer reading is more than this many A/D counts above the
+ *  average isn't tightened any more, and one this far below isn't loosened. It's
+ *  about a tenth of a typical spoke's tension, the spread most wheel builders allow.
+ */
+#define TENSION_BAND		40
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This class keeps each spoke's tension and says whether a turn is allowed.
+ *  \details The tensions are kept as offsets from their average, so the same spread
+ *  is allowed however tight the wheel is as a whole. A turn is allowed unless it
+ *  takes a spoke which is already outside the band further outside it.
+ *
+ *  When the spoke the planner picked may not be turned, one of its neighbours on
+ *  the other flange is turned the other way instead: loosening a spoke on the other
+ *  flange moves the rim the same way as tightening this one, as a mechanic would do
+ *  it. Of the neighbours which may be turned, the one whose tension is brought
+ *  nearest the middle is picked. If neither may be, the spoke itself is turned, as
+ *  the wheel must be trued whatever happens.
+ */
+
+class tension_map
+{
+	protected:
+		/// Each spoke's tensiometer reading, less the average of them all
+		int16_t offsets[MAX_SPOKES];
+
+		/// How many spokes the wheel has
+		uint8_t spokes;
+
+		/// True once the tensions have been read for this wheel
+		bool valid;
+
+	public:
+		// The constructor makes an empty map
+		tension_map (void);
+
+		// Take in the tensions read as the wheel was measured
+		void set (const int16_t readings[], int16_t average, uint8_t num_spokes);
+
+		/// Forget the tensions, as they belong to another wheel
+		void clear (void) { valid = false; }
+
+		// Find out whether turning a spoke would make the tensions more uneven
+		bool allows (uint8_t spoke, int8_t turns);
+
+		// Find the spoke to turn in place of one which may not be turned
+		uint8_t substitute (uint8_t spoke, int16_t offset, flange_model* p_flanges,
+							gain_model* p_gains, int8_t* p_turns);
+};
+
+#endif // _TENSION_MAP_H_
@@ -0,0 +1,138 @@
+//*************************************************************************************
+/** \file ui_queue.cpp
+ *    This file contains the queue which carries messages to the user interface task.
+ *    See \c ui_queue.h for how progress updates are kept from piling up.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, user interface messages with payloads
+ *    \li 10-18-26 get() with a timeout, so the user interface can sleep on the queue
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include "ui_queue.h"
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This constructor creates a queue for messages to the user interface.
+ *  @param queue_size The number of messages the queue can hold. As progress updates
+ *                    take up at most one place, this needn't be large
+ */
+
+ui_queue::ui_queue (uint8_t queue_size)
+	: queue (queue_size)
+{
+	progress_queued = false;
+	coalesced = 0;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method sends a message to the user interface.
+ *  \details The time and the numbers the message is about are saved with it. If the
+ *  message is a progress update and there's one waiting in the queue already, the
+ *  waiting one is brought up to date and nothing is added, so this never waits.
+ *  Otherwise the message goes on the back of the queue, waiting for room if need be.
+ *  @param type Which message to send
+ *  @param spoke The spoke at the sensor (default: 0)
+ *  @param target The spoke being gone to (default: 0)
+ *  @param value A reading or offset which the message is about (default: 0)
+ *  @return True if the message was sent or merged, false if it couldn't be queued
+ */
+
+bool ui_queue::put (ui_messages type, int8_t spoke, int8_t target, int16_t value)
+{
+	ui_message message;
+
+	message.type = type;
+	message.spoke = spoke;
+	message.target = target;
+	message.value = value;
+	message.time = xTaskGetTickCount ();
+
+	if (is_progress (type))
+	{
+		bool already_queued;
+
+		portENTER_CRITICAL ();
+		progress = message;
+		already_queued = progress_queued;
+		progress_queued = true;
+		portEXIT_CRITICAL ();
+
+		if (already_queued)
+		{
+			coalesced++;
+			return (true);
+		}
+		if (!queue.put (message))
+		{
+			progress_queued = false;
+			return (false);
+		}
+		return (true);
+	}
+
+	return (queue.put (message));
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method takes the next message out of the queue.
+ *  \details If it's a progress update, the latest one sent is given in its place, so
+ *  the numbers are as up to date as they can be while still being those which were
+ *  sent.
+ *  @return The message
+ */
+
+ui_message ui_queue::get (void)
+{
+	ui_message message;
+
+	while (!get (&message, portMAX_DELAY))
+	{
+	}
+
+	return (message);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method takes the next message out of the queue if one comes soon.
+ *  \details The calling task sleeps until a message is put in the queue or the time
+ *  is up, whichever comes first. A progress update is replaced by the latest one
+ *  sent, as in \c get().
+ *  @param p_message Where to put the message
+ *  @param ticks_to_wait The longest time to wait for a message, in RTOS ticks
+ *  @return True if a message was taken, false if the time ran out first
+ */
+
+bool ui_queue::get (ui_message* p_message, portTickType ticks_to_wait)
+{
+	if (xQueueReceive (queue.get_handle (), p_message, ticks_to_wait) != pdTRUE)
+	{
+		return (false);
+	}
+
+	if (is_progress (p_message->type))
+	{
+		portENTER_CRITICAL ();
+		*p_message = progress;
+		progress_queued = false;
+		portEXIT_CRITICAL ();
+	}
+
+	return (true);
+}
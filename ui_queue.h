@@ -0,0 +1,129 @@
+//*************************************************************************************
+/** \file ui_queue.h
+ *    This file contains the queue which carries messages to the user interface task.
+ *    Each message carries the numbers it's about, as they were when it was sent, so
+ *    that what's printed is what was true then rather than whatever the shared
+ *    variables have moved on to by the time the user interface gets to it.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, user interface messages with payloads
+ *    \li 10-18-26 Messages for aborted and finished sessions; get() with a timeout
+ *    \li 10-18-26 Live gauge readings are progress updates
+ *    \li 10-18-26 A prompt's value is how many quarter turns to make
+ *    \li 10-18-26 Messages for calibrating a pot
+ *    \li 10-18-26 Messages for homing the wheel and remembering it
+ *    \li 10-18-26 The spoke count and first spoke questions, which were never sent, 
+ *                 taken out
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+// This define prevents this .h file from being included multiple times in a .cpp file
+#ifndef _UI_QUEUE_H_
+#define _UI_QUEUE_H_
+
+#include "FreeRTOS.h"                       // Primary header for FreeRTOS
+#include "task.h"                           // Header for FreeRTOS task functions
+#include "frt_queue.h"                      // Header of wrapper for FreeRTOS queues
+
+
+/** These are the messages which can be passed from the truing algorithm task
+ *	to the user interface task. The text of each is in the user interface's message
+ *	catalogue, in the same order, so a new message must be added to both. */
+typedef enum ui_messages { HELLO, GOODBYE, TIGHTEN, LOOSEN, TRY_AGAIN, MEASURING, DONE,
+							PRINT_SPOKE, GO_BACK, DONE_MEASURING, WAIT, STOP_WAITING,
+							ECHO, ABORTED, READY, GAUGE,
+							CAL_STARTED, CAL_POINT_TAKEN, CAL_SAVED, CAL_FAILED,
+							CAL_CLEARED, HOMING, HOMED, NOT_HOMED, WELCOME_BACK,
+							MOVED_MOST, WHEEL_SAVED, UI_NUM_MESSAGES} ui_messages;
+
+
+/** This structure is one message to the user interface, with the numbers it's about.
+ *  A message which isn't about a spoke or a value leaves those at zero.
+ */
+typedef struct ui_message
+{
+	ui_messages type;                       ///< Which message this is
+	int8_t spoke;                           ///< The spoke at the sensor when sent
+	int8_t target;                          ///< The spoke being gone to when sent
+	int16_t value;                          ///< A reading, offset or number of turns
+	portTickType time;                      ///< When the message was sent, in RTOS ticks
+} ui_message;
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This class is a queue of messages for the user interface which doesn't let
+ *  progress updates pile up.
+ *  \details Progress updates, \c PRINT_SPOKE and \c GO_BACK, are sent every time the
+ *  wheel passes a spoke, which can be faster than the user interface can print them,
+ *  and live gauge readings, \c GAUGE, many times a second.
+ *  Only the latest matters, so there's never more than one of them in the queue: if
+ *  one is already waiting when another is sent, the waiting one is brought up to date
+ *  instead of a new one being added. Other messages are queued as they are, in order.
+ *  So the queue can't fill up with progress updates, and a task sending them is never
+ *  held up waiting for room.
+ */
+
+class ui_queue
+{
+	protected:
+		/// The queue of messages, holding at most one progress update
+		frt_queue<ui_message> queue;
+
+		/// The latest progress update; the one in the queue is replaced by this
+		ui_message progress;
+
+		/// True when there's a progress update in the queue which hasn't been taken
+		bool progress_queued;
+
+		/// The number of progress updates which were merged into one already waiting
+		uint16_t coalesced;
+
+		/** This method checks whether a message is a progress update.
+		 *  @param type The message
+		 *  @return True if the message is a progress update, false if not
+		 */
+		static bool is_progress (ui_messages type)
+		{
+			return (type == PRINT_SPOKE || type == GO_BACK || type == GAUGE);
+		}
+
+	public:
+		// The constructor creates a queue which holds the given number of messages
+		ui_queue (uint8_t queue_size);
+
+		// Send a message, noting the time and the numbers it's about
+		bool put (ui_messages type, int8_t spoke = 0, int8_t target = 0,
+				  int16_t value = 0);
+
+		// Take the next message out of the queue, waiting for one if need be
+		ui_message get (void);
+
+		// Take the next message out of the queue, waiting no longer than given
+		bool get (ui_message* p_message, portTickType ticks_to_wait);
+
+		/** This method checks if there are no messages waiting.
+		 *  @return True if the queue is empty, false if there's something in it
+		 */
+		bool is_empty (void)
+		{
+			return (queue.is_empty ());
+		}
+
+		/// Get the number of progress updates which were merged into waiting ones
+		uint16_t get_coalesced (void) { return (coalesced); }
+};
+
+#endif // _UI_QUEUE_H_
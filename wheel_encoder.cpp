@@ -8,6 +8,8 @@
 * 
  *  Revisions:
  *    \li 03-13-13 HL, TJ, & SG wheel_encoder can tell the direction of the wheel
+ *    \li 10-18-26 encoder edges go into the capture log
+ *    \li 10-18-26 edges are counted, so the spoke counter can tell how far it moved
  *
  *  License:
  *    This file is copyright 2013 by Hamilton Little, Trevor Jones and Sean Green 
@@ -31,6 +33,7 @@
 #include "rs232int.h"                       // Include header for serial port class
 #include "wheel_encoder.h"                 // Include header for the wheel_encoder class
 #include "shares.h"
+#include "event_log.h"                     // Capture log, when built with EVENT_CAPTURE
 
 /** Used internally to save the direction we see the wheel is spinning */
 volatile bool wheel_direction;
@@ -38,6 +41,10 @@ volatile bool wheel_direction;
 /** Used internally when doing grey_code calculations to tell direction */
 static volatile bool chan5high, chan6high;
 
+/** Used internally to count edges, up going forward and down going back. It's a byte
+ *  so it can be read in one go, even from an ISR, and only differences are used */
+static volatile int8_t position;
+
 //-------------------------------------------------------------------------------------
 /** \brief Creates a new wheel_encoder object to read wheel velocity direction.
 *  \details This constructor sets up a new wheel_encoder to read on PE[5:6]
@@ -48,6 +55,7 @@ wheel_encoder::wheel_encoder(emstream* p_serial_port) {
 	chan5high = 0;
 	chan6high = 0;
 	wheel_direction = true;
+	position = 0;
 	
 	// Set up interrupts on PE[6:5]
 	EICRB |= (1 << ISC50) | (1 << ISC60);		// interrupt on logical change
@@ -73,6 +81,18 @@ bool wheel_encoder::get_direction() {
 	return direction;
 }
 
+//-------------------------------------------------------------------------------------
+/** \brief Returns how many edges the encoder has seen, counting back going backward.
+*  \details Each edge's direction comes from the levels of both channels as it
+* 			happens, so the count is right even when the wheel turns back between
+* 			edges, when the direction from get_direction() is stale until the next
+* 			one. It wraps round, so only the difference between two readings means
+* 			anything. It doesn't touch the interrupts, so it can be used in an ISR.
+*/
+int8_t wheel_encoder::get_position() {
+	return position;
+}
+
 //-------------------------------------------------------------------------------------
 /** \cond NOT_ENABLED ISR for external interrupt on pin 4 (PortE pin 4). updates
  * 	either count1 or count2 through use of count_pin4 pointer, which was initialized
@@ -85,6 +105,8 @@ ISR(INT5_vect) {
 	// current logic level of pin
 	chan5high = (bool)(PINE & (1<<PE5));
 	wheel_direction = chan5high ? !chan6high : chan6high;
+	position += wheel_direction ? 1 : -1;
+	EVENT_LOG_EDGE(EVENT_INT5, chan5high);
 }
 
 /** ISR for external interrupt on pin 6 (PortE pin 6). Updates wheel direction.
@@ -93,6 +115,8 @@ ISR(INT6_vect) {
 	// current pin logic level
 	chan6high = (bool)(PINE & (1<<PE6));
 	wheel_direction = chan6high ? chan5high : !chan5high;	
+	position += wheel_direction ? 1 : -1;
+	EVENT_LOG_EDGE(EVENT_INT6, chan6high);
 }
 
 /** \endcond end of nondocumented code */
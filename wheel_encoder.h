@@ -7,6 +7,7 @@
 *    it begins spinning the opposite direction.
 *  Revisions:
 *    \li 02-05-13 HL/TJ Version 1.0 created to encode motor position according to lab3 spec.
+*    \li 10-18-26 edges are counted as well as the direction
 * 
 *  License:
 *    This file is copyright 2013 by Hamilton Little and Trevor Jones and is released
@@ -57,6 +58,9 @@ class wheel_encoder
             wheel_encoder(emstream*);
             
 			bool get_direction();	
+			
+			// how many edges have gone by, up going forward and down going back
+			int8_t get_position();
 }; // end of class wheel_encoder
 
       // This operator prints out information about the wheel_encoder object. It's not 
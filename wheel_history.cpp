@@ -0,0 +1,144 @@
+//*************************************************************************************
+/** \file wheel_history.cpp
+ *    This file contains the history of the wheels which have been trued on the stand.
+ *    See \c wheel_history.h for what's kept and when.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, wheels remembered across sessions
+ *    \li 10-18-26 A record has room for MAX_SPOKES spokes
+ *    \li 10-18-26 The check value is the one all EEPROM records share
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+#include <stddef.h>                         // For offsetof()
+#include <avr/eeprom.h>                     // For keeping the records
+#include "eeprom_record.h"                  // For the records' check values
+#include "wheel_history.h"
+
+
+/// The wheels' records, one for each wheel number from 1, kept in EEPROM
+static wheel_record EEMEM saved_wheels[HISTORY_WHEELS];
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This constructor starts off with no wheel's history loaded.
+ */
+
+wheel_history::wheel_history (void)
+{
+	record.spokes = 0;
+	record.sessions = 0;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method loads a wheel's history from EEPROM.
+ *  \details A record which is damaged, was never saved, or is for a wheel with a
+ *  different number of spokes, as when the number has been given to another wheel,
+ *  isn't used.
+ *  @param wheel The wheel's number, from 1 to \c HISTORY_WHEELS
+ *  @param spokes How many spokes the wheel on the stand has
+ *  @return True if the wheel's history was loaded, false if it hasn't got one
+ */
+
+bool wheel_history::load (uint8_t wheel, uint8_t spokes)
+{
+	if (wheel < 1 || wheel > HISTORY_WHEELS || spokes > MAX_SPOKES)
+	{
+		return (false);
+	}
+
+	eeprom_read_block (&record, &saved_wheels[wheel - 1], sizeof (record));
+	if (record.spokes != spokes
+		|| record.check != eeprom_record_crc (&record, offsetof (wheel_record, check)))
+	{
+		record.spokes = 0;
+		record.sessions = 0;
+		return (false);
+	}
+
+	return (true);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method saves what's been learned about a wheel and how far off each
+ *  of its spokes is, counting one more session for it.
+ *  \details Only the bytes which have changed are written, so the EEPROM doesn't wear
+ *  out from a wheel being trued over and over.
+ *  @param wheel The wheel's number, from 1 to \c HISTORY_WHEELS
+ *  @param spokes How many spokes the wheel has
+ *  @param offsets Each spoke's offset from the average at the last measuring, um
+ *  @param p_flanges The flange model for the wheel
+ *  @param p_gains The gain model for the wheel's sideways offsets
+ */
+
+void wheel_history::save (uint8_t wheel, uint8_t spokes, const int16_t offsets[],
+						  flange_model* p_flanges, gain_model* p_gains)
+{
+	if (wheel < 1 || wheel > HISTORY_WHEELS || spokes > MAX_SPOKES)
+	{
+		return;
+	}
+
+	uint8_t sessions = load (wheel, spokes) ? record.sessions : 0;
+
+	record.spokes = spokes;
+	record.sessions = (sessions < 0xFF) ? sessions + 1 : sessions;
+	p_flanges->save (&record.flanges);
+	p_gains->save (&record.gains);
+	for (uint8_t spoke = 0; spoke < MAX_SPOKES; spoke++)
+	{
+		record.offsets[spoke] = (spoke < spokes) ? offsets[spoke] : 0;
+	}
+	record.check = eeprom_record_crc (&record, offsetof (wheel_record, check));
+
+	eeprom_update_block (&record, &saved_wheels[wheel - 1], sizeof (record));
+}
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This method finds the spoke whose offset has changed most since the loaded
+ *  wheel was last on the stand.
+ *  \details Offsets are from the average, so a rim which has moved over as a whole
+ *  doesn't count; one which has been knocked out of true at a spoke does.
+ *  @param offsets Each spoke's offset from the average now, um
+ *  @param p_change Where to put how much that spoke's offset has changed by, um
+ *  @return The spoke
+ */
+
+uint8_t wheel_history::most_changed (const int16_t offsets[], int16_t* p_change)
+{
+	uint8_t most = 0;
+	int32_t most_size = -1;
+
+	*p_change = 0;
+	for (uint8_t spoke = 0; spoke < record.spokes; spoke++)
+	{
+		int32_t change = (int32_t)offsets[spoke] - record.offsets[spoke];
+		int32_t size = (change < 0) ? -change : change;
+
+		if (size > most_size)
+		{
+			most_size = size;
+			most = spoke;
+			*p_change = (change > 0x7FFF) ? 0x7FFF
+						: ((change < -0x7FFF) ? -0x7FFF : (int16_t)change);
+		}
+	}
+
+	return (most);
+}
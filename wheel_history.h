@@ -0,0 +1,100 @@
+//*************************************************************************************
+/** \file wheel_history.h
+ *    This file contains the history of the wheels which have been trued on the stand.
+ *    What was learned about a wheel's spokes, and how far off each one was at the end
+ *    of its last session, are kept in EEPROM by spoke numbers counted from the wheel's
+ *    index mark, so a wheel which comes back starts where it left off.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, wheels remembered across sessions
+ *    \li 10-18-26 A record has room for MAX_SPOKES spokes
+ *    \li 10-18-26 The check value is the one all EEPROM records share
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+// This define prevents this .h file from being included multiple times in a .cpp file
+#ifndef _WHEEL_HISTORY_H_
+#define _WHEEL_HISTORY_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "flange_model.h"                   // Which flange each spoke goes to
+#include "gain_model.h"                     // How far a quarter turn moves the rim
+
+
+/// How many wheels have a history kept in EEPROM; the user numbers them from 1
+#define HISTORY_WHEELS		4
+
+
+/** This structure is one wheel's history as it's kept in EEPROM. Spokes are numbered
+ *  from the wheel's index mark, so they're the same spokes every time it's on the
+ *  stand. The check value tells a record which was saved from an erased EEPROM.
+ */
+struct wheel_record
+{
+	uint8_t spokes;                         ///< How many spokes the wheel has
+	uint8_t sessions;                       ///< How many sessions it's been trued in
+	flange_record flanges;                  ///< Which flange each spoke goes to
+	gain_record gains;                      ///< How far a quarter turn of each moves it
+	int16_t offsets[MAX_SPOKES];            ///< Each spoke's offset at the end, um
+	uint16_t check;                         ///< CRC of everything above
+};
+
+
+//-------------------------------------------------------------------------------------
+/** \brief This class keeps the history of the wheels trued on the stand.
+ *  \details The user says which wheel is on the stand by its number, such as one
+ *  written on its rim. Only a wheel whose spokes have been numbered from its index
+ *  mark has a history, as otherwise spoke 0 is wherever the wheel was put on.
+ *
+ *  When a session ends with the wheel true, the flange model and gains learned for
+ *  it, and its last offsets, are saved. When it comes back with the same number of
+ *  spokes, the flange and gain models start from what was saved, rather than from
+ *  the user's answer about the first spoke and the guessed gain, and its offsets can
+ *  be compared with how it was left.
+ */
+
+class wheel_history
+{
+	protected:
+		/// The history of the wheel on the stand, as loaded or to be saved
+		wheel_record record;
+
+	public:
+		// The constructor starts off with no wheel's history loaded
+		wheel_history (void);
+
+		// Load a wheel's history, if it has one for a wheel with this many spokes
+		bool load (uint8_t wheel, uint8_t spokes);
+
+		// Save what's been learned about a wheel, and how far off its spokes are
+		void save (uint8_t wheel, uint8_t spokes, const int16_t offsets[],
+				   flange_model* p_flanges, gain_model* p_gains);
+
+		/// Get how many sessions the loaded wheel has been trued in
+		uint8_t get_sessions (void) { return (record.sessions); }
+
+		/// Get which flange each spoke of the loaded wheel goes to
+		const flange_record* get_flanges (void) { return (&record.flanges); }
+
+		/// Get what was learned about the gains of the loaded wheel's spokes
+		const gain_record* get_gains (void) { return (&record.gains); }
+
+		// Find the spoke whose offset has changed most since the wheel was last here
+		uint8_t most_changed (const int16_t offsets[], int16_t* p_change);
+};
+
+#endif // _WHEEL_HISTORY_H_
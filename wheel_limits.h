@@ -0,0 +1,56 @@
+//*************************************************************************************
+/** \file wheel_limits.h
+ *    This file contains the most spokes a wheel on the stand can have, which sizes
+ *    every table the program keeps with an entry for each spoke, and the set of bits
+ *    used where each spoke needs only a yes or a no. It doesn't use the RTOS, so
+ *    programs on a PC which read the stand's telemetry can be built with it too.
+ *
+ *  Revisions:
+ *    \li 10-18-26 Original file, one limit on the spokes for the whole program
+ *    \li 10-18-26 The spoke count's limit is checked in mastermind.h
+ *
+ *  License:
+ *    This file is released under the Lesser GNU Public License, version 2. It
+ *    intended for educational use only, but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+*    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUEN-
+*    TIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+*    OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+//*************************************************************************************
+
+// This define prevents this .h file from being included multiple times in a .cpp file
+#ifndef _WHEEL_LIMITS_H_
+#define _WHEEL_LIMITS_H_
+
+#include <stdint.h>
+
+
+/** This is the most spokes a wheel can have, which is enough for a tandem's or a
+ *  touring wheel's 48. Each spoke has a bit in a \c spoke_set, and the 8 bit signed
+ *  spoke count must reach a little over two turns while the wheel is measured, which
+ *  \c mastermind.h checks.
+ */
+#define MAX_SPOKES			48
+
+/// This is the number of spokes a wheel is taken to have until the user says
+#define DEFAULT_SPOKES		32
+
+#if MAX_SPOKES > 64
+	#error "MAX_SPOKES won't fit in a spoke_set"
+#endif
+
+/// This is a set of spokes, with a bit for each spoke, spoke 0 in the lowest bit
+typedef uint64_t spoke_set;
+
+/** This macro gives the bit for one spoke in a \c spoke_set.
+ *  @param spoke The spoke, from 0 to \c MAX_SPOKES - 1
+ */
+#define SPOKE_BIT(spoke)	((spoke_set)1 << (spoke))
+
+#endif // _WHEEL_LIMITS_H_